@@ -0,0 +1,82 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <string>
+
+#include <libbw/datetime.h>
+
+#include "harness.h"
+
+/* Benchmarks {{{ */
+
+static void benchNow(bwbench::State &state)
+{
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::Datetime::now());
+}
+BWBENCH_REGISTER_BUDGET("datetime/now", benchNow, 0);
+
+static void benchStr(bwbench::State &state)
+{
+    bw::Datetime datetime(2012, 6, 15, 13, 37, 42, false);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(datetime.str());
+}
+BWBENCH_REGISTER_BUDGET("datetime/str", benchStr, 1);
+
+static void benchDateStr(bwbench::State &state)
+{
+    bw::Datetime datetime(2012, 6, 15, 13, 37, 42, false);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(datetime.dateStr());
+}
+BWBENCH_REGISTER_BUDGET("datetime/dateStr", benchDateStr, 0);
+
+static void benchFixedStr(bwbench::State &state)
+{
+    bw::Datetime datetime(2012, 6, 15, 13, 37, 42, false);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(datetime.fixedStr());
+}
+BWBENCH_REGISTER_BUDGET("datetime/fixedStr", benchFixedStr, 0);
+
+static void benchStrftime(bwbench::State &state)
+{
+    bw::Datetime datetime(2012, 6, 15, 13, 37, 42, true);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(datetime.strftime("%Y%m%dT%H%M%S"));
+}
+BWBENCH_REGISTER_BUDGET("datetime/strftime", benchStrftime, 0);
+
+static void benchAddDays(bwbench::State &state)
+{
+    bw::Datetime datetime(2012, 6, 15, 13, 37, 42, false);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(datetime.addDays(1));
+}
+BWBENCH_REGISTER_BUDGET("datetime/addDays", benchAddDays, 1);
+
+/* }}} */
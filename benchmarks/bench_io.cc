@@ -0,0 +1,88 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdio>
+#include <fstream>
+#include <string>
+
+#include <unistd.h>
+
+#include <libbw/io/bufferedlinereader.h>
+#include <libbw/io/tempfile.h>
+
+#include "harness.h"
+
+/* Helper functions {{{ */
+
+// 1000 lines of a log file, created once
+static bw::io::TempFile &logFile()
+{
+    static bw::io::TempFile *file = NULL;
+    if (!file) {
+        file = new bw::io::TempFile("bwbench", bw::io::TempFile::DeleteOnExit);
+
+        std::string data;
+        for (int i = 0; i < 1000; ++i)
+            data += "2012-06-15 13:37:42 [INFO      ] connection from 192.168.1.10\r\n";
+        if (write(file->nativeHandle(), data.data(), data.size()) < 0)
+            std::perror("write");
+    }
+    return *file;
+}
+
+/* }}} */
+/* Benchmarks {{{ */
+
+static void benchBufferedLineReader(bwbench::State &state)
+{
+    int fd = logFile().nativeHandle();
+    bw::io::BufferedLineReader reader(fd);
+    bw::StringView line;
+
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        lseek(fd, 0, SEEK_SET);
+        reader.reset(fd);
+        while (reader.readLine(line))
+            bwbench::doNotOptimize(line);
+    }
+}
+BWBENCH_REGISTER_BUDGET("io/BufferedLineReader/1000-lines", benchBufferedLineReader, 0);
+
+static void benchGetline(bwbench::State &state)
+{
+    std::ifstream stream(logFile().name().c_str());
+    std::string line;
+
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        stream.clear();
+        stream.seekg(0);
+        while (std::getline(stream, line))
+            bwbench::doNotOptimize(line);
+    }
+}
+BWBENCH_REGISTER("io/getline/1000-lines", benchGetline);
+
+/* }}} */
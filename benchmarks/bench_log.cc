@@ -0,0 +1,131 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdio>
+
+#include <libbw/log/debug.h>
+#include <libbw/log/errorlog.h>
+#include <libbw/log/tracer.h>
+
+#include "harness.h"
+
+/* Helper functions {{{ */
+
+/**
+ * \brief Redirects the debug output and the error log to /dev/null, once
+ */
+static void setupLogging()
+{
+    static bool s_done = false;
+    if (s_done)
+        return;
+
+    bw::Debug::debug()->setFileHandle(std::fopen("/dev/null", "w"));
+    bw::Errorlog::configure(bw::Errorlog::LM_FILE, "/dev/null");
+    s_done = true;
+}
+
+static bw::Debug::Category benchCategory()
+{
+    static bw::Debug::Category s_category = bw::Debug::debug()->registerCategory("bench");
+    return s_category;
+}
+
+/* }}} */
+/* Benchmarks {{{ */
+
+static void benchDebugDisabled(bwbench::State &state)
+{
+    setupLogging();
+    bw::Debug::debug()->setLevel(bw::Debug::DL_INFO);
+
+    for (size_t i = 0; i < state.iterations(); ++i)
+        BW_DEBUG_TRACE("Iteration %lu", static_cast<unsigned long>(i));
+}
+BWBENCH_REGISTER_BUDGET("log/debug/disabled", benchDebugDisabled, 0);
+
+static void benchDebugEnabled(bwbench::State &state)
+{
+    setupLogging();
+    bw::Debug::debug()->setLevel(bw::Debug::DL_TRACE);
+
+    for (size_t i = 0; i < state.iterations(); ++i)
+        BW_DEBUG_TRACE("Iteration %lu of %s", static_cast<unsigned long>(i), "benchmark");
+
+    bw::Debug::debug()->setLevel(bw::Debug::DL_NONE);
+}
+BWBENCH_REGISTER_BUDGET("log/debug/vmsg", benchDebugEnabled, 0);
+
+static void benchDebugCategoryDisabled(bwbench::State &state)
+{
+    setupLogging();
+    bw::Debug::Category category = benchCategory();
+    bw::Debug::debug()->setLevel(bw::Debug::DL_TRACE);
+    bw::Debug::debug()->setCategoryLevel(category, bw::Debug::DL_INFO);
+
+    for (size_t i = 0; i < state.iterations(); ++i)
+        BW_DEBUG_CATEGORY(category, bw::Debug::DL_TRACE, "Iteration %lu",
+                          static_cast<unsigned long>(i));
+
+    bw::Debug::debug()->resetCategoryLevel(category);
+    bw::Debug::debug()->setLevel(bw::Debug::DL_NONE);
+}
+BWBENCH_REGISTER_BUDGET("log/debug/category-disabled", benchDebugCategoryDisabled, 0);
+
+static void benchErrorlogFile(bwbench::State &state)
+{
+    setupLogging();
+
+    for (size_t i = 0; i < state.iterations(); ++i)
+        BW_ERROR_WARNING("Iteration %lu of %s", static_cast<unsigned long>(i), "benchmark");
+}
+BWBENCH_REGISTER_BUDGET("log/errorlog/file", benchErrorlogFile, 0);
+
+static void benchTraceSpanDisabled(bwbench::State &state)
+{
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        BW_TRACE_SPAN("disabled");
+        bwbench::doNotOptimize(i);
+    }
+}
+BWBENCH_REGISTER_BUDGET("log/tracer/span-disabled", benchTraceSpanDisabled, 0);
+
+static void benchTraceSpanEnabled(bwbench::State &state)
+{
+    bw::Debug::debug()->setLevel(bw::Debug::DL_TRACE);
+    bw::Tracer::start(state.iterations());
+
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        BW_TRACE_SPAN("enabled");
+        bwbench::doNotOptimize(i);
+    }
+
+    bw::Tracer::stop();
+    bw::Debug::debug()->setLevel(bw::Debug::DL_NONE);
+}
+BWBENCH_REGISTER_BUDGET("log/tracer/span", benchTraceSpanEnabled, 0);
+
+/* }}} */
@@ -0,0 +1,70 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <libbw/metrics/counter.h>
+#include <libbw/metrics/histogram.h>
+
+#include "harness.h"
+
+/* Benchmarks {{{ */
+
+static void benchCounter(bwbench::State &state)
+{
+    static bw::metrics::Counter s_counter;
+    for (size_t i = 0; i < state.iterations(); ++i)
+        s_counter.add();
+    bwbench::doNotOptimize(s_counter.value());
+}
+BWBENCH_REGISTER_BUDGET("metrics/counter/add", benchCounter, 0);
+
+static void benchGauge(bwbench::State &state)
+{
+    static bw::metrics::Gauge s_gauge;
+    for (size_t i = 0; i < state.iterations(); ++i)
+        s_gauge.set(static_cast<long long>(i));
+    bwbench::doNotOptimize(s_gauge.value());
+}
+BWBENCH_REGISTER_BUDGET("metrics/gauge/set", benchGauge, 0);
+
+static void benchHistogram(bwbench::State &state)
+{
+    static bw::metrics::Histogram s_histogram;
+    for (size_t i = 0; i < state.iterations(); ++i)
+        s_histogram.record(i & 0xffff);
+}
+BWBENCH_REGISTER_BUDGET("metrics/histogram/record", benchHistogram, 0);
+
+static void benchScopedTimer(bwbench::State &state)
+{
+    static bw::metrics::Histogram s_histogram;
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        bw::metrics::ScopedTimer timer(&s_histogram);
+        bwbench::doNotOptimize(i);
+    }
+}
+BWBENCH_REGISTER_BUDGET("metrics/histogram/ScopedTimer", benchScopedTimer, 0);
+
+/* }}} */
@@ -0,0 +1,64 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <getopt.h>
+
+#include <libbw/optionparser.h>
+
+#include "harness.h"
+
+/* Benchmarks {{{ */
+
+static void benchParse(bwbench::State &state)
+{
+    char arg0[] = "program", arg1[] = "-D", arg2[] = "--label", arg3[] = "linux";
+    char arg4[] = "-n", arg5[] = "42", arg6[] = "file1", arg7[] = "file2";
+    char *argv[] = { arg0, arg1, arg2, arg3, arg4, arg5, arg6, arg7, NULL };
+
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        bw::OptionGroup generalGroup("General options");
+        generalGroup.addOption("help", 'h', bw::OT_FLAG, "Shows this help output");
+        generalGroup.addOption("label", 'l', bw::OT_STRING, "Label");
+        generalGroup.addOption("number", 'n', bw::OT_INTEGER, "Number");
+
+        bw::OptionGroup debugGroup("Debug options");
+        debugGroup.addOption("debug", 'D', bw::OT_FLAG, "Enable debugging output");
+        debugGroup.addOption("debug-file", 'd', bw::OT_STRING, "Debug file");
+
+        bw::OptionParser op;
+        op.addOptions(generalGroup);
+        op.addOptions(debugGroup);
+
+        // reinitialize getopt() for the next parse() call
+        optind = 0;
+        bwbench::doNotOptimize(op.parse(8, argv));
+        bwbench::doNotOptimize(op.getValue("label").getString());
+    }
+}
+// the option vectors of the groups grow while options are added
+BWBENCH_REGISTER_BUDGET("optionparser/parse", benchParse, BWBENCH_MOVE_BUDGET(22, 25));
+
+/* }}} */
@@ -0,0 +1,424 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include <libbw/arena.h>
+#include <libbw/stringreplacer.h>
+#include <libbw/stringscan.h>
+#include <libbw/stringutil.h>
+
+#include "harness.h"
+
+/* Helper functions {{{ */
+
+/**
+ * \brief Returns a line of \p count comma-separated fields
+ */
+static std::string csvLine(int count)
+{
+    std::string line;
+    for (int i = 0; i < count; ++i)
+        line += (i ? ", field" : "field") + bw::str(i);
+    return line;
+}
+
+/**
+ * \brief Returns a log record of about 4 KiB with characters that need escaping
+ */
+static std::string logRecord()
+{
+    std::string record;
+    for (int i = 0; record.size() < 4096; ++i)
+        record += "key" + bw::str(i) + "=\"C:\\path\\file" + bw::str(i) + "\"\tline\n";
+    return record;
+}
+
+/* }}} */
+/* Benchmarks {{{ */
+
+static void benchStrInt(bwbench::State &state)
+{
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::str(static_cast<int>(i)));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/str<int>", benchStrInt, 0);
+
+static void benchStrDouble(bwbench::State &state)
+{
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::str(i * 0.25));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/str<double>", benchStrDouble, 0);
+
+static void benchFromStrInt(bwbench::State &state)
+{
+    std::string input("1234567");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::from_str<int>(input));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/from_str<int>", benchFromStrInt, 0);
+
+static void benchFromStrDouble(bwbench::State &state)
+{
+    std::string input("3.14159");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::from_str<double>(input));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/from_str<double>", benchFromStrDouble, 0);
+
+static void benchFormatNumberInt(bwbench::State &state)
+{
+    char buffer[bw::MaxNumberLength];
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::formatNumber(buffer, sizeof(buffer), static_cast<long>(i)));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/formatNumber<long>", benchFormatNumberInt, 0);
+
+static void benchParseNumberInt(bwbench::State &state)
+{
+    bw::StringView input("-1234567");
+    int value = 0;
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        bwbench::doNotOptimize(bw::parseNumber(input, value));
+        bwbench::doNotOptimize(value);
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/parseNumber<int>", benchParseNumberInt, 0);
+
+static void benchParseNumberDouble(bwbench::State &state)
+{
+    bw::StringView input("3.14159e-2");
+    double value = 0;
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        bwbench::doNotOptimize(bw::parseNumber(input, value));
+        bwbench::doNotOptimize(value);
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/parseNumber<double>", benchParseNumberDouble, 0);
+
+static void benchStringsplitShort(bwbench::State &state)
+{
+    std::string input("key=value");
+    std::string pattern("=");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::stringsplit(input, pattern));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/stringsplit/short", benchStringsplitShort, 2);
+
+static void benchStringsplitLong(bwbench::State &state)
+{
+    static const std::string input = csvLine(32);
+    std::string pattern(", ");
+
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::stringsplit(input, pattern));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/stringsplit/32-fields", benchStringsplitLong, 6);
+
+static void benchStringsplitArena(bwbench::State &state)
+{
+    static const std::string input = csvLine(32);
+    char buffer[4096];
+    bw::Arena arena(buffer, sizeof(buffer));
+
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        bwbench::doNotOptimize(bw::stringsplit(input, ", ", arena));
+        arena.reset();
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/stringsplit/arena", benchStringsplitArena, 0);
+
+static void benchStringvectorToArray(bwbench::State &state)
+{
+    std::vector<std::string> args(8, "--some-argument");
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        char **array = bw::stringvector_to_array(args);
+        bwbench::doNotOptimize(array);
+        for (char **cur = array; *cur; ++cur)
+            std::free(*cur);
+        std::free(array);
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/stringvector_to_array", benchStringvectorToArray, 9);
+
+static void benchStringvectorToArrayArena(bwbench::State &state)
+{
+    std::vector<std::string> args(8, "--some-argument");
+    bw::Arena arena;
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        bwbench::doNotOptimize(bw::stringvector_to_array(args, arena));
+        arena.reset();
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/stringvector_to_array/arena", benchStringvectorToArrayArena, 0);
+
+static void benchStringSplitter(bwbench::State &state)
+{
+    static const std::string input = csvLine(32);
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        bw::StringSplitter splitter(input, ", ");
+        bw::StringView token;
+        while (splitter.next(token))
+            bwbench::doNotOptimize(token);
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/StringSplitter/32-fields", benchStringSplitter, 0);
+
+static void benchStringsplitViews(bwbench::State &state)
+{
+    static const std::string input = csvLine(32);
+    std::vector<bw::StringView> tokens;
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::stringsplit(input, ',', tokens));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/stringsplit/views-reused", benchStringsplitViews, 0);
+
+static void benchStringSplitterLong(bwbench::State &state)
+{
+    static const std::string input = csvLine(65536);
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        bw::StringSplitter splitter(input, ',');
+        bw::StringView token;
+        while (splitter.next(token))
+            bwbench::doNotOptimize(token);
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/StringSplitter/64k-fields", benchStringSplitterLong, 0);
+
+static void benchStrip(bwbench::State &state)
+{
+    std::string input("\t  some value with spaces  \n");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::strip(input));
+}
+// the stripped copy of the by-value parameter is returned
+BWBENCH_REGISTER_BUDGET("stringutil/strip", benchStrip, BWBENCH_MOVE_BUDGET(1, 2));
+
+static void benchStripLong(bwbench::State &state)
+{
+    static const std::string input = std::string(200, ' ') + "value" + std::string(200, '\t');
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::strip(input));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/strip/400-spaces", benchStripLong, 1);
+
+static void benchFindAnyOf(bwbench::State &state)
+{
+    static const std::string input = std::string(4096, 'x') + "\n";
+    const char *begin = input.data();
+    const char *end = begin + input.size();
+
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::findAnyOf(begin, end, ",;\t\n", 4));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/findAnyOf/4k", benchFindAnyOf, 0);
+
+static void benchCountChar(bwbench::State &state)
+{
+    static const std::string input = csvLine(512);
+    const char *begin = input.data();
+    const char *end = begin + input.size();
+
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::countChar(begin, end, ','));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/countChar/512-fields", benchCountChar, 0);
+
+static void benchStartsWith(bwbench::State &state)
+{
+    std::string input("Content-Type: text/plain");
+    std::string prefix("content-type:");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::startsWith(input, prefix, false));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/startsWith/nocase", benchStartsWith, 0);
+
+static void benchStartsWithLong(bwbench::State &state)
+{
+    std::string input("X-Forwarded-For-Original-Client-Address: 192.168.1.10");
+    std::string prefix("x-forwarded-for-original-client-address:");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::startsWith(input, prefix, false));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/startsWith/nocase-40", benchStartsWithLong, 0);
+
+static void benchEndsWith(bwbench::State &state)
+{
+    std::string input("/var/log/messages.LOG");
+    std::string suffix(".log");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::endsWith(input, suffix, false));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/endsWith/nocase", benchEndsWith, 0);
+
+static void benchContains(bwbench::State &state)
+{
+    std::string input(1024, 'x');
+    input += "Connection: Keep-Alive";
+    std::string needle("keep-alive");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::contains(input, needle, false));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/contains/nocase-1k", benchContains, 0);
+
+static void benchEqualsIgnoreCase(bwbench::State &state)
+{
+    std::string a(256, 'a'), b(256, 'A');
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::equalsIgnoreCase(a, b));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/equalsIgnoreCase/256", benchEqualsIgnoreCase, 0);
+
+static void benchGetRest(bwbench::State &state)
+{
+    std::string input("--option=value");
+    std::string prefix("--option=");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::getRest(input, prefix));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/getRest", benchGetRest, 0);
+
+static void benchReplaceChar(bwbench::State &state)
+{
+    std::string input("/usr/local/share/doc/libbw/index.html");
+    std::string replacement("\\\\");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::replace_char(input, '/', replacement));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/replace_char", benchReplaceChar, 1);
+
+static void benchReplaceCharLong(bwbench::State &state)
+{
+    static const std::string input = csvLine(512);
+    std::string replacement(";");
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::replace_char(input, ',', replacement));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/replace_char/512-fields", benchReplaceCharLong, 1);
+
+static void benchReplaceCharAppend(bwbench::State &state)
+{
+    static const std::string input = csvLine(512);
+    std::string output;
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        output.clear();
+        bwbench::doNotOptimize(bw::replace_char(input, ',', "\\,", output));
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/replace_char/append", benchReplaceCharAppend, 0);
+
+static void benchReplaceCharInplace(bwbench::State &state)
+{
+    static const std::string input = csvLine(512);
+    std::string work;
+    work.reserve(2 * input.size());
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        work.assign(input);
+        bwbench::doNotOptimize(bw::replace_char_inplace(work, ',', "\\,"));
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/replace_char_inplace", benchReplaceCharInplace, 0);
+
+static void benchStringReplacerEscape(bwbench::State &state)
+{
+    static const std::string input = logRecord();
+    bw::StringReplacer escaper;
+    escaper.add('\\', "\\\\");
+    escaper.add('"', "\\\"");
+    escaper.add('\t', "\\t");
+    escaper.add('\n', "\\n");
+    escaper.add("\r\n", "\\n");
+
+    std::string output;
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        output.clear();
+        bwbench::doNotOptimize(escaper.replace(input, output));
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/StringReplacer/escape-4k", benchStringReplacerEscape, 0);
+
+static void benchStringReplacerMany(bwbench::State &state)
+{
+    static const std::string input = logRecord();
+    bw::StringReplacer replacer;
+    for (int i = 0; i < 64; ++i)
+        replacer.add("file" + bw::str(i * 3), "f" + bw::str(i));
+
+    std::string output;
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        output.clear();
+        bwbench::doNotOptimize(replacer.replace(input, output));
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/StringReplacer/64-patterns", benchStringReplacerMany, 0);
+
+static void benchInternHit(bwbench::State &state)
+{
+    bw::StringView name("serial/ttyUSB0");
+    bw::intern(name);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(bw::intern(name));
+}
+BWBENCH_REGISTER_BUDGET("stringutil/intern/hit", benchInternHit, 0);
+
+static void benchInternedCompare(bwbench::State &state)
+{
+    bw::InternedString names[16];
+    for (int i = 0; i < 16; ++i)
+        names[i] = bw::intern("/dev/ttyUSB" + bw::str(i));
+    bw::InternedString key = bw::intern("/dev/ttyUSB15");
+
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        int found = -1;
+        for (int j = 0; j < 16; ++j)
+            if (names[j] == key)
+                found = j;
+        bwbench::doNotOptimize(found);
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/InternedString/find-16", benchInternedCompare, 0);
+
+static void benchStringCompare(bwbench::State &state)
+{
+    std::string names[16];
+    for (int i = 0; i < 16; ++i)
+        names[i] = "/dev/ttyUSB" + bw::str(i);
+    std::string key("/dev/ttyUSB15");
+
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        int found = -1;
+        for (int j = 0; j < 16; ++j)
+            if (names[j] == key)
+                found = j;
+        bwbench::doNotOptimize(found);
+    }
+}
+BWBENCH_REGISTER_BUDGET("stringutil/std::string/find-16", benchStringCompare, 0);
+
+/* }}} */
@@ -0,0 +1,63 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <libbw/thread/atomic.h>
+#include <libbw/thread/mutex.h>
+#include <libbw/thread/threadstorage.h>
+
+#include "harness.h"
+
+/* Benchmarks {{{ */
+
+static void benchMutex(bwbench::State &state)
+{
+    static bw::thread::Mutex s_mutex;
+    for (size_t i = 0; i < state.iterations(); ++i) {
+        s_mutex.lock();
+        s_mutex.unlock();
+    }
+}
+BWBENCH_REGISTER_BUDGET("thread/mutex", benchMutex, 0);
+
+static void benchAtomicFetchAdd(bwbench::State &state)
+{
+    static bw::thread::Atomic<unsigned long> s_value;
+    for (size_t i = 0; i < state.iterations(); ++i)
+        s_value.fetchAdd(1);
+    bwbench::doNotOptimize(s_value.load());
+}
+BWBENCH_REGISTER_BUDGET("thread/atomic/fetchAdd", benchAtomicFetchAdd, 0);
+
+static void benchThreadStorage(bwbench::State &state)
+{
+    static bw::thread::ThreadStorage s_storage;
+    s_storage.set(&s_storage);
+    for (size_t i = 0; i < state.iterations(); ++i)
+        bwbench::doNotOptimize(s_storage.get());
+}
+BWBENCH_REGISTER_BUDGET("thread/threadstorage/get", benchThreadStorage, 0);
+
+/* }}} */
@@ -0,0 +1,88 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdlib>
+#include <iostream>
+
+#include <libbw/optionparser.h>
+
+#include "harness.h"
+
+/* ---------------------------------------------------------------------------------------------- */
+int main(int argc, char *argv[])
+{
+    bw::OptionParser op("Benchmark options");
+
+    op.addOption("help", 'h', bw::OT_FLAG, "Shows this help output");
+    op.addOption("list", 'l', bw::OT_FLAG, "Lists the benchmarks instead of running them");
+    op.addOption("repetitions", 'r', bw::OT_INTEGER, "Number of measured batches (20)");
+    op.addOption("warmup", 'w', bw::OT_INTEGER, "Number of batches before measuring (3)");
+    op.addOption("batch-time", 't', bw::OT_INTEGER, "Minimum duration of a batch in ms (10)");
+    op.addOption("json", 'j', bw::OT_STRING, "Writes the results as JSON to the given file");
+    op.addOption("check-budgets", 'c', bw::OT_FLAG,
+                 "Checks the allocation budgets instead of measuring the time");
+
+    if (!op.parse(argc, argv))
+        return EXIT_FAILURE;
+
+    if (op.getValue("help").getFlag()) {
+        op.printHelp(std::cerr, "bwbench [options] [filter...]");
+        return EXIT_SUCCESS;
+    }
+
+    bwbench::Settings settings;
+    settings.filters = op.getArgs();
+    if (op.getValue("repetitions"))
+        settings.repetitions = op.getValue("repetitions").getInteger();
+    if (op.getValue("warmup"))
+        settings.warmup = op.getValue("warmup").getInteger();
+    if (op.getValue("batch-time"))
+        settings.batchTime = op.getValue("batch-time").getInteger() * 1000000ULL;
+
+    bwbench::Runner runner(settings);
+
+    if (op.getValue("list").getFlag()) {
+        std::vector<std::string> names = runner.names();
+        for (size_t i = 0; i < names.size(); ++i)
+            std::cout << names[i] << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    if (op.getValue("check-budgets").getFlag())
+        return runner.checkBudgets() ? EXIT_SUCCESS : EXIT_FAILURE;
+
+    std::vector<bwbench::Result> results = runner.run();
+
+    if (op.getValue("json")) {
+        std::string filename = op.getValue("json").getString();
+        if (!runner.writeJson(filename.c_str(), results)) {
+            std::cerr << "Unable to write '" << filename << "'." << std::endl;
+            return EXIT_FAILURE;
+        }
+    }
+
+    return EXIT_SUCCESS;
+}
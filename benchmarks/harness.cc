@@ -0,0 +1,440 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <new>
+
+#include <sys/time.h>
+
+#include <libbw/datetime.h>
+#include <libbw/stringscan.h>
+
+#include "harness.h"
+
+#if __cplusplus >= 201103L
+#  define BWBENCH_THROW_BAD_ALLOC
+#  define BWBENCH_NOTHROW noexcept
+#else
+#  define BWBENCH_THROW_BAD_ALLOC throw (std::bad_alloc)
+#  define BWBENCH_NOTHROW throw ()
+#endif
+
+#if defined(BWBENCH_MALLOC_HOOKS) && defined(__GLIBC__)
+#  define BWBENCH_COUNT_MALLOC
+#endif
+
+/* Allocation counting {{{ */
+
+static unsigned long long s_allocationCount;
+static unsigned long long s_allocatedBytes;
+
+static void countAllocation(size_t size)
+{
+#ifdef __GNUC__
+    __atomic_fetch_add(&s_allocationCount, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&s_allocatedBytes, size, __ATOMIC_RELAXED);
+#else
+    ++s_allocationCount;
+    s_allocatedBytes += size;
+#endif
+}
+
+#ifdef BWBENCH_COUNT_MALLOC
+
+// glibc exports its allocator under these names, so the hooks don't need dlsym()
+extern "C" void *__libc_malloc(size_t size);
+extern "C" void *__libc_calloc(size_t count, size_t size);
+extern "C" void *__libc_realloc(void *ptr, size_t size);
+
+extern "C" void *malloc(size_t size)
+{
+    countAllocation(size);
+    return __libc_malloc(size);
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    countAllocation(count * size);
+    return __libc_calloc(count, size);
+}
+
+extern "C" void *realloc(void *ptr, size_t size)
+{
+    countAllocation(size);
+    return __libc_realloc(ptr, size);
+}
+
+static void *countedAllocation(size_t size)
+{
+    // counted by the malloc() hook
+    return std::malloc(size > 0 ? size : 1);
+}
+
+#else
+
+static void *countedAllocation(size_t size)
+{
+    countAllocation(size);
+    return std::malloc(size > 0 ? size : 1);
+}
+
+#endif /* BWBENCH_COUNT_MALLOC */
+
+void *operator new(size_t size) BWBENCH_THROW_BAD_ALLOC
+{
+    void *ptr = countedAllocation(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new[](size_t size) BWBENCH_THROW_BAD_ALLOC
+{
+    void *ptr = countedAllocation(size);
+    if (!ptr)
+        throw std::bad_alloc();
+    return ptr;
+}
+
+void *operator new(size_t size, const std::nothrow_t &) BWBENCH_NOTHROW
+{
+    return countedAllocation(size);
+}
+
+void *operator new[](size_t size, const std::nothrow_t &) BWBENCH_NOTHROW
+{
+    return countedAllocation(size);
+}
+
+void operator delete(void *ptr) BWBENCH_NOTHROW
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr) BWBENCH_NOTHROW
+{
+    std::free(ptr);
+}
+
+void operator delete(void *ptr, const std::nothrow_t &) BWBENCH_NOTHROW
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, const std::nothrow_t &) BWBENCH_NOTHROW
+{
+    std::free(ptr);
+}
+
+// without these, sized deletes of C++14 would go to the default operator delete
+#ifdef __cpp_sized_deallocation
+
+void operator delete(void *ptr, size_t) BWBENCH_NOTHROW
+{
+    std::free(ptr);
+}
+
+void operator delete[](void *ptr, size_t) BWBENCH_NOTHROW
+{
+    std::free(ptr);
+}
+
+#endif /* __cpp_sized_deallocation */
+
+/* }}} */
+
+namespace bwbench {
+
+/* Helper functions {{{ */
+
+struct Benchmark {
+    const char          *name;
+    BenchmarkFunction   function;
+    int                 budget;
+};
+
+static std::vector<Benchmark> &benchmarks()
+{
+    static std::vector<Benchmark> s_benchmarks;
+    return s_benchmarks;
+}
+
+/**
+ * \brief Runs one batch
+ *
+ * \return the duration in nanoseconds
+ */
+static unsigned long long runBatch(BenchmarkFunction function, size_t iterations)
+{
+    State state(iterations);
+
+    unsigned long long start = now();
+    function(state);
+    return now() - start;
+}
+
+/**
+ * \brief Writes \p string as JSON string literal
+ */
+static void writeJsonString(std::FILE *fp, const std::string &string)
+{
+    std::fputc('"', fp);
+    for (std::string::const_iterator it = string.begin(); it != string.end(); ++it) {
+        unsigned char c = static_cast<unsigned char>(*it);
+        if (c == '"' || c == '\\')
+            std::fprintf(fp, "\\%c", c);
+        else if (c < 0x20)
+            std::fprintf(fp, "\\u%04x", c);
+        else
+            std::fputc(c, fp);
+    }
+    std::fputc('"', fp);
+}
+
+unsigned long long now()
+{
+#ifdef CLOCK_MONOTONIC
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<unsigned long long>(tv.tv_sec) * 1000000000ULL + tv.tv_usec * 1000ULL;
+}
+
+unsigned long long allocationCount()
+{
+#ifdef __GNUC__
+    return __atomic_load_n(&s_allocationCount, __ATOMIC_RELAXED);
+#else
+    return s_allocationCount;
+#endif
+}
+
+unsigned long long allocatedBytes()
+{
+#ifdef __GNUC__
+    return __atomic_load_n(&s_allocatedBytes, __ATOMIC_RELAXED);
+#else
+    return s_allocatedBytes;
+#endif
+}
+
+/* }}} */
+/* Registrar {{{ */
+
+const int Registrar::NoBudget;
+
+Registrar::Registrar(const char *name, BenchmarkFunction function, int budget)
+{
+    Benchmark benchmark = { name, function, budget };
+    benchmarks().push_back(benchmark);
+}
+
+/* }}} */
+/* Runner {{{ */
+
+Runner::Runner(const Settings &settings)
+    : m_settings(settings)
+{
+    if (m_settings.repetitions == 0)
+        m_settings.repetitions = 1;
+}
+
+std::vector<std::string> Runner::names() const
+{
+    std::vector<std::string> result;
+
+    const std::vector<Benchmark> &all = benchmarks();
+    for (std::vector<Benchmark>::const_iterator it = all.begin(); it != all.end(); ++it)
+        if (matches(it->name))
+            result.push_back(it->name);
+
+    return result;
+}
+
+std::vector<Result> Runner::run() const
+{
+    std::vector<Result> results;
+
+    std::printf("%-40s %12s %12s %12s %10s %10s\n", "benchmark", "median ns/op", "p99 ns/op",
+                "min ns/op", "allocs/op", "bytes/op");
+
+    const std::vector<Benchmark> &all = benchmarks();
+    for (std::vector<Benchmark>::const_iterator it = all.begin(); it != all.end(); ++it) {
+        if (!matches(it->name))
+            continue;
+
+        Result result = measure(it->name, it->function, it->budget);
+        std::printf("%-40s %12.1f %12.1f %12.1f %10.2f %10.1f\n", result.name.c_str(),
+                    result.median, result.p99, result.min, result.allocations, result.bytes);
+        std::fflush(stdout);
+
+        results.push_back(result);
+    }
+
+    return results;
+}
+
+bool Runner::writeJson(const char *filename, const std::vector<Result> &results) const
+{
+    std::FILE *fp = std::fopen(filename, "w");
+    if (!fp)
+        return false;
+
+    std::fputs("{\n  \"library\": \"libbw\",\n  \"version\": ", fp);
+    writeJsonString(fp, LIBBW_VERSION);
+    std::fputs(",\n  \"date\": ", fp);
+    writeJsonString(fp, bw::Datetime::now().str());
+    std::fputs(",\n  \"stringscan\": ", fp);
+    writeJsonString(fp, bw::stringScanImplementation());
+    std::fprintf(fp, ",\n  \"warmup\": %u,\n  \"repetitions\": %u,\n  \"batch_time_ns\": %llu,\n",
+                 m_settings.warmup, m_settings.repetitions, m_settings.batchTime);
+    std::fputs("  \"benchmarks\": [", fp);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result &result = results[i];
+
+        std::fputs(i == 0 ? "\n    {\"name\": " : ",\n    {\"name\": ", fp);
+        writeJsonString(fp, result.name);
+        std::fprintf(fp, ", \"iterations\": %lu, \"repetitions\": %u, \"median_ns\": %.3f, "
+                     "\"p99_ns\": %.3f, \"min_ns\": %.3f, \"mean_ns\": %.3f, "
+                     "\"allocs_per_op\": %.3f, \"bytes_per_op\": %.3f",
+                     static_cast<unsigned long>(result.iterations), result.repetitions,
+                     result.median, result.p99, result.min, result.mean, result.allocations,
+                     result.bytes);
+        if (result.budget != Registrar::NoBudget)
+            std::fprintf(fp, ", \"alloc_budget\": %d", result.budget);
+        std::fputc('}', fp);
+    }
+    std::fputs("\n  ]\n}\n", fp);
+
+    bool ok = !std::ferror(fp);
+    return std::fclose(fp) == 0 && ok;
+}
+
+bool Runner::checkBudgets() const
+{
+    static const size_t iterations = 16;
+    bool ok = true;
+
+    const std::vector<Benchmark> &all = benchmarks();
+    for (std::vector<Benchmark>::const_iterator it = all.begin(); it != all.end(); ++it) {
+        if (it->budget == Registrar::NoBudget || !matches(it->name))
+            continue;
+
+        // the first batch also triggers lazy initialization, such as static variables
+        runBatch(it->function, iterations);
+
+        unsigned long long start = allocationCount();
+        runBatch(it->function, iterations);
+        unsigned long long single = allocationCount() - start;
+
+        start = allocationCount();
+        runBatch(it->function, 2 * iterations);
+        unsigned long long twice = allocationCount() - start;
+
+        double allocations = twice > single
+            ? static_cast<double>(twice - single) / iterations
+            : 0.0;
+        bool passed = allocations <= it->budget;
+
+        std::printf("%-4s %-40s %8.2f allocs/op (budget %d)\n", passed ? "ok" : "FAIL",
+                    it->name, allocations, it->budget);
+        ok = ok && passed;
+    }
+
+    return ok;
+}
+
+bool Runner::matches(const char *name) const
+{
+    if (m_settings.filters.empty())
+        return true;
+
+    for (std::vector<std::string>::const_iterator it = m_settings.filters.begin();
+            it != m_settings.filters.end(); ++it)
+        if (std::strstr(name, it->c_str()))
+            return true;
+
+    return false;
+}
+
+Result Runner::measure(const char *name, BenchmarkFunction function, int budget) const
+{
+    // double the batch size until a batch takes long enough to be measured reliably
+    size_t iterations = 1;
+    while (runBatch(function, iterations) < m_settings.batchTime && iterations < (1UL << 30))
+        iterations *= 2;
+
+    for (unsigned int i = 0; i < m_settings.warmup; ++i)
+        runBatch(function, iterations);
+
+    std::vector<double> timings;
+    timings.reserve(m_settings.repetitions);
+
+    unsigned long long allocations = allocationCount();
+    unsigned long long bytes = allocatedBytes();
+
+    for (unsigned int i = 0; i < m_settings.repetitions; ++i)
+        timings.push_back(static_cast<double>(runBatch(function, iterations)) / iterations);
+
+    allocations = allocationCount() - allocations;
+    bytes = allocatedBytes() - bytes;
+    std::sort(timings.begin(), timings.end());
+
+    Result result;
+    result.name = name;
+    result.iterations = iterations;
+    result.repetitions = m_settings.repetitions;
+    result.min = timings.front();
+
+    size_t count = timings.size();
+    result.median = count % 2 ? timings[count / 2]
+                              : (timings[count / 2 - 1] + timings[count / 2]) / 2;
+    result.p99 = timings[(count * 99 + 99) / 100 - 1];
+
+    double sum = 0.0;
+    for (size_t i = 0; i < count; ++i)
+        sum += timings[i];
+    result.mean = sum / count;
+
+    double operations = static_cast<double>(iterations) * m_settings.repetitions;
+    result.allocations = allocations / operations;
+    result.bytes = bytes / operations;
+    result.budget = budget;
+
+    return result;
+}
+
+/* }}} */
+
+} // end namespace bwbench
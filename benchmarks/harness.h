@@ -0,0 +1,319 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef BENCHMARKS_HARNESS_H_
+#define BENCHMARKS_HARNESS_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace bwbench {
+
+/* Macros {{{ */
+
+/// \cond
+#define BWBENCH_CONCAT_(a, b) a##b
+#define BWBENCH_CONCAT(a, b) BWBENCH_CONCAT_(a, b)
+/// \endcond
+
+/**
+ * \brief Registers a benchmark function
+ *
+ * Example:
+ *
+ * \code
+ * static void benchStrip(bwbench::State &state)
+ * {
+ *     std::string input("  value  ");
+ *     for (size_t i = 0; i < state.iterations(); ++i)
+ *         bwbench::doNotOptimize(bw::strip(input));
+ * }
+ * BWBENCH_REGISTER("stringutil/strip", benchStrip);
+ * \endcode
+ *
+ * \param[in] name the name of the benchmark, <tt>module/operation</tt>
+ * \param[in] function the function, of type BenchmarkFunction
+ */
+#define BWBENCH_REGISTER(name, function) \
+    static bwbench::Registrar BWBENCH_CONCAT(_bwbenchRegistrar, __LINE__)(name, function)
+
+/**
+ * \brief Registers a benchmark function with an allocation budget
+ *
+ * Like BWBENCH_REGISTER(), but <tt>bwbench --check-budgets</tt> fails if one iteration
+ * of \p function allocates more than \p allocations times. Allocations in the setup code
+ * before the loop are not counted.
+ *
+ * \param[in] name the name of the benchmark, <tt>module/operation</tt>
+ * \param[in] function the function, of type BenchmarkFunction
+ * \param[in] allocations the maximum number of allocations per iteration
+ */
+#define BWBENCH_REGISTER_BUDGET(name, function, allocations) \
+    static bwbench::Registrar BWBENCH_CONCAT(_bwbenchRegistrar, __LINE__)(name, function, \
+                                                                         allocations)
+
+/**
+ * \brief Selects an allocation budget depending on move semantics
+ *
+ * Without C++11, a container copies its elements when it grows and a by-value parameter
+ * is copied when it's returned, so some operations allocate more often.
+ *
+ * \param[in] moved the budget if the library has been compiled as C++11 or later
+ * \param[in] copied the budget for C++98
+ */
+#if __cplusplus >= 201103L
+#  define BWBENCH_MOVE_BUDGET(moved, copied) (moved)
+#else
+#  define BWBENCH_MOVE_BUDGET(moved, copied) (copied)
+#endif
+
+/* }}} */
+/* Helper functions {{{ */
+
+/**
+ * \brief Prevents the compiler from optimizing \p value away
+ *
+ * \param[in] value the result of the benchmarked operation
+ */
+template <typename T>
+inline void doNotOptimize(const T &value)
+{
+#ifdef __GNUC__
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static const void *volatile sink;
+    sink = &value;
+#endif
+}
+
+/**
+ * \brief Returns a monotonic timestamp
+ *
+ * \return the time in nanoseconds since an unspecified point in the past
+ */
+unsigned long long now();
+
+/**
+ * \brief Returns the number of allocations so far
+ *
+ * Counts all variants of operator new. If the benchmarks have been built with
+ * \c BWBENCH_MALLOC_HOOKS on glibc, malloc(), calloc() and realloc() are counted instead,
+ * which includes operator new and allocations of C functions like strdup().
+ *
+ * \return the number of allocations in all threads
+ */
+unsigned long long allocationCount();
+
+/**
+ * \brief Returns the number of bytes allocated so far
+ *
+ * \return the sum of the sizes of the allocations counted by allocationCount()
+ */
+unsigned long long allocatedBytes();
+
+/* }}} */
+/* State {{{ */
+
+/**
+ * \brief Passed to each benchmark function
+ *
+ * The function has to perform the benchmarked operation iterations() times. Setup code
+ * that runs before the loop is measured too, so keep it cheap or put it into static
+ * variables.
+ */
+class State {
+
+public:
+    /**
+     * \brief Creates a new state
+     *
+     * \param[in] iterations the number of iterations of one batch
+     */
+    explicit State(size_t iterations)
+        : m_iterations(iterations)
+    {}
+
+    /**
+     * \brief Returns the number of iterations to run
+     *
+     * \return the number of times the operation has to be performed
+     */
+    size_t iterations() const
+    {
+        return m_iterations;
+    }
+
+private:
+    size_t m_iterations;
+};
+
+/**
+ * \brief Signature of a benchmark function
+ */
+typedef void (*BenchmarkFunction)(State &state);
+
+/* }}} */
+/* Registrar {{{ */
+
+/**
+ * \brief Adds a benchmark to the global list on construction
+ *
+ * Use BWBENCH_REGISTER() instead of creating objects directly.
+ */
+class Registrar {
+
+public:
+    /**
+     * \brief Value for \p budget that disables the allocation check
+     */
+    static const int NoBudget = -1;
+
+public:
+    /**
+     * \brief Registers \p function
+     *
+     * \param[in] name the name of the benchmark, must be a string literal
+     * \param[in] function the benchmark function
+     * \param[in] budget the maximum number of allocations per iteration, or NoBudget
+     */
+    Registrar(const char *name, BenchmarkFunction function, int budget=NoBudget);
+};
+
+/* }}} */
+/* Settings {{{ */
+
+/**
+ * \brief Parameters of a benchmark run
+ */
+struct Settings {
+    Settings()
+        : warmup(3)
+        , repetitions(20)
+        , batchTime(10000000)
+    {}
+
+    std::vector<std::string>    filters;        /**< substrings of the names to run, all
+                                                     if empty */
+    unsigned int                warmup;         /**< batches that are not measured */
+    unsigned int                repetitions;    /**< measured batches */
+    unsigned long long          batchTime;      /**< minimum duration of a batch in ns */
+};
+
+/* }}} */
+/* Result {{{ */
+
+/**
+ * \brief Measurements of one benchmark
+ */
+struct Result {
+    std::string         name;           /**< the registered name */
+    size_t              iterations;     /**< iterations per batch */
+    unsigned int        repetitions;    /**< number of measured batches */
+    double              median;         /**< median of the batches in ns/op */
+    double              p99;            /**< 99th percentile of the batches in ns/op */
+    double              min;            /**< fastest batch in ns/op */
+    double              mean;           /**< mean of the batches in ns/op */
+    double              allocations;    /**< operator new calls per op */
+    double              bytes;          /**< bytes allocated per op */
+    int                 budget;         /**< allowed allocations per op, or
+                                             Registrar::NoBudget */
+};
+
+/* }}} */
+/* Runner {{{ */
+
+/**
+ * \brief Runs the registered benchmarks
+ *
+ * Each benchmark is first calibrated: the number of iterations is doubled until one batch
+ * takes at least Settings::batchTime. Then Settings::warmup batches are run without
+ * measurement, followed by Settings::repetitions measured batches. The timings are
+ * reported per operation.
+ */
+class Runner {
+
+public:
+    /**
+     * \brief Creates a new runner
+     *
+     * \param[in] settings the parameters
+     */
+    explicit Runner(const Settings &settings);
+
+public:
+    /**
+     * \brief Returns the names of the benchmarks that match the filters
+     *
+     * \return the names in registration order
+     */
+    std::vector<std::string> names() const;
+
+    /**
+     * \brief Runs all benchmarks that match the filters
+     *
+     * Prints a line for each benchmark to stdout while running.
+     *
+     * \return the results
+     */
+    std::vector<Result> run() const;
+
+    /**
+     * \brief Writes \p results as JSON
+     *
+     * \param[in] filename the output file, which is overwritten
+     * \param[in] results the return value of run()
+     * \return \c true on success, \c false if the file cannot be written
+     */
+    bool writeJson(const char *filename, const std::vector<Result> &results) const;
+
+    /**
+     * \brief Checks the allocation budgets of all benchmarks that match the filters
+     *
+     * Doesn't measure the time. The allocations per iteration are the difference between
+     * a batch of 2n and a batch of n iterations, divided by n, so that allocations of the
+     * setup code and of one-time initialization don't count. Prints a line for each
+     * benchmark with a budget to stdout.
+     *
+     * \return \c true if no benchmark exceeds its budget, \c false otherwise
+     */
+    bool checkBudgets() const;
+
+private:
+    bool matches(const char *name) const;
+    Result measure(const char *name, BenchmarkFunction function, int budget) const;
+
+private:
+    Settings m_settings;
+};
+
+/* }}} */
+
+} // end namespace bwbench
+
+#endif /* BENCHMARKS_HARNESS_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
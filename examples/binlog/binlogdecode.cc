@@ -0,0 +1,77 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <iostream>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+
+#include <libbw/datetime.h>
+#include <libbw/log/binarylog.h>
+#include <libbw/log/debug.h>
+#include <libbw/log/errorlog.h>
+
+static const char *levelName(const bw::BinaryLogReader::Record &record)
+{
+    if (record.source == bw::BinaryLogWriter::BS_ERRORLOG)
+        return bw::Errorlog::levelToString(static_cast<bw::Errorlog::Level>(record.level));
+
+    switch (record.level) {
+        case bw::Debug::DL_TRACE:   return "TRACE";
+        case bw::Debug::DL_DEBUG:   return "DEBUG";
+        case bw::Debug::DL_INFO:    return "INFO";
+        default:                    return "";
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        std::cerr << "Usage: binlogdecode <filename>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bw::BinaryLogReader reader;
+    if (!reader.open(argv[1])) {
+        std::cerr << reader.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    bw::BinaryLogReader::Record record;
+    while (reader.read(record)) {
+        bw::Datetime time(static_cast<time_t>(record.time / 1000000));
+        std::printf("%s.%06lld %c [%-10.10s] %s\n",
+                    time.str().c_str(), record.time % 1000000,
+                    static_cast<char>(record.source), levelName(record), record.text.c_str());
+    }
+
+    if (!reader.error().empty()) {
+        std::cerr << reader.error() << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,59 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <iostream>
+#include <cstdlib>
+
+#include <libbw/log/debug.h>
+#include <libbw/log/errorlog.h>
+
+int main(int argc, char *argv[])
+{
+    if (argc != 3) {
+        std::cerr << "Usage: binlogwrite <debugfile> <errorfile>" << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!bw::Debug::debug()->setBinaryOutput(argv[1])) {
+        std::cerr << "Unable to open '" << argv[1] << "' for writing." << std::endl;
+        return EXIT_FAILURE;
+    }
+    bw::Debug::debug()->setLevel(bw::Debug::DL_TRACE);
+    bw::Errorlog::configure(bw::Errorlog::LM_BINARY, argv[2]);
+
+    for (int i = 0; i < 5; i++) {
+        BW_DEBUG_TRACE("Iteration %d of %d: %s", i, 5, "tracing");
+        BW_DEBUG_DBG("Value %.3f, hex %#x, size %zu", i * 1.5, i * 255, sizeof(int));
+        BW_DEBUG_STREAM_INFO("Stream output " << i);
+    }
+
+    BW_ERROR_WARNING("Warning with a %-8s|", "string");
+    BW_ERROR_ERR("Error %ld: %5.1f%%", 42L, 99.5);
+
+    bw::Errorlog::configure(bw::Errorlog::LM_FILE, "stderr");
+
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,182 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#include "arena.h"
+
+namespace bw {
+
+/* Arena {{{ */
+
+/**
+ * \brief Header of a heap block, the usable memory follows it
+ */
+struct Arena::Block {
+    Block   *next;
+    size_t  size;       // usable bytes behind the header
+
+    char *begin()
+    {
+        return reinterpret_cast<char *>(this) + HeaderSize;
+    }
+
+    static const size_t HeaderSize;
+};
+
+// keep the memory behind the header aligned for every type
+const size_t Arena::Block::HeaderSize =
+    (sizeof(Arena::Block) + Arena::MaxAlignment - 1) & ~(Arena::MaxAlignment - 1);
+
+/**
+ * \brief Largest size of a heap block that the arena allocates on its own
+ */
+static const size_t MaxBlockSize = 1024 * 1024;
+
+const size_t Arena::DefaultBlockSize;
+const size_t Arena::MaxAlignment;
+
+Arena::Arena(size_t blockSize)
+    : m_current(NULL)
+    , m_end(NULL)
+    , m_buffer(NULL)
+    , m_bufferSize(0)
+    , m_nextBlockSize(blockSize)
+    , m_blocks(NULL)
+    , m_spare(NULL)
+{}
+
+Arena::Arena(void *buffer, size_t size, size_t blockSize)
+    : m_current(static_cast<char *>(buffer))
+    , m_end(static_cast<char *>(buffer) + size)
+    , m_buffer(static_cast<char *>(buffer))
+    , m_bufferSize(size)
+    , m_nextBlockSize(blockSize)
+    , m_blocks(NULL)
+    , m_spare(NULL)
+{}
+
+Arena::~Arena()
+{
+    reset();
+    std::free(m_spare);
+}
+
+char *Arena::strdup(const StringView &str)
+{
+    char *copy = static_cast<char *>(allocate(str.size() + 1, 1));
+    std::memcpy(copy, str.data(), str.size());
+    copy[str.size()] = '\0';
+    return copy;
+}
+
+void Arena::reset()
+{
+    // keep the largest block
+    Block *largest = m_spare;
+    while (m_blocks) {
+        Block *block = m_blocks;
+        m_blocks = block->next;
+        if (!largest || block->size > largest->size) {
+            std::free(largest);
+            largest = block;
+        } else
+            std::free(block);
+    }
+    m_spare = largest;
+
+    m_current = m_buffer;
+    m_end = m_buffer + m_bufferSize;
+}
+
+size_t Arena::bytesAllocated() const
+{
+    size_t bytes = m_spare ? m_spare->size + Block::HeaderSize : 0;
+    for (Block *block = m_blocks; block; block = block->next)
+        bytes += block->size + Block::HeaderSize;
+    return bytes;
+}
+
+Arena::Block *Arena::newBlock(size_t size)
+{
+    if (size > static_cast<size_t>(-1) - Block::HeaderSize)
+        throw std::bad_alloc();
+
+    Block *block = static_cast<Block *>(std::malloc(Block::HeaderSize + size));
+    if (!block)
+        throw std::bad_alloc();
+
+    block->next = NULL;
+    block->size = size;
+    return block;
+}
+
+void *Arena::allocateSlow(size_t size, size_t alignment)
+{
+    if (size == 0) {
+        size = 1;
+        void *p = tryAllocate(size, alignment);
+        if (p)
+            return p;
+    }
+
+    // blocks start aligned to MaxAlignment, so no padding is necessary at the beginning
+    if (size > m_nextBlockSize / 2) {
+        // large allocations get their own block, and the current block stays in use
+        Block *block = newBlock(size);
+        if (m_blocks) {
+            block->next = m_blocks->next;
+            m_blocks->next = block;
+        } else
+            m_blocks = block;
+        return block->begin();
+    }
+
+    Block *block;
+    if (m_spare && m_spare->size >= size) {
+        block = m_spare;
+        m_spare = NULL;
+    } else {
+        block = newBlock(m_nextBlockSize);
+        m_nextBlockSize = std::min(2 * m_nextBlockSize, MaxBlockSize);
+    }
+
+    block->next = m_blocks;
+    m_blocks = block;
+    m_current = block->begin();
+    m_end = m_current + block->size;
+
+    return tryAllocate(size, alignment);
+}
+
+/* }}} */
+
+} // end namespace bw
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,334 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_ARENA_H_
+#define LIBBW_ARENA_H_
+
+#include <cstddef>
+#include <limits>
+#include <new>
+
+#include <libbw/noncopyable.h>
+#include <libbw/stringview.h>
+
+namespace bw {
+
+/* Arena {{{ */
+
+/**
+ * \class Arena arena.h libbw/arena.h
+ * \brief Monotonic allocator that frees everything at once
+ *
+ * Memory is handed out sequentially from large blocks. Single allocations are never freed;
+ * instead, all memory is released together by reset() or by the destructor. That makes
+ * allocating a pointer increment and freeing the results of a whole request one call,
+ * instead of thousands of frees.
+ *
+ * The arena can start with a buffer provided by the caller, typically on the stack, and only
+ * allocates blocks from the heap when that is exhausted. The blocks grow from the block size
+ * passed to the constructor up to 1 MiB.
+ *
+ * Destructors of objects in the arena are not called. Use ArenaAllocator to place standard
+ * containers in an arena.
+ *
+ * Example:
+ *
+ * \code
+ * char buffer[4096];
+ * bw::Arena arena(buffer, sizeof(buffer));
+ *
+ * std::vector<bw::StringView, bw::ArenaAllocator<bw::StringView> > fields =
+ *     bw::stringsplit(line, ",", arena);
+ * \endcode
+ *
+ * An arena is not thread-safe.
+ *
+ * \ingroup misc
+ */
+class Arena : private Noncopyable {
+
+public:
+    /**
+     * \brief Default size of the first heap block
+     */
+    static const size_t DefaultBlockSize = 4096;
+
+    /**
+     * \brief Alignment that is sufficient for every type, like malloc()
+     */
+    static const size_t MaxAlignment = 2 * sizeof(void *);
+
+public:
+    /**
+     * \brief Creates an arena that allocates all memory from the heap
+     *
+     * \param[in] blockSize the size of the first block, the following blocks get larger
+     */
+    explicit Arena(size_t blockSize = DefaultBlockSize);
+
+    /**
+     * \brief Creates an arena that uses \p buffer first
+     *
+     * \param[in] buffer memory that is used before heap blocks are allocated, it is not
+     *            freed by the arena and must outlive it
+     * \param[in] size the size of \p buffer
+     * \param[in] blockSize the size of the first heap block
+     */
+    Arena(void *buffer, size_t size, size_t blockSize = DefaultBlockSize);
+
+    /**
+     * \brief Frees all memory
+     */
+    ~Arena();
+
+    /**
+     * \brief Allocates memory
+     *
+     * \param[in] size the number of bytes
+     * \param[in] alignment the alignment, a power of two up to MaxAlignment
+     * \return the memory, never \c NULL
+     * \exception std::bad_alloc if no more memory is available
+     */
+    void *allocate(size_t size, size_t alignment = MaxAlignment)
+    {
+        void *p = tryAllocate(size, alignment);
+        return p ? p : allocateSlow(size, alignment);
+    }
+
+    /**
+     * \brief Copies a string into the arena
+     *
+     * \param[in] str the string
+     * \return a NUL-terminated copy of \p str
+     * \exception std::bad_alloc if no more memory is available
+     */
+    char *strdup(const StringView &str);
+
+    /**
+     * \brief Frees all allocations
+     *
+     * The caller's buffer and the largest heap block are kept for the next allocations, so
+     * an arena that is reset after each request stops allocating from the heap once the
+     * largest block is large enough.
+     */
+    void reset();
+
+    /**
+     * \brief Returns the memory allocated from the heap
+     *
+     * \return the total size of all heap blocks in bytes
+     */
+    size_t bytesAllocated() const;
+
+    /**
+     * \brief Returns the alignment to use for objects of a size
+     *
+     * That is the largest power of two that divides \p size, up to MaxAlignment. In C++98
+     * the alignment of a type cannot be queried, but it always divides its size.
+     *
+     * \param[in] size the size of the object
+     * \return the alignment
+     */
+    static size_t alignmentFor(size_t size)
+    {
+        size_t alignment = size & (~size + 1);
+        return alignment == 0 || alignment > MaxAlignment ? MaxAlignment : alignment;
+    }
+
+private:
+    struct Block;
+
+    void *tryAllocate(size_t size, size_t alignment)
+    {
+        size_t padding = (alignment - reinterpret_cast<size_t>(m_current)) & (alignment - 1);
+        size_t available = m_end - m_current;
+
+        // size - 1 sends empty allocations to the slow path, so they don't return NULL
+        if (size - 1 < available && padding <= available - size) {
+            char *p = m_current + padding;
+            m_current = p + size;
+            return p;
+        }
+        return NULL;
+    }
+
+    void *allocateSlow(size_t size, size_t alignment);
+    static Block *newBlock(size_t size);
+
+private:
+    char    *m_current;
+    char    *m_end;
+    char    *m_buffer;
+    size_t  m_bufferSize;
+    size_t  m_nextBlockSize;
+    Block   *m_blocks;
+    Block   *m_spare;
+};
+
+/* }}} */
+/* ArenaAllocator {{{ */
+
+/**
+ * \class ArenaAllocator arena.h libbw/arena.h
+ * \brief Standard allocator that allocates from an Arena
+ *
+ * deallocate() does nothing, the memory is freed with the arena. The container must not be
+ * used after the arena has been reset or destroyed. Copies of the allocator, also of other
+ * value types, use the same arena.
+ *
+ * \code
+ * bw::Arena arena;
+ * std::vector<int, bw::ArenaAllocator<int> > numbers(arena);
+ * \endcode
+ *
+ * \ingroup misc
+ */
+template <typename T>
+class ArenaAllocator {
+
+public:
+    /// \cond
+    typedef T               value_type;
+    typedef T               *pointer;
+    typedef const T         *const_pointer;
+    typedef T               &reference;
+    typedef const T         &const_reference;
+    typedef size_t          size_type;
+    typedef std::ptrdiff_t  difference_type;
+
+    template <typename U>
+    struct rebind {
+        typedef ArenaAllocator<U> other;
+    };
+    /// \endcond
+
+public:
+    /**
+     * \brief Creates an allocator for \p arena
+     *
+     * \param[in] arena the arena, must outlive the allocator and everything allocated
+     */
+    ArenaAllocator(Arena &arena)
+        : m_arena(&arena)
+    {}
+
+    /**
+     * \brief Creates an allocator that uses the same arena as \p other
+     *
+     * \param[in] other the other allocator
+     */
+    template <typename U>
+    ArenaAllocator(const ArenaAllocator<U> &other)
+        : m_arena(other.arena())
+    {}
+
+    /**
+     * \brief Returns the arena
+     *
+     * \return the arena
+     */
+    Arena *arena() const
+    {
+        return m_arena;
+    }
+
+    /// \cond
+    pointer address(reference value) const
+    {
+        return &value;
+    }
+
+    const_pointer address(const_reference value) const
+    {
+        return &value;
+    }
+
+    pointer allocate(size_type count, const void * = NULL)
+    {
+        if (count > max_size())
+            throw std::bad_alloc();
+        return static_cast<pointer>(m_arena->allocate(count * sizeof(T),
+                                                      Arena::alignmentFor(sizeof(T))));
+    }
+
+    void deallocate(pointer, size_type)
+    {}
+
+    size_type max_size() const
+    {
+        return std::numeric_limits<size_type>::max() / sizeof(T);
+    }
+
+    void construct(pointer p, const T &value)
+    {
+        new (static_cast<void *>(p)) T(value);
+    }
+
+    void destroy(pointer p)
+    {
+        p->~T();
+    }
+    /// \endcond
+
+private:
+    Arena *m_arena;
+};
+
+/**
+ * \brief Compares two arena allocators
+ *
+ * \param[in] a the first allocator
+ * \param[in] b the second allocator
+ * \return \c true if both allocate from the same arena
+ * \ingroup misc
+ */
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+    return a.arena() == b.arena();
+}
+
+/**
+ * \brief Compares two arena allocators
+ *
+ * \param[in] a the first allocator
+ * \param[in] b the second allocator
+ * \return \c true if the allocators use different arenas
+ * \ingroup misc
+ */
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &a, const ArenaAllocator<U> &b)
+{
+    return a.arena() != b.arena();
+}
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_ARENA_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -29,6 +29,7 @@
 #define LIBBW_COMPILER_H_
 
 #include "bwerror.h"
+#include <cstdarg>
 #include <vector>
 
 /**
@@ -81,4 +82,73 @@
 #define BW_COMPILER_STRFTIME_FORMAT(string_index, first_to_check)
 #endif
 
+/**
+ * \brief Declares a variable with thread storage duration
+ *
+ * Only works for plain old data types without constructors. On compilers without
+ * known thread-local storage support, the variable is an ordinary static variable.
+ *
+ * \ingroup misc
+ */
+#if defined(__GNUC__)
+#define BW_COMPILER_THREAD_LOCAL __thread
+#elif defined(_MSC_VER)
+#define BW_COMPILER_THREAD_LOCAL __declspec(thread)
+#else
+#define BW_COMPILER_THREAD_LOCAL
+#endif
+
+/**
+ * \brief Reads a variable that other threads may modify concurrently
+ *
+ * Atomic load without ordering constraints, like <tt>std::memory_order_relaxed</tt>. Meant
+ * for flags and levels in public headers that cannot depend on libbw/thread/atomic.h. On
+ * compilers without the <tt>__atomic</tt> builtins, the variable is read directly.
+ *
+ * \param[in] variable the variable (not a pointer to it)
+ * \ingroup misc
+ */
+#if defined(__GNUC__)
+#define BW_COMPILER_LOAD_RELAXED(variable) \
+    __atomic_load_n(&(variable), __ATOMIC_RELAXED)
+#else
+#define BW_COMPILER_LOAD_RELAXED(variable) \
+    (variable)
+#endif
+
+/**
+ * \brief Writes a variable that other threads may read concurrently
+ *
+ * Counterpart of BW_COMPILER_LOAD_RELAXED().
+ *
+ * \param[in] variable the variable (not a pointer to it)
+ * \param[in] value the new value
+ * \ingroup misc
+ */
+#if defined(__GNUC__)
+#define BW_COMPILER_STORE_RELAXED(variable, value) \
+    __atomic_store_n(&(variable), (value), __ATOMIC_RELAXED)
+#else
+#define BW_COMPILER_STORE_RELAXED(variable, value) \
+    ((variable) = (value))
+#endif
+
+/**
+ * \brief Copies a <tt>std::va_list</tt>
+ *
+ * <tt>va_copy()</tt> is part of C99 and C++11 but not of C++98, where GCC only provides
+ * <tt>__va_copy()</tt>. Each copy must be released with <tt>va_end()</tt>.
+ *
+ * \param[out] dest the uninitialized copy
+ * \param[in] src the argument list to copy
+ * \ingroup misc
+ */
+#if defined(va_copy)
+#define BW_COMPILER_VA_COPY(dest, src) \
+    va_copy(dest, src)
+#else
+#define BW_COMPILER_VA_COPY(dest, src) \
+    __va_copy(dest, src)
+#endif
+
 #endif /* LIBBW_COMPILER_H_ */
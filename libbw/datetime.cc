@@ -211,18 +211,30 @@ std::string Datetime::strftime(const char *format) const
 
 std::string Datetime::str() const
 {
-    char buffer[80];
-    std::sprintf(buffer, "%04d-%02d-%02d %02d:%02d:%02d",
-             year(), month(), day(), hour(), minute(), second());
-
-    return std::string(buffer);
+    return fixedStr().str();
 }
 
 std::string Datetime::dateStr() const
 {
-    char buffer[11];
-    std::sprintf(buffer, "%04d-%02d-%02d", year(), month(), day());
-    return std::string(buffer);
+    return fixedDateStr().str();
+}
+
+FixedString<32> Datetime::fixedStr() const
+{
+    FixedString<32> result = fixedDateStr();
+    result.append(' ').appendNumber(hour(), 2);
+    result.append(':').appendNumber(minute(), 2);
+    result.append(':').appendNumber(second(), 2);
+    return result;
+}
+
+FixedString<32> Datetime::fixedDateStr() const
+{
+    FixedString<32> result;
+    result.appendNumber(year(), 4);
+    result.append('-').appendNumber(month(), 2);
+    result.append('-').appendNumber(day(), 2);
+    return result;
 }
 
 long long Datetime::secsTo(const Datetime &time) const
@@ -274,8 +286,7 @@ Datetime &Datetime::fillTime()
 
 std::ostream &operator<<(std::ostream &os, const bw::Datetime &datetime)
 {
-    os << datetime.str();
-    return os;
+    return os << datetime.fixedStr();
 }
 
 /* }}} */
@@ -32,6 +32,7 @@
 #include <ctime>
 
 #include "compiler.h"
+#include "fixedstring.h"
 
 namespace bw {
 
@@ -282,6 +283,20 @@ public:
      */
     std::string dateStr() const;
 
+    /**
+     * \brief Converts the datetime object to a human readable string without allocating
+     *
+     * \return the string in the same format as str(), on the stack
+     */
+    FixedString<32> fixedStr() const;
+
+    /**
+     * \brief Converts the datetime object to a human readable date string without allocating
+     *
+     * \return the date string in the same format as dateStr(), on the stack
+     */
+    FixedString<32> fixedDateStr() const;
+
     /**
      * \brief Calculates the seconds from \c this to \c time.
      *
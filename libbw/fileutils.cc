@@ -201,14 +201,20 @@ void FileUtils::mkdir(const std::string &dir, bool recursive)
 
 std::string FileUtils::join(const std::string &a, const std::string &b)
 {
-    return a + "/" + b;
+    std::string ret;
+    ret.reserve(a.size() + 1 + b.size());
+    ret.append(a).append(1, '/').append(b);
+    return ret;
 }
 
 std::string FileUtils::join(const std::string &a,
                             const std::string &b,
                             const std::string &c)
 {
-    return a + "/" + b + "/" + c;
+    std::string ret;
+    ret.reserve(a.size() + 1 + b.size() + 1 + c.size());
+    ret.append(a).append(1, '/').append(b).append(1, '/').append(c);
+    return ret;
 }
 
 std::string basename(const std::string &path)
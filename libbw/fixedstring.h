@@ -0,0 +1,402 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_FIXEDSTRING_H_
+#define LIBBW_FIXEDSTRING_H_
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+#include <libbw/compiler.h>
+#include <libbw/stringutil.h>
+#include <libbw/stringview.h>
+
+namespace bw {
+
+/* FixedString {{{ */
+
+/**
+ * \class FixedString fixedstring.h libbw/fixedstring.h
+ * \brief String with a fixed capacity that never allocates memory
+ *
+ * The characters are stored inside the object, so a FixedString can be returned by value
+ * and lives on the stack. It's meant for short results like timestamps and numbers that
+ * would otherwise be formatted into a stack buffer and then copied into a std::string.
+ *
+ * Appending more than \p N characters doesn't fail: the result is cut at the capacity and
+ * truncated() returns \c true. The string is always NUL-terminated.
+ *
+ * Example:
+ *
+ * \code
+ * bw::FixedString<32> line;
+ * line.append(Datetime::now().fixedStr()).append(' ').appendNumber(value, 6);
+ * std::fwrite(line.data(), 1, line.size(), stdout);
+ * \endcode
+ *
+ * \ingroup string
+ */
+template <size_t N>
+class FixedString {
+
+public:
+    /**
+     * \brief The maximum number of characters, without the NUL byte
+     */
+    static const size_t Capacity = N;
+
+public:
+    /**
+     * \brief Creates an empty string
+     */
+    FixedString()
+        : m_size(0)
+        , m_truncated(false)
+    {
+        m_data[0] = '\0';
+    }
+
+    /**
+     * \brief Creates a copy of \p str, truncated to the capacity
+     *
+     * \param[in] str the string
+     */
+    FixedString(const StringView &str)
+        : m_size(0)
+        , m_truncated(false)
+    {
+        m_data[0] = '\0';
+        append(str);
+    }
+
+    /**
+     * \brief Creates a copy of \p str, truncated to the capacity
+     *
+     * \param[in] str the NUL-terminated string, must not be \c NULL
+     */
+    FixedString(const char *str)
+        : m_size(0)
+        , m_truncated(false)
+    {
+        m_data[0] = '\0';
+        append(StringView(str));
+    }
+
+public:
+    /**
+     * \brief Returns the characters
+     *
+     * \return a pointer to the NUL-terminated string
+     */
+    const char *c_str() const
+    {
+        return m_data;
+    }
+
+    /**
+     * \brief Returns the characters
+     *
+     * \return a pointer to the NUL-terminated string
+     */
+    const char *data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * \brief Returns the buffer to write into directly
+     *
+     * It has room for Capacity characters and the NUL byte. Call resize() afterwards.
+     *
+     * \return the buffer
+     */
+    char *data()
+    {
+        return m_data;
+    }
+
+    /**
+     * \brief Returns the length
+     *
+     * \return the number of characters
+     */
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * \brief Returns the length
+     *
+     * \return the number of characters
+     */
+    size_t length() const
+    {
+        return m_size;
+    }
+
+    /**
+     * \brief Checks for the empty string
+     *
+     * \return \c true if size() is 0
+     */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * \brief Checks if characters have been cut off
+     *
+     * \return \c true if an append operation didn't fit, until clear() is called
+     */
+    bool truncated() const
+    {
+        return m_truncated;
+    }
+
+    /**
+     * \brief Returns a character
+     *
+     * \param[in] pos the position, must be less than size()
+     * \return the character
+     */
+    char operator[](size_t pos) const
+    {
+        return m_data[pos];
+    }
+
+    /**
+     * \brief Returns a view of the characters
+     *
+     * \return the view, valid as long as the string is not modified
+     */
+    StringView view() const
+    {
+        return StringView(m_data, m_size);
+    }
+
+    /**
+     * \brief Copies the characters into a std::string
+     *
+     * \return the copy
+     */
+    std::string str() const
+    {
+        return std::string(m_data, m_size);
+    }
+
+    /**
+     * \brief Removes all characters and resets truncated()
+     */
+    void clear()
+    {
+        m_size = 0;
+        m_truncated = false;
+        m_data[0] = '\0';
+    }
+
+    /**
+     * \brief Sets the length after writing into data()
+     *
+     * \param[in] size the new length, values larger than the capacity are cut
+     */
+    void resize(size_t size)
+    {
+        m_size = size < N ? size : N;
+        m_data[m_size] = '\0';
+    }
+
+    /**
+     * \brief Appends a string
+     *
+     * \param[in] str the string
+     * \return a self reference
+     */
+    FixedString &append(const StringView &str)
+    {
+        size_t length = str.size();
+        if (length > N - m_size) {
+            length = N - m_size;
+            m_truncated = true;
+        }
+        std::memcpy(m_data + m_size, str.data(), length);
+        m_size += length;
+        m_data[m_size] = '\0';
+        return *this;
+    }
+
+    /**
+     * \brief Appends a character
+     *
+     * \param[in] c the character
+     * \return a self reference
+     */
+    FixedString &append(char c)
+    {
+        if (m_size == N)
+            m_truncated = true;
+        else {
+            m_data[m_size++] = c;
+            m_data[m_size] = '\0';
+        }
+        return *this;
+    }
+
+    /**
+     * \brief Appends a number
+     *
+     * The number is formatted with formatNumber(), so it doesn't depend on the locale.
+     *
+     * \param[in] value an integer or floating point number
+     * \param[in] width the minimum width, shorter numbers are padded with zeros behind the
+     *            sign like <tt>printf("%0*d")</tt>
+     * \return a self reference
+     */
+    template <typename T>
+    FixedString &appendNumber(T value, size_t width = 0)
+    {
+        char digits[MaxNumberLength];
+        size_t length = formatNumber(digits, sizeof(digits), value);
+        const char *p = digits;
+
+        if (length > 0 && *p == '-') {
+            append('-');
+            ++p;
+            --length;
+            width = width > 0 ? width - 1 : 0;
+        }
+        for (; width > length; --width)
+            append('0');
+
+        return append(StringView(p, length));
+    }
+
+    /**
+     * \brief Appends formatted text like <tt>printf()</tt>
+     *
+     * \param[in] format the format string
+     * \return a self reference
+     */
+    FixedString &appendFormat(const char *format, ...)
+    BW_COMPILER_PRINTF_FORMAT(2, 3)
+    {
+        std::va_list args;
+        va_start(args, format);
+        int length = std::vsnprintf(m_data + m_size, N - m_size + 1, format, args);
+        va_end(args);
+
+        if (length < 0)
+            m_data[m_size] = '\0';
+        else if (static_cast<size_t>(length) > N - m_size) {
+            m_size = N;
+            m_truncated = true;
+        } else
+            m_size += length;
+
+        return *this;
+    }
+
+    /**
+     * \brief Appends a string
+     *
+     * \param[in] str the string
+     * \return a self reference
+     */
+    FixedString &operator+=(const StringView &str)
+    {
+        return append(str);
+    }
+
+    /**
+     * \brief Appends a character
+     *
+     * \param[in] c the character
+     * \return a self reference
+     */
+    FixedString &operator+=(char c)
+    {
+        return append(c);
+    }
+
+    /**
+     * \brief Compares the characters
+     *
+     * \param[in] other the other string
+     * \return \c true if both contain the same characters
+     */
+    bool operator==(const StringView &other) const
+    {
+        return view() == other;
+    }
+
+    /**
+     * \brief Compares the characters
+     *
+     * \param[in] other the other string
+     * \return \c true if the characters differ
+     */
+    bool operator!=(const StringView &other) const
+    {
+        return view() != other;
+    }
+
+private:
+    size_t  m_size;
+    bool    m_truncated;
+    char    m_data[N + 1];
+};
+
+/// \cond
+template <size_t N>
+const size_t FixedString<N>::Capacity;
+/// \endcond
+
+/**
+ * \brief Writes a FixedString to a stream
+ *
+ * \param[in] os the stream
+ * \param[in] str the string
+ * \return \p os
+ * \ingroup string
+ */
+template <size_t N>
+std::ostream &operator<<(std::ostream &os, const FixedString<N> &str)
+{
+    return os.write(str.data(), str.size());
+}
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_FIXEDSTRING_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
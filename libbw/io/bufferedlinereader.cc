@@ -0,0 +1,198 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cerrno>
+#include <cstring>
+#include <string>
+
+#include <unistd.h>
+
+#include <libbw/stringscan.h>
+#include "bufferedlinereader.h"
+
+namespace bw {
+namespace io {
+
+/* BufferedLineReader {{{ */
+
+BufferedLineReader::BufferedLineReader(int fd, size_t bufferSize)
+    : m_fd(fd)
+    , m_buffer(NULL)
+    , m_capacity(bufferSize > 0 ? bufferSize : DefaultBufferSize)
+    , m_begin(0)
+    , m_end(0)
+    , m_scanned(0)
+    , m_lineNumber(0)
+    , m_eof(false)
+    , m_skipLineFeed(false)
+{}
+
+BufferedLineReader::~BufferedLineReader()
+{
+    delete[] m_buffer;
+}
+
+bool BufferedLineReader::readLine(StringView &line)
+{
+    for (;;) {
+        skipLineFeed();
+
+        const char *begin = m_buffer + m_begin;
+        const char *end = m_buffer + m_end;
+
+        // m_scanned bytes of the incomplete line have already been searched before
+        const char *newline = findNewline(begin + m_scanned, end);
+        if (newline != end) {
+            line = StringView(begin, newline - begin);
+
+            size_t next = newline - m_buffer + 1;
+            if (*newline == '\r') {
+                if (next == m_end)
+                    m_skipLineFeed = true;
+                else if (m_buffer[next] == '\n')
+                    ++next;
+            }
+
+            m_begin = next;
+            m_scanned = 0;
+            ++m_lineNumber;
+            return true;
+        }
+
+        if (m_eof) {
+            if (begin == end)
+                return false;
+
+            line = StringView(begin, end - begin);
+            m_begin = m_end;
+            m_scanned = 0;
+            ++m_lineNumber;
+            return true;
+        }
+
+        m_scanned = m_end - m_begin;
+        if (!fill())
+            return false;
+    }
+}
+
+bool BufferedLineReader::readAvailable(StringView &data)
+{
+    skipLineFeed();
+
+    if (m_begin == m_end) {
+        if (m_eof || !fill())
+            return false;
+
+        skipLineFeed();
+        if (m_begin == m_end)
+            return false;
+    }
+
+    data = StringView(m_buffer + m_begin, m_end - m_begin);
+    m_begin = m_end;
+    m_scanned = 0;
+    return true;
+}
+
+bool BufferedLineReader::eof() const
+{
+    return m_eof && m_begin == m_end;
+}
+
+size_t BufferedLineReader::lineNumber() const
+{
+    return m_lineNumber;
+}
+
+int BufferedLineReader::fd() const
+{
+    return m_fd;
+}
+
+void BufferedLineReader::reset(int fd)
+{
+    m_fd = fd;
+    m_begin = m_end = m_scanned = 0;
+    m_lineNumber = 0;
+    m_eof = false;
+    m_skipLineFeed = false;
+}
+
+// drops the '\n' of a "\r\n" whose '\r' was the last buffered byte when the line was returned
+void BufferedLineReader::skipLineFeed()
+{
+    if (!m_skipLineFeed || m_begin == m_end)
+        return;
+
+    if (m_buffer[m_begin] == '\n')
+        ++m_begin;
+    m_skipLineFeed = false;
+}
+
+bool BufferedLineReader::fill()
+{
+    if (!m_buffer)
+        m_buffer = new char[m_capacity];
+
+    // move the incomplete line to the front, or grow if it fills the whole buffer
+    if (m_begin > 0) {
+        std::memmove(m_buffer, m_buffer + m_begin, m_end - m_begin);
+        m_end -= m_begin;
+        m_begin = 0;
+    } else if (m_end == m_capacity) {
+        char *buffer = new char[m_capacity * 2];
+        std::memcpy(buffer, m_buffer, m_end);
+        delete[] m_buffer;
+        m_buffer = buffer;
+        m_capacity *= 2;
+    }
+
+    for (;;) {
+        ssize_t ret = ::read(m_fd, m_buffer + m_end, m_capacity - m_end);
+        if (ret > 0) {
+            m_end += ret;
+            return true;
+        } else if (ret == 0) {
+            m_eof = true;
+            return true;
+        }
+
+        if (errno == EINTR)
+            continue;
+        if (errno == EAGAIN || errno == EWOULDBLOCK)
+            return false;
+
+        throw IOError(std::string(std::strerror(errno)));
+    }
+}
+
+/* }}} */
+
+} // end namespace io
+} // end namespace bw
+
+// vim: set sw=4 ts=4 et fdm=marker:
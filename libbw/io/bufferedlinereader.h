@@ -0,0 +1,178 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_IO_BUFFEREDLINEREADER_H_
+#define LIBBW_IO_BUFFEREDLINEREADER_H_
+
+#include <cstddef>
+
+#include <libbw/bwerror.h>
+#include <libbw/noncopyable.h>
+#include <libbw/stringview.h>
+
+namespace bw {
+namespace io {
+
+/* BufferedLineReader {{{ */
+
+/**
+ * \class BufferedLineReader bufferedlinereader.h libbw/io/bufferedlinereader.h
+ * \brief Splits the data read from a file descriptor into lines
+ *
+ * The data is read in large chunks, and line endings are found with the vectorized
+ * findNewline(). The lines are returned as views into the internal buffer, so reading a
+ * line normally neither copies nor allocates.
+ *
+ * <tt>"\\n"</tt>, <tt>"\\r\\n"</tt> and a single <tt>"\\r"</tt> terminate a line, and the
+ * terminator is not part of the result. A <tt>"\\r\\n"</tt> that is split between two reads
+ * still counts as one line ending, without waiting for the next byte after the
+ * <tt>'\\r'</tt>. That matters for serial ports and pipes, where the rest may arrive much
+ * later. A last line without terminator is returned at the end of the file.
+ *
+ * Lines that don't fit into the buffer make it grow, so the line length is not limited.
+ *
+ * Example:
+ *
+ * \code
+ * bw::io::BufferedLineReader reader(STDIN_FILENO);
+ * bw::StringView line;
+ * while (reader.readLine(line))
+ *     process(line);
+ * \endcode
+ *
+ * The file descriptor is neither opened nor closed by the reader. Data that has been
+ * buffered is lost for other readers of the same file descriptor, use readAvailable() to
+ * get it.
+ *
+ * \ingroup io
+ */
+class BufferedLineReader : private Noncopyable {
+
+public:
+    /**
+     * \brief Default size of the buffer
+     */
+    static const size_t DefaultBufferSize = 64 * 1024;
+
+public:
+    /**
+     * \brief Creates a new line reader
+     *
+     * The buffer is allocated with the first read.
+     *
+     * \param[in] fd the file descriptor, may be -1 and set later with reset()
+     * \param[in] bufferSize the initial size of the buffer, which is also the maximum
+     *            number of bytes read with one system call
+     */
+    explicit BufferedLineReader(int fd, size_t bufferSize = DefaultBufferSize);
+
+    /**
+     * \brief Frees the buffer
+     */
+    ~BufferedLineReader();
+
+    /**
+     * \brief Reads the next line
+     *
+     * Blocks until a complete line is available, unless the file descriptor is non-blocking.
+     *
+     * \param[out] line the line without terminator. The view is valid until the next call
+     *             of a member function that reads.
+     * \return \c true if a line has been read, \c false at the end of the file or if a
+     *         non-blocking file descriptor has no complete line yet. eof() distinguishes
+     *         both.
+     * \exception IOError if reading fails
+     */
+    bool readLine(StringView &line);
+
+    /**
+     * \brief Returns the buffered data or reads once
+     *
+     * Used to mix line based and unstructured input. If data is buffered, it is returned
+     * without reading. Otherwise, the file descriptor is read once.
+     *
+     * \param[out] data the data, valid until the next call of a member function that reads
+     * \return \c true if data has been returned, \c false at the end of the file or if a
+     *         non-blocking file descriptor has no data
+     * \exception IOError if reading fails
+     */
+    bool readAvailable(StringView &data);
+
+    /**
+     * \brief Checks for the end of the file
+     *
+     * \return \c true if the end of the file has been reached and all data has been returned
+     */
+    bool eof() const;
+
+    /**
+     * \brief Returns the number of lines that have been read
+     *
+     * \return the number of lines returned by readLine() since the construction or since
+     *         the last reset()
+     */
+    size_t lineNumber() const;
+
+    /**
+     * \brief Returns the file descriptor
+     *
+     * \return the file descriptor passed to the constructor or reset()
+     */
+    int fd() const;
+
+    /**
+     * \brief Starts reading another file descriptor
+     *
+     * Buffered data is discarded, the buffer itself is kept.
+     *
+     * \param[in] fd the new file descriptor, also after the old one has been seeked
+     */
+    void reset(int fd);
+
+private:
+    void skipLineFeed();
+    bool fill();
+
+private:
+    int     m_fd;
+    char    *m_buffer;
+    size_t  m_capacity;
+    size_t  m_begin;
+    size_t  m_end;
+    size_t  m_scanned;
+    size_t  m_lineNumber;
+    bool    m_eof;
+    bool    m_skipLineFeed;
+};
+
+/* }}} */
+
+} // end namespace io
+} // end namespace bw
+
+#endif /* LIBBW_IO_BUFFEREDLINEREADER_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
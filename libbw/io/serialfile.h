@@ -32,6 +32,7 @@
 #include <iostream>
 
 #include <libbw/bwerror.h>
+#include <libbw/stringutil.h>
 
 /**
  * \file serialfile.h libbw/io/serialfile.h
@@ -167,9 +168,10 @@ public:
     /**
      * \brief Reads a line
      *
-     * This function is not as efficient as operator>>, but it guarantees that a single line is
-     * read. Both <tt>'\\r'</tt> and <tt>'\\r\\n'</tt> are understood as line separators and the
-     * result is returned without any line termination characters.
+     * Unlike operator>>, it guarantees that a single line is read. The input is buffered, so
+     * data after the line is returned by the next call of readLine() or operator>>.
+     * <tt>'\\n'</tt>, <tt>'\\r'</tt> and <tt>'\\r\\n'</tt> are understood as line separators and
+     * the result is returned without any line termination characters.
      *
      * \return the line that has been read without line terminators
      */
@@ -210,6 +212,16 @@ public:
      */
     std::string str() const;
 
+    /**
+     * \brief Returns the port name without copying it
+     *
+     * The name is stored in the global StringPool, so it can be used as a cheap key and
+     * compared in O(1) with other interned names.
+     *
+     * \return the port name passed to the constructor
+     */
+    InternedString getInternedName() const;
+
 protected:
     /**
      * \brief Creates a lock for the serial port
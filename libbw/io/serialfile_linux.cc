@@ -76,7 +76,7 @@ static std::string computeLockFileName(const std::string &portName)
 /* ---------------------------------------------------------------------------------------------- */
 bool SerialFile::createLock()
 {
-    d->lockfile = computeLockFileName(d->fileName);
+    d->lockfile = computeLockFileName(d->fileName.str());
 
     // if we don't need locking, everything is sane
     if (d->lockfile.empty())
@@ -70,6 +70,7 @@ bool SerialFile::openPort()
         removeLock();
         return false;
     }
+    d->reader.reset(d->fd);
 
     return true;
 }
@@ -81,6 +82,7 @@ void SerialFile::closePort()
 
     close(d->fd);
     d->fd = -1;
+    d->reader.reset(-1);
     removeLock();
 }
 
@@ -103,37 +105,34 @@ SerialFile &SerialFile::operator<<(char c)
 
 SerialFile &SerialFile::operator>>(std::string& str)
 {
-    char buffer[BUFSIZ];
-
-    int ret = read(d->fd, buffer, BUFSIZ);
-    if (ret < 0) {
-        d->lastError = std::string(std::strerror(errno));
-        throw IOError(getLastError());
+    StringView data;
+
+    try {
+        if (!d->reader.readAvailable(data) && !d->reader.eof())
+            throw IOError(std::string(std::strerror(EAGAIN)));
+    } catch (const IOError &err) {
+        d->lastError = err.what();
+        throw;
     }
 
-    str = std::string(buffer, ret);
+    str.assign(data.data(), data.size());
 
     return *this;
 }
 
 std::string SerialFile::readLine()
 {
-    std::string result;
-    char lastCharacter;
-
-    do {
-        int ret = read(d->fd, &lastCharacter, 1);
-        if (ret < 0) {
-            d->lastError = std::string(std::strerror(errno));
-            throw IOError(getLastError());
-        }
-
-        if (lastCharacter != '\r' && lastCharacter != '\n')
-            result += lastCharacter;
-
-    } while (lastCharacter != '\n');
+    StringView line;
+
+    try {
+        if (!d->reader.readLine(line) && !d->reader.eof())
+            throw IOError(std::string(std::strerror(EAGAIN)));
+    } catch (const IOError &err) {
+        d->lastError = err.what();
+        throw;
+    }
 
-    return result;
+    return line.str();
 }
 
 std::string SerialFile::getLastError() const
@@ -291,6 +290,11 @@ bool SerialFile::reconfigure(int            baudrate,
 }
 
 std::string SerialFile::str() const
+{
+    return d->fileName.str();
+}
+
+InternedString SerialFile::getInternedName() const
 {
     return d->fileName;
 }
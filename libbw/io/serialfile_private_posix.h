@@ -28,9 +28,12 @@
 #ifndef SERIALFILE_PRIVATE_POSIX_H
 #define SERIALFILE_PRIVATE_POSIX_H
 
+#include <cstdio>
 #include <string>
 
 #include "exithandler.h"
+#include "stringutil.h"
+#include "bufferedlinereader.h"
 
 namespace bw {
 namespace io {
@@ -44,21 +47,24 @@ namespace io {
  * the same interface for different platforms and have the concrete (typed) members as private
  * data of the platform implementation.
  *
- * The lock file name and exit handlers are only used on Linux.
+ * The lock file name and exit handlers are only used on Linux. The line reader buffers all
+ * input, also for operator>>().
  */
 struct SerialFilePrivate
 {
     SerialFilePrivate(const std::string &portName)
-        : fileName(portName)
+        : fileName(intern(portName))
         , fd(-1)
         , exithandler(NULL)
+        , reader(-1, BUFSIZ)
     {}
 
-    std::string fileName;
+    InternedString fileName;
     std::string lastError;
     int         fd;
     std::string lockfile;
     ExitHandler *exithandler;
+    BufferedLineReader reader;
 };
 
 /* }}} */
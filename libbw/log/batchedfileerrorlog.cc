@@ -0,0 +1,327 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "batchedfileerrorlog.h"
+#include "sysutil.h"
+#include <thread/mutexlocker.h>
+
+namespace bw {
+
+/* ErrorlogThreadBuffer {{{ */
+
+/**
+ * \brief Record buffer of one thread
+ *
+ * The owning thread appends to \c data. The flusher swaps \c data and \c spare and writes
+ * \c spare without holding the lock. Only one flush can be active at a time, so \c spare
+ * is never touched by two threads.
+ */
+struct ErrorlogThreadBuffer {
+
+    enum { Capacity = 64 * 1024 };
+
+    ErrorlogThreadBuffer()
+        : data(new char[Capacity])
+        , spare(new char[Capacity])
+        , used(0)
+        , orphaned(false)
+    {}
+
+    ~ErrorlogThreadBuffer()
+    {
+        delete[] data;
+        delete[] spare;
+    }
+
+    thread::Mutex   mutex;
+    char            *data;
+    char            *spare;
+    size_t          used;
+    bool            orphaned;   // the owning thread has terminated
+};
+
+static void releaseThreadBuffer(void *value)
+{
+    ErrorlogThreadBuffer *buffer = static_cast<ErrorlogThreadBuffer *>(value);
+
+    // the flusher frees the buffer after the remaining records have been written
+    thread::MutexLocker locker(&buffer->mutex);
+    buffer->orphaned = true;
+}
+
+/* }}} */
+/* ErrorlogFlusher {{{ */
+
+/**
+ * \brief Background thread of BatchedFileErrorlog
+ */
+class ErrorlogFlusher : public thread::Thread {
+
+public:
+    ErrorlogFlusher(BatchedFileErrorlog *log)
+        : m_log(log)
+        , m_pending(false)
+        , m_stop(false)
+    {}
+
+public:
+    void wakeup()
+    {
+        thread::MutexLocker locker(&m_mutex);
+        m_pending = true;
+        m_cond.signal();
+    }
+
+    void stop()
+    {
+        {
+            thread::MutexLocker locker(&m_mutex);
+            m_stop = true;
+            m_cond.signal();
+        }
+        join();
+    }
+
+protected:
+    void run()
+    {
+        for (;;) {
+            bool stop;
+            {
+                thread::MutexLocker locker(&m_mutex);
+                if (!m_pending && !m_stop)
+                    m_cond.wait(&m_mutex, m_log->m_flushInterval.load(thread::MO_RELAXED));
+                m_pending = false;
+                stop = m_stop;
+            }
+
+            m_log->flush();
+            if (stop)
+                break;
+        }
+    }
+
+private:
+    BatchedFileErrorlog *m_log;
+    thread::Mutex       m_mutex;
+    thread::Condition   m_cond;
+    bool                m_pending;
+    bool                m_stop;
+};
+
+/* }}} */
+/* BatchedFileErrorlog {{{ */
+
+const size_t BatchedFileErrorlog::DefaultFlushThreshold;
+const unsigned long BatchedFileErrorlog::DefaultFlushInterval;
+
+BatchedFileErrorlog::BatchedFileErrorlog(const char *filename)
+    : m_fd(STDERR_FILENO)
+    , m_closeInDtor(false)
+    , m_flushThreshold(DefaultFlushThreshold)
+    , m_flushInterval(DefaultFlushInterval)
+    , m_threadBuffer(new thread::ThreadStorage(releaseThreadBuffer))
+    , m_flusher(NULL)
+{
+    if (!filename || std::strcmp(filename, "stderr") == 0)
+        m_fd = STDERR_FILENO;
+    else if (std::strcmp(filename, "stdout") == 0)
+        m_fd = STDOUT_FILENO;
+    else {
+        m_fd = ::open(filename, O_WRONLY | O_APPEND | O_CREAT, 0644);
+        if (m_fd < 0) {
+            std::cerr << "Warning: Unable to open '" << filename << "' for writing." << std::endl;
+            m_fd = STDERR_FILENO;
+        } else
+            m_closeInDtor = true;
+    }
+
+    m_flusher = new ErrorlogFlusher(this);
+    if (!m_flusher->start()) {
+        // without flusher, records are only written on size threshold and EMERG/ALERT
+        std::cerr << "Warning: Unable to start the error log flusher thread." << std::endl;
+        delete m_flusher;
+        m_flusher = NULL;
+    }
+}
+
+BatchedFileErrorlog::~BatchedFileErrorlog()
+{
+    if (m_flusher) {
+        m_flusher->stop();
+        delete m_flusher;
+    }
+
+    // a thread that terminates after this point no longer touches its buffer
+    delete m_threadBuffer;
+
+    flush();
+
+    for (std::list<ErrorlogThreadBuffer *>::iterator it = m_buffers.begin();
+            it != m_buffers.end(); ++it)
+        delete *it;
+
+    if (m_closeInDtor)
+        ::close(m_fd);
+}
+
+void BatchedFileErrorlog::setFlushThreshold(size_t bytes)
+{
+    m_flushThreshold.store(bytes, thread::MO_RELAXED);
+}
+
+void BatchedFileErrorlog::setFlushInterval(unsigned long msecs)
+{
+    m_flushInterval.store(msecs, thread::MO_RELAXED);
+}
+
+void BatchedFileErrorlog::flush()
+{
+    thread::MutexLocker flushLocker(&m_flushMutex);
+    std::vector<struct iovec> iov;
+    std::vector<ErrorlogThreadBuffer *> orphans;
+
+    {
+        thread::MutexLocker buffersLocker(&m_buffersMutex);
+
+        std::list<ErrorlogThreadBuffer *>::iterator it = m_buffers.begin();
+        while (it != m_buffers.end()) {
+            ErrorlogThreadBuffer *buffer = *it;
+            thread::MutexLocker locker(&buffer->mutex);
+
+            if (buffer->used > 0) {
+                std::swap(buffer->data, buffer->spare);
+
+                struct iovec vec;
+                vec.iov_base = buffer->spare;
+                vec.iov_len = buffer->used;
+                iov.push_back(vec);
+                buffer->used = 0;
+            }
+
+            if (buffer->orphaned) {
+                orphans.push_back(buffer);
+                it = m_buffers.erase(it);
+            } else
+                ++it;
+        }
+    }
+
+    if (!iov.empty())
+        writeAll(m_fd, &iov[0], iov.size());
+
+    for (size_t i = 0; i < orphans.size(); ++i)
+        delete orphans[i];
+}
+
+void BatchedFileErrorlog::vlog(Errorlog::Level level, const char *msg, std::va_list args)
+{
+    char timestamp[TimestampCache::MaxLength];
+    char stackRecord[1024];
+    char *record = stackRecord;
+    size_t required;
+
+    m_timestamps.format(timestamp, sizeof(timestamp));
+
+    std::va_list argsCopy;
+    BW_COMPILER_VA_COPY(argsCopy, args);
+    size_t length = formatRecord(stackRecord, sizeof(stackRecord), timestamp, level, msg, args,
+                                 &required);
+    if (required > sizeof(stackRecord)) {
+        record = new char[required];
+        length = formatRecord(record, required, timestamp, level, msg, argsCopy, &required);
+    }
+    va_end(argsCopy);
+
+    ErrorlogThreadBuffer *buffer = threadBuffer();
+    bool wakeup = false;
+
+    buffer->mutex.lock();
+    if (buffer->used + length > ErrorlogThreadBuffer::Capacity) {
+        buffer->mutex.unlock();
+        flush();
+        buffer->mutex.lock();
+    }
+
+    if (length > ErrorlogThreadBuffer::Capacity) {
+        // the buffer of this thread is empty now, so the order is preserved
+        buffer->mutex.unlock();
+        writeRecord(record, length);
+    } else {
+        std::memcpy(buffer->data + buffer->used, record, length);
+        size_t threshold = m_flushThreshold.load(thread::MO_RELAXED);
+        wakeup = buffer->used < threshold && buffer->used + length >= threshold;
+        buffer->used += length;
+        buffer->mutex.unlock();
+    }
+
+    if (record != stackRecord)
+        delete[] record;
+
+    if (level <= LS_ALERT)
+        flush();
+    else if (wakeup && m_flusher)
+        m_flusher->wakeup();
+}
+
+ErrorlogThreadBuffer *BatchedFileErrorlog::threadBuffer()
+{
+    ErrorlogThreadBuffer *buffer = static_cast<ErrorlogThreadBuffer *>(m_threadBuffer->get());
+    if (buffer)
+        return buffer;
+
+    buffer = new ErrorlogThreadBuffer;
+    m_threadBuffer->set(buffer);
+
+    thread::MutexLocker locker(&m_buffersMutex);
+    m_buffers.push_back(buffer);
+
+    return buffer;
+}
+
+void BatchedFileErrorlog::writeRecord(const char *record, size_t length)
+{
+    thread::MutexLocker locker(&m_flushMutex);
+
+    struct iovec vec;
+    vec.iov_base = const_cast<char *>(record);
+    vec.iov_len = length;
+    writeAll(m_fd, &vec, 1);
+}
+
+/* }}} */
+
+} // end namespace bw
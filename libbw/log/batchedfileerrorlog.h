@@ -0,0 +1,163 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_BATCHEDFILEERRORLOG_H_
+#define LIBBW_LOG_BATCHEDFILEERRORLOG_H_
+
+#include <cstddef>
+#include <list>
+
+#include "errorlog.h"
+#include "timestampcache.h"
+#include <thread/atomic.h>
+#include <thread/condition.h>
+#include <thread/mutex.h>
+#include <thread/thread.h>
+#include <thread/threadstorage.h>
+
+namespace bw {
+
+struct ErrorlogThreadBuffer;
+class ErrorlogFlusher;
+
+/* BatchedFileErrorlog {{{ */
+
+/**
+ * \brief Error log implementation that writes to a file in batches
+ *
+ * Each thread formats its records into a private buffer, so logging threads don't
+ * serialize on a common lock or on the I/O. A background thread collects the buffers of
+ * all threads and writes them with a single writev() call when the buffered data exceeds
+ * the flush threshold or when the flush interval expires.
+ *
+ * Records with the levels Errorlog::LS_EMERG and Errorlog::LS_ALERT are never delayed: they
+ * are written (together with everything that has been buffered before) before the logging
+ * function returns.
+ *
+ * Since every thread has its own buffer, records of different threads may appear in the
+ * file in a slightly different order than they have been logged. The records of one
+ * thread are always in order.
+ *
+ * Only available on platforms with thread support. Use Errorlog::configure() with
+ * Errorlog::LM_BATCHED_FILE to create an instance.
+ *
+ * \ingroup log
+ */
+class BatchedFileErrorlog : public Errorlog {
+
+public:
+    /// Let Errorlog create instances of BatchedFileErrorlog, and only Errorlog.
+    friend class Errorlog;
+
+    /// The flusher thread needs to call flush().
+    friend class ErrorlogFlusher;
+
+    /**
+     * \brief Default value for setFlushThreshold()
+     */
+    static const size_t DefaultFlushThreshold = 16 * 1024;
+
+    /**
+     * \brief Default value for setFlushInterval()
+     */
+    static const unsigned long DefaultFlushInterval = 200;
+
+public:
+    /**
+     * \brief Sets the size threshold
+     *
+     * If the buffer of a thread contains more than \p bytes, the flusher thread is woken
+     * up immediately.
+     *
+     * May be called while other threads are logging.
+     *
+     * \param[in] bytes the threshold in bytes
+     */
+    void setFlushThreshold(size_t bytes);
+
+    /**
+     * \brief Sets the time threshold
+     *
+     * Buffered records are written at least every \p msecs milliseconds.
+     *
+     * May be called while other threads are logging.
+     *
+     * \param[in] msecs the interval in milliseconds
+     */
+    void setFlushInterval(unsigned long msecs);
+
+    /**
+     * \brief Writes all buffered records of all threads
+     */
+    void flush();
+
+protected:
+    /**
+     * \brief Creates a new BatchedFileErrorlog.
+     *
+     * Don't use that function directly. Instead, use Errorlog::configure().
+     *
+     * \param[in] filename the name of the file to which the logger should log. The
+     *            special values \c "stderr" and \c "stdout" are supported.
+     */
+    BatchedFileErrorlog(const char *filename="stderr");
+
+    /**
+     * \brief Destructor
+     *
+     * Writes all pending records.
+     */
+    ~BatchedFileErrorlog();
+
+    /**
+     * \copydoc Errorlog::vlog()
+     */
+    void vlog(Errorlog::Level level, const char *msg, std::va_list args);
+
+private:
+    ErrorlogThreadBuffer *threadBuffer();
+    void writeRecord(const char *record, size_t length);
+
+private:
+    int m_fd;
+    bool m_closeInDtor;
+    thread::Atomic<size_t> m_flushThreshold;
+    thread::Atomic<unsigned long> m_flushInterval;
+    TimestampCache m_timestamps;
+    thread::ThreadStorage *m_threadBuffer;
+    std::list<ErrorlogThreadBuffer *> m_buffers;
+    thread::Mutex m_buffersMutex;
+    thread::Mutex m_flushMutex;
+    ErrorlogFlusher *m_flusher;
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_BATCHEDFILEERRORLOG_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
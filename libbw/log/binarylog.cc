@@ -0,0 +1,927 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdint.h>
+
+#include "bwconfig.h"
+#include "compiler.h"
+#include "binarylog.h"
+#include "sysutil.h"
+#ifdef HAVE_THREADS
+#  include <thread/atomic.h>
+#  include <thread/mutex.h>
+#  include <thread/mutexlocker.h>
+#endif
+
+namespace bw {
+
+/*
+ * File layout (all integers little endian):
+ *
+ *   header:            "BWBLOG01"
+ *   format record:     'F' u32:id u16:length format
+ *   message record:    'M' u32:id u8:source i32:level i64:time u16:length arguments
+ *   text record:       'T' u8:source i32:level i64:time u16:length text
+ *
+ * The time is in microseconds since the epoch. Each argument of a message record is
+ * preceded by the values of its '*' width and precision, integers and pointers are stored
+ * as 64 bit values, floating point numbers as 64 bit IEEE doubles and strings as u16:length
+ * followed by the characters.
+ */
+
+static const char BinaryLogMagic[] = "BWBLOG01";
+static const size_t BinaryLogMagicLength = 8;
+
+/* BinaryLogFormat {{{ */
+
+/**
+ * \brief Type of a printf() argument
+ */
+enum ArgumentType {
+    AT_NONE,            // "%%" or "%n", nothing is stored
+    AT_INT,
+    AT_LONG,
+    AT_LONGLONG,
+    AT_INTMAX,
+    AT_SIZE,
+    AT_PTRDIFF,
+    AT_DOUBLE,
+    AT_LONGDOUBLE,
+    AT_STRING,
+    AT_WIDESTRING,
+    AT_POINTER
+};
+
+/**
+ * \brief One conversion specification of a format string
+ */
+struct BinaryLogConversion {
+    size_t          begin;          // offset of the '%'
+    size_t          modifier;       // offset of the length modifier
+    size_t          end;            // offset after the conversion character
+    ArgumentType    type;
+    char            conversion;     // the conversion character
+    char            truncation;     // 'c' for "hh", 's' for "h", 0 otherwise
+    bool            isUnsigned;
+    int             stars;          // number of '*' arguments
+};
+
+/**
+ * \brief Parsed format string
+ */
+struct BinaryLogFormat {
+    unsigned int                        id;
+    std::string                         format;
+    std::vector<BinaryLogConversion>    conversions;
+};
+
+/**
+ * \brief Splits the format string of \p format into conversion specifications
+ *
+ * \param[in,out] format the format whose \c format member must be set
+ */
+static void parseFormat(BinaryLogFormat *format)
+{
+    const std::string &str = format->format;
+    size_t pos = 0;
+
+    while ((pos = str.find('%', pos)) != std::string::npos) {
+        BinaryLogConversion conv;
+        conv.begin = pos++;
+        conv.type = AT_NONE;
+        conv.truncation = 0;
+        conv.isUnsigned = false;
+        conv.stars = 0;
+
+        // flags, width and precision
+        while (pos < str.size() && std::strchr("-+ #0'123456789.*", str[pos])) {
+            if (str[pos] == '*')
+                conv.stars++;
+            pos++;
+        }
+
+        // length modifier
+        conv.modifier = pos;
+        while (pos < str.size() && std::strchr("hlLqjzt", str[pos]))
+            pos++;
+        std::string modifier = str.substr(conv.modifier, pos - conv.modifier);
+
+        if (pos >= str.size())
+            break;
+        conv.conversion = str[pos++];
+        conv.end = pos;
+
+        switch (conv.conversion) {
+            case 'u': case 'o': case 'x': case 'X':
+                conv.isUnsigned = true;
+                // fall through
+            case 'd': case 'i':
+                if (modifier == "l")
+                    conv.type = AT_LONG;
+                else if (modifier == "ll" || modifier == "q")
+                    conv.type = AT_LONGLONG;
+                else if (modifier == "j")
+                    conv.type = AT_INTMAX;
+                else if (modifier == "z")
+                    conv.type = AT_SIZE;
+                else if (modifier == "t")
+                    conv.type = AT_PTRDIFF;
+                else {
+                    conv.type = AT_INT;
+                    if (modifier == "hh")
+                        conv.truncation = 'c';
+                    else if (modifier == "h")
+                        conv.truncation = 's';
+                }
+                break;
+
+            case 'c':
+                conv.type = AT_INT;
+                break;
+
+            case 'f': case 'F': case 'e': case 'E':
+            case 'g': case 'G': case 'a': case 'A':
+                conv.type = modifier == "L" ? AT_LONGDOUBLE : AT_DOUBLE;
+                break;
+
+            case 's':
+                conv.type = modifier == "l" ? AT_WIDESTRING : AT_STRING;
+                break;
+
+            case 'p':
+                conv.type = AT_POINTER;
+                break;
+
+            case 'n':
+                // the argument is consumed, but nothing is written back
+                conv.type = AT_POINTER;
+                break;
+
+            default:
+                // "%%" and unknown conversions
+                conv.type = AT_NONE;
+                conv.stars = 0;
+                break;
+        }
+
+        format->conversions.push_back(conv);
+    }
+}
+
+/**
+ * \brief Lookup table of BinaryLogWriter, keyed by the address of the format string
+ *
+ * Readers don't need a lock. New entries are added with the mutex held, and the key is
+ * published after the value.
+ */
+struct BinaryLogFormatTable {
+
+    enum { Slots = 4096 };
+
+#ifdef HAVE_THREADS
+    thread::Atomic<const char *>        keys[Slots];
+    thread::Atomic<BinaryLogFormat *>   formats[Slots];
+    thread::Mutex                       mutex;
+#else
+    const char                          *keys[Slots];
+    BinaryLogFormat                     *formats[Slots];
+#endif
+};
+
+/* }}} */
+/* Encoding helpers {{{ */
+
+/**
+ * \brief Serializes integers in little endian byte order into a fixed-size buffer
+ *
+ * If a value doesn't fit, the record is truncated: the value and everything after it is
+ * dropped, so that pos() only covers bytes that have been written.
+ */
+class RecordEncoder {
+
+public:
+    RecordEncoder(char *buffer, size_t size)
+        : m_buffer(buffer)
+        , m_size(size)
+        , m_pos(0)
+        , m_truncated(false)
+    {}
+
+public:
+    void putInteger(unsigned long long value, int bytes)
+    {
+        if (m_truncated || m_pos + bytes > m_size) {
+            m_truncated = true;
+            return;
+        }
+        for (int i = 0; i < bytes; ++i) {
+            m_buffer[m_pos++] = static_cast<char>(value & 0xff);
+            value >>= 8;
+        }
+    }
+
+    void putDouble(double value)
+    {
+        unsigned long long bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        putInteger(bits, 8);
+    }
+
+    void putString(const char *str, size_t length)
+    {
+        if (m_truncated || m_pos + 2 > m_size) {
+            m_truncated = true;
+            return;
+        }
+        length = std::min(length, m_size - m_pos - 2);
+        length = std::min(length, size_t(0xffff));
+        putInteger(length, 2);
+        std::memcpy(m_buffer + m_pos, str, length);
+        m_pos += length;
+    }
+
+    size_t pos() const
+    {
+        return m_pos;
+    }
+
+    // continues writing at pos, for example to fill in a length field
+    void setPos(size_t pos)
+    {
+        m_pos = pos;
+        m_truncated = false;
+    }
+
+private:
+    char    *m_buffer;
+    size_t  m_size;
+    size_t  m_pos;
+    bool    m_truncated;
+};
+
+/**
+ * \brief Counterpart of RecordEncoder
+ */
+class RecordDecoder {
+
+public:
+    RecordDecoder(const char *buffer, size_t size)
+        : m_buffer(buffer)
+        , m_size(size)
+        , m_pos(0)
+    {}
+
+public:
+    bool getInteger(unsigned long long *value, int bytes)
+    {
+        if (m_pos + bytes > m_size)
+            return false;
+        *value = 0;
+        for (int i = bytes - 1; i >= 0; --i)
+            *value = (*value << 8) | static_cast<unsigned char>(m_buffer[m_pos + i]);
+        m_pos += bytes;
+        return true;
+    }
+
+    bool getDouble(double *value)
+    {
+        unsigned long long bits;
+        if (!getInteger(&bits, 8))
+            return false;
+        std::memcpy(value, &bits, sizeof(bits));
+        return true;
+    }
+
+    bool getString(std::string *str)
+    {
+        unsigned long long length;
+        if (!getInteger(&length, 2) || m_pos + length > m_size)
+            return false;
+        str->assign(m_buffer + m_pos, length);
+        m_pos += length;
+        return true;
+    }
+
+private:
+    const char  *m_buffer;
+    size_t      m_size;
+    size_t      m_pos;
+};
+
+/**
+ * \brief Reads one argument of type \p conv from \p args and stores it in \p encoder
+ */
+static void encodeArgument(RecordEncoder &encoder, const BinaryLogConversion &conv,
+                           std::va_list &args)
+{
+    for (int i = 0; i < conv.stars; ++i)
+        encoder.putInteger(static_cast<long long>(va_arg(args, int)), 8);
+
+    switch (conv.type) {
+        case AT_NONE:
+            break;
+
+        case AT_INT:
+            if (conv.isUnsigned) {
+                unsigned int value = va_arg(args, unsigned int);
+                if (conv.truncation == 'c')
+                    value = static_cast<unsigned char>(value);
+                else if (conv.truncation == 's')
+                    value = static_cast<unsigned short>(value);
+                encoder.putInteger(value, 8);
+            } else {
+                int value = va_arg(args, int);
+                if (conv.truncation == 'c')
+                    value = static_cast<signed char>(value);
+                else if (conv.truncation == 's')
+                    value = static_cast<short>(value);
+                encoder.putInteger(static_cast<long long>(value), 8);
+            }
+            break;
+
+        case AT_LONG:
+            if (conv.isUnsigned)
+                encoder.putInteger(va_arg(args, unsigned long), 8);
+            else
+                encoder.putInteger(static_cast<long long>(va_arg(args, long)), 8);
+            break;
+
+        case AT_LONGLONG:
+            encoder.putInteger(va_arg(args, unsigned long long), 8);
+            break;
+
+        case AT_INTMAX:
+            encoder.putInteger(static_cast<long long>(va_arg(args, intmax_t)), 8);
+            break;
+
+        case AT_SIZE:
+            encoder.putInteger(va_arg(args, size_t), 8);
+            break;
+
+        case AT_PTRDIFF:
+            encoder.putInteger(static_cast<long long>(va_arg(args, ptrdiff_t)), 8);
+            break;
+
+        case AT_DOUBLE:
+            encoder.putDouble(va_arg(args, double));
+            break;
+
+        case AT_LONGDOUBLE:
+            // precision beyond double is lost
+            encoder.putDouble(static_cast<double>(va_arg(args, long double)));
+            break;
+
+        case AT_STRING: {
+            const char *str = va_arg(args, const char *);
+            if (!str)
+                str = "(null)";
+            encoder.putString(str, std::strlen(str));
+            break;
+        }
+
+        case AT_WIDESTRING:
+            // wide strings are not supported by the binary format
+            (void)va_arg(args, const wchar_t *);
+            encoder.putString("", 0);
+            break;
+
+        case AT_POINTER:
+            encoder.putInteger(reinterpret_cast<size_t>(va_arg(args, void *)), 8);
+            break;
+    }
+}
+
+/**
+ * \brief snprintf() into a std::string with up to two '*' arguments
+ */
+template <typename T>
+static std::string formatValue(const std::string &spec, const int *stars, int nstars, T value)
+{
+    char buffer[256];
+    std::vector<char> heap;
+    char *out = buffer;
+    size_t size = sizeof(buffer);
+
+    for (;;) {
+        int ret;
+        if (nstars == 0)
+            ret = std::snprintf(out, size, spec.c_str(), value);
+        else if (nstars == 1)
+            ret = std::snprintf(out, size, spec.c_str(), stars[0], value);
+        else
+            ret = std::snprintf(out, size, spec.c_str(), stars[0], stars[1], value);
+
+        if (ret < 0)
+            return std::string();
+        if (size_t(ret) < size)
+            return std::string(out, ret);
+
+        heap.resize(ret + 1);
+        out = &heap[0];
+        size = heap.size();
+    }
+}
+
+/**
+ * \brief Decodes one argument of type \p conv and appends the formatted text
+ *
+ * \return \c false if the record is truncated
+ */
+static bool decodeArgument(RecordDecoder &decoder, const std::string &format,
+                           const BinaryLogConversion &conv, std::string &text)
+{
+    int stars[2] = { 0, 0 };
+    for (int i = 0; i < conv.stars; ++i) {
+        unsigned long long value;
+        if (!decoder.getInteger(&value, 8))
+            return false;
+        if (i < 2)
+            stars[i] = static_cast<int>(static_cast<long long>(value));
+    }
+    int nstars = std::min(conv.stars, 2);
+
+    // the original specification without the length modifier
+    std::string spec = format.substr(conv.begin, conv.modifier - conv.begin);
+
+    switch (conv.type) {
+        case AT_NONE:
+            if (conv.conversion == '%')
+                text += '%';
+            else
+                text += format.substr(conv.begin, conv.end - conv.begin);
+            return true;
+
+        case AT_INT:
+        case AT_LONG:
+        case AT_LONGLONG:
+        case AT_INTMAX:
+        case AT_SIZE:
+        case AT_PTRDIFF: {
+            unsigned long long value;
+            if (!decoder.getInteger(&value, 8))
+                return false;
+            if (conv.conversion == 'c') {
+                text += formatValue(spec + 'c', stars, nstars, static_cast<int>(value));
+                return true;
+            }
+            spec += "ll";
+            spec += conv.conversion;
+            if (conv.isUnsigned)
+                text += formatValue(spec, stars, nstars, value);
+            else
+                text += formatValue(spec, stars, nstars, static_cast<long long>(value));
+            return true;
+        }
+
+        case AT_DOUBLE:
+        case AT_LONGDOUBLE: {
+            double value;
+            if (!decoder.getDouble(&value))
+                return false;
+            text += formatValue(spec + conv.conversion, stars, nstars, value);
+            return true;
+        }
+
+        case AT_STRING:
+        case AT_WIDESTRING: {
+            std::string value;
+            if (!decoder.getString(&value))
+                return false;
+            text += formatValue(spec + 's', stars, nstars, value.c_str());
+            return true;
+        }
+
+        case AT_POINTER: {
+            unsigned long long value;
+            if (!decoder.getInteger(&value, 8))
+                return false;
+            if (conv.conversion == 'p')
+                text += formatValue(spec + 'p', stars, nstars,
+                                    reinterpret_cast<void *>(static_cast<size_t>(value)));
+            return true;
+        }
+    }
+
+    return true;
+}
+
+/* }}} */
+/* BinaryLogWriter {{{ */
+
+BinaryLogWriter::BinaryLogWriter()
+    : m_file(NULL)
+    , m_buffer(64 * 1024)
+    , m_used(0)
+    , m_nextId(0)
+    , m_table(new BinaryLogFormatTable)
+{
+#ifndef HAVE_THREADS
+    for (int i = 0; i < BinaryLogFormatTable::Slots; ++i) {
+        m_table->keys[i] = NULL;
+        m_table->formats[i] = NULL;
+    }
+#endif
+}
+
+BinaryLogWriter::~BinaryLogWriter()
+{
+    close();
+    delete m_table;
+}
+
+bool BinaryLogWriter::open(const char *filename)
+{
+    close();
+
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&m_table->mutex);
+#endif
+
+    m_file = std::fopen(filename, "ab+");
+    if (!m_file)
+        return false;
+
+    // we do the buffering ourselves
+    std::setvbuf(m_file, NULL, _IONBF, 0);
+
+    std::fseek(m_file, 0, SEEK_END);
+    if (std::ftell(m_file) == 0)
+        std::fwrite(BinaryLogMagic, 1, BinaryLogMagicLength, m_file);
+    else {
+        char magic[BinaryLogMagicLength];
+        std::fseek(m_file, 0, SEEK_SET);
+        if (std::fread(magic, 1, sizeof(magic), m_file) != sizeof(magic) ||
+                std::memcmp(magic, BinaryLogMagic, sizeof(magic)) != 0) {
+            std::fclose(m_file);
+            m_file = NULL;
+            return false;
+        }
+        std::fseek(m_file, 0, SEEK_END);
+    }
+
+    return true;
+}
+
+void BinaryLogWriter::close()
+{
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&m_table->mutex);
+#endif
+
+    if (!m_file)
+        return;
+
+    flushBuffer();
+    std::fclose(m_file);
+    m_file = NULL;
+
+    // a new file needs new format records
+    for (int i = 0; i < BinaryLogFormatTable::Slots; ++i) {
+#ifdef HAVE_THREADS
+        m_table->keys[i].store(NULL, thread::MO_RELAXED);
+        delete m_table->formats[i].exchange(NULL, thread::MO_RELAXED);
+#else
+        m_table->keys[i] = NULL;
+        delete m_table->formats[i];
+        m_table->formats[i] = NULL;
+#endif
+    }
+    m_nextId = 0;
+}
+
+bool BinaryLogWriter::isOpen() const
+{
+    return m_file != NULL;
+}
+
+void BinaryLogWriter::write(Source source, int level, const char *format, std::va_list args)
+{
+    if (!m_file)
+        return;
+
+    BinaryLogFormat *fmt = lookupFormat(format);
+    if (!fmt)
+        fmt = registerFormat(format);
+    if (!fmt) {
+        // the lookup table is full
+        char text[1024];
+        std::vsnprintf(text, sizeof(text), format, args);
+        writeText(source, level, text);
+        return;
+    }
+
+    char record[4096];
+    RecordEncoder encoder(record, sizeof(record));
+    encoder.putInteger('M', 1);
+    encoder.putInteger(fmt->id, 4);
+    encoder.putInteger(source, 1);
+    encoder.putInteger(static_cast<unsigned int>(level), 4);
+    encoder.putInteger(static_cast<unsigned long long>(realtimeMicroseconds()), 8);
+
+    size_t lengthPos = encoder.pos();
+    encoder.putInteger(0, 2);
+
+    std::va_list argsCopy;
+    BW_COMPILER_VA_COPY(argsCopy, args);
+    for (size_t i = 0; i < fmt->conversions.size(); ++i)
+        encodeArgument(encoder, fmt->conversions[i], argsCopy);
+    va_end(argsCopy);
+
+    size_t length = encoder.pos();
+    encoder.setPos(lengthPos);
+    encoder.putInteger(length - lengthPos - 2, 2);
+
+    append(record, length);
+}
+
+void BinaryLogWriter::writeText(Source source, int level, const std::string &text)
+{
+    if (!m_file)
+        return;
+
+    char record[4096];
+    RecordEncoder encoder(record, sizeof(record));
+    encoder.putInteger('T', 1);
+    encoder.putInteger(source, 1);
+    encoder.putInteger(static_cast<unsigned int>(level), 4);
+    encoder.putInteger(static_cast<unsigned long long>(realtimeMicroseconds()), 8);
+    encoder.putString(text.c_str(), text.size());
+
+    append(record, encoder.pos());
+}
+
+void BinaryLogWriter::flush()
+{
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&m_table->mutex);
+#endif
+    flushBuffer();
+}
+
+BinaryLogFormat *BinaryLogWriter::lookupFormat(const char *format)
+{
+    size_t slot = (reinterpret_cast<size_t>(format) >> 3) * 2654435761U;
+
+    for (int i = 0; i < BinaryLogFormatTable::Slots; ++i) {
+        slot &= BinaryLogFormatTable::Slots - 1;
+#ifdef HAVE_THREADS
+        const char *key = m_table->keys[slot].load(thread::MO_ACQUIRE);
+        BinaryLogFormat *fmt = key == format
+            ? m_table->formats[slot].load(thread::MO_RELAXED) : NULL;
+#else
+        const char *key = m_table->keys[slot];
+        BinaryLogFormat *fmt = key == format ? m_table->formats[slot] : NULL;
+#endif
+        // the buffer at that address may contain a different format string by now
+        if (fmt && std::strcmp(fmt->format.c_str(), format) == 0)
+            return fmt;
+        if (!key)
+            return NULL;
+        ++slot;
+    }
+
+    return NULL;
+}
+
+BinaryLogFormat *BinaryLogWriter::registerFormat(const char *format)
+{
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&m_table->mutex);
+#endif
+
+    // another thread might have been faster
+    BinaryLogFormat *fmt = lookupFormat(format);
+    if (fmt)
+        return fmt;
+
+    size_t slot = (reinterpret_cast<size_t>(format) >> 3) * 2654435761U;
+    int i;
+    for (i = 0; i < BinaryLogFormatTable::Slots; ++i) {
+        slot &= BinaryLogFormatTable::Slots - 1;
+#ifdef HAVE_THREADS
+        if (!m_table->keys[slot].load(thread::MO_RELAXED))
+            break;
+#else
+        if (!m_table->keys[slot])
+            break;
+#endif
+        ++slot;
+    }
+    if (i == BinaryLogFormatTable::Slots)
+        return NULL;
+
+    fmt = new BinaryLogFormat;
+    fmt->id = m_nextId++;
+    fmt->format = format;
+    parseFormat(fmt);
+
+    // the format record must be in the file before the first message that uses it
+    std::vector<char> record(fmt->format.size() + 8);
+    RecordEncoder encoder(&record[0], record.size());
+    encoder.putInteger('F', 1);
+    encoder.putInteger(fmt->id, 4);
+    encoder.putString(fmt->format.c_str(), fmt->format.size());
+    if (m_used + encoder.pos() > m_buffer.size())
+        flushBuffer();
+    if (encoder.pos() > m_buffer.size())
+        std::fwrite(&record[0], 1, encoder.pos(), m_file);
+    else {
+        std::memcpy(&m_buffer[m_used], &record[0], encoder.pos());
+        m_used += encoder.pos();
+    }
+
+#ifdef HAVE_THREADS
+    m_table->formats[slot].store(fmt, thread::MO_RELAXED);
+    m_table->keys[slot].store(format, thread::MO_RELEASE);
+#else
+    m_table->formats[slot] = fmt;
+    m_table->keys[slot] = format;
+#endif
+
+    return fmt;
+}
+
+void BinaryLogWriter::append(const char *data, size_t length)
+{
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&m_table->mutex);
+#endif
+
+    if (!m_file)
+        return;
+
+    if (m_used + length > m_buffer.size())
+        flushBuffer();
+    std::memcpy(&m_buffer[m_used], data, length);
+    m_used += length;
+}
+
+void BinaryLogWriter::flushBuffer()
+{
+    if (m_file && m_used > 0)
+        std::fwrite(&m_buffer[0], 1, m_used, m_file);
+    m_used = 0;
+}
+
+/* }}} */
+/* BinaryLogReader {{{ */
+
+BinaryLogReader::BinaryLogReader()
+    : m_file(NULL)
+{}
+
+BinaryLogReader::~BinaryLogReader()
+{
+    if (m_file)
+        std::fclose(m_file);
+    for (size_t i = 0; i < m_formats.size(); ++i)
+        delete m_formats[i];
+}
+
+bool BinaryLogReader::open(const char *filename)
+{
+    m_file = std::fopen(filename, "rb");
+    if (!m_file) {
+        m_error = std::string("Unable to open '") + filename + "': " + std::strerror(errno);
+        return false;
+    }
+
+    char magic[BinaryLogMagicLength];
+    if (std::fread(magic, 1, sizeof(magic), m_file) != sizeof(magic) ||
+            std::memcmp(magic, BinaryLogMagic, sizeof(magic)) != 0) {
+        m_error = std::string("'") + filename + "' is no binary log file";
+        return false;
+    }
+
+    return true;
+}
+
+bool BinaryLogReader::read(Record &record)
+{
+    if (!m_file)
+        return false;
+
+    for (;;) {
+        int tag = std::fgetc(m_file);
+        if (tag == EOF) {
+            m_error.clear();
+            return false;
+        }
+
+        // everything up to the variable-length part
+        size_t headerLength;
+        switch (tag) {
+            case 'F':   headerLength = 4 + 2;           break;
+            case 'M':   headerLength = 4 + 1 + 4 + 8 + 2; break;
+            case 'T':   headerLength = 1 + 4 + 8 + 2;   break;
+            default:
+                m_error = "Corrupt record";
+                return false;
+        }
+
+        char header[32];
+        if (std::fread(header, 1, headerLength, m_file) != headerLength) {
+            m_error = "Truncated record";
+            return false;
+        }
+        RecordDecoder headerDecoder(header, headerLength);
+
+        unsigned long long id = 0, source = 0, level = 0, time = 0, length = 0;
+        if (tag == 'F' || tag == 'M')
+            headerDecoder.getInteger(&id, 4);
+        if (tag == 'M' || tag == 'T') {
+            headerDecoder.getInteger(&source, 1);
+            headerDecoder.getInteger(&level, 4);
+            headerDecoder.getInteger(&time, 8);
+        }
+        headerDecoder.getInteger(&length, 2);
+
+        std::vector<char> payload(length + 1);
+        if (std::fread(&payload[0], 1, length, m_file) != length) {
+            m_error = "Truncated record";
+            return false;
+        }
+
+        if (tag == 'F') {
+            BinaryLogFormat *fmt = new BinaryLogFormat;
+            fmt->id = id;
+            fmt->format.assign(&payload[0], length);
+            parseFormat(fmt);
+
+            if (id >= m_formats.size())
+                m_formats.resize(id + 1, NULL);
+            delete m_formats[id];
+            m_formats[id] = fmt;
+            continue;
+        }
+
+        record.source = static_cast<BinaryLogWriter::Source>(source);
+        record.level = static_cast<int>(static_cast<unsigned int>(level));
+        record.time = static_cast<long long>(time);
+
+        if (tag == 'T') {
+            record.text.assign(&payload[0], length);
+            return true;
+        }
+
+        if (id >= m_formats.size() || !m_formats[id]) {
+            m_error = "Record refers to an unknown format string";
+            return false;
+        }
+
+        const BinaryLogFormat *fmt = m_formats[id];
+        RecordDecoder decoder(&payload[0], length);
+        size_t pos = 0;
+
+        record.text.clear();
+        for (size_t i = 0; i < fmt->conversions.size(); ++i) {
+            const BinaryLogConversion &conv = fmt->conversions[i];
+            record.text += fmt->format.substr(pos, conv.begin - pos);
+            if (!decodeArgument(decoder, fmt->format, conv, record.text)) {
+                // the writer ran out of record space, the next record is still fine
+                record.text += "[truncated]";
+                return true;
+            }
+            pos = conv.end;
+        }
+        if (pos < fmt->format.size())
+            record.text += fmt->format.substr(pos);
+
+        return true;
+    }
+}
+
+std::string BinaryLogReader::error() const
+{
+    return m_error;
+}
+
+/* }}} */
+
+} // end namespace bw
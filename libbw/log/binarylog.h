@@ -0,0 +1,222 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_BINARYLOG_H_
+#define LIBBW_LOG_BINARYLOG_H_
+
+#include <cstdarg>
+#include <cstddef>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <libbw/noncopyable.h>
+
+namespace bw {
+
+struct BinaryLogFormat;
+struct BinaryLogFormatTable;
+
+/* BinaryLogWriter {{{ */
+
+/**
+ * \class BinaryLogWriter binarylog.h libbw/log/binarylog.h
+ * \brief Writes log records in a compact binary format
+ *
+ * Instead of formatting the message with printf(), only an ID of the format string and the
+ * raw values of the arguments are written. The format string itself is written once per
+ * file, the first time it is used. BinaryLogReader (and the \c binlogdecode example) turns
+ * the file back into text.
+ *
+ * The format string is looked up by its address and compared with the known text, so
+ * looking it up is cheap for string literals, which is what the BW_DEBUG_* and BW_ERROR_*
+ * macros use. A format string that is built at runtime works as well, but each different
+ * text needs its own entry in the lookup table of 4096 formats. Once the table is full,
+ * new format strings are formatted with vsnprintf() and written like writeText().
+ *
+ * Records are collected in a buffer that is written to the file when it is full or when
+ * flush() is called. All functions are thread-safe.
+ *
+ * \ingroup log
+ */
+class BinaryLogWriter : private Noncopyable {
+
+public:
+    /**
+     * \brief Subsystem that has written the record
+     */
+    enum Source {
+        BS_DEBUG    = 'D',  /**< bw::Debug, the level is a Debug::Level */
+        BS_ERRORLOG = 'E'   /**< bw::Errorlog, the level is an Errorlog::Level */
+    };
+
+public:
+    /**
+     * \brief Creates a new writer that is not connected to a file
+     */
+    BinaryLogWriter();
+
+    /**
+     * \brief Destructor
+     *
+     * Calls close().
+     */
+    ~BinaryLogWriter();
+
+public:
+    /**
+     * \brief Opens \p filename for appending
+     *
+     * The file header is written if the file is empty.
+     *
+     * \param[in] filename the name of the log file
+     * \return \c true on success, \c false if the file cannot be opened or if it is no
+     *         binary log file
+     */
+    bool open(const char *filename);
+
+    /**
+     * \brief Writes the pending records and closes the file
+     */
+    void close();
+
+    /**
+     * \brief Checks if a file is open
+     *
+     * \return \c true if open() succeeded and close() has not been called yet
+     */
+    bool isOpen() const;
+
+    /**
+     * \brief Writes a record
+     *
+     * \param[in] source the subsystem
+     * \param[in] level the level of the record
+     * \param[in] format the printf()-like format string, see the class description
+     * \param[in] args the arguments for \p format
+     */
+    void write(Source source, int level, const char *format, std::va_list args);
+
+    /**
+     * \brief Writes a record that consists of preformatted text
+     *
+     * \param[in] source the subsystem
+     * \param[in] level the level of the record
+     * \param[in] text the message
+     */
+    void writeText(Source source, int level, const std::string &text);
+
+    /**
+     * \brief Writes all buffered records to the file
+     */
+    void flush();
+
+private:
+    BinaryLogFormat *lookupFormat(const char *format);
+    BinaryLogFormat *registerFormat(const char *format);
+    void append(const char *data, size_t length);
+    void flushBuffer();
+
+private:
+    std::FILE               *m_file;
+    std::vector<char>       m_buffer;
+    size_t                  m_used;
+    unsigned int            m_nextId;
+    BinaryLogFormatTable    *m_table;
+};
+
+/* }}} */
+/* BinaryLogReader {{{ */
+
+/**
+ * \class BinaryLogReader binarylog.h libbw/log/binarylog.h
+ * \brief Reads files written by BinaryLogWriter
+ *
+ * \ingroup log
+ */
+class BinaryLogReader : private Noncopyable {
+
+public:
+    /**
+     * \brief One decoded record
+     */
+    struct Record {
+        BinaryLogWriter::Source source;     /**< subsystem that has written the record */
+        int                     level;      /**< Debug::Level or Errorlog::Level */
+        long long               time;       /**< microseconds since the epoch */
+        std::string             text;       /**< the formatted message */
+    };
+
+public:
+    /**
+     * \brief Creates a new reader
+     */
+    BinaryLogReader();
+
+    /**
+     * \brief Destructor
+     */
+    ~BinaryLogReader();
+
+public:
+    /**
+     * \brief Opens \p filename
+     *
+     * \param[in] filename the name of the log file
+     * \return \c true on success, \c false if the file cannot be opened or if it is no
+     *         binary log file
+     */
+    bool open(const char *filename);
+
+    /**
+     * \brief Reads the next record
+     *
+     * \param[out] record the decoded record
+     * \return \c true on success, \c false at the end of the file or if the file is
+     *         corrupt (see error())
+     */
+    bool read(Record &record);
+
+    /**
+     * \brief Returns the reason why read() or open() failed
+     *
+     * \return the error message or an empty string at the end of the file
+     */
+    std::string error() const;
+
+private:
+    std::FILE                           *m_file;
+    std::vector<BinaryLogFormat *>      m_formats;
+    std::string                         m_error;
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_BINARYLOG_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
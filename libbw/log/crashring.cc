@@ -0,0 +1,224 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstring>
+
+#include "crashring.h"
+#include "sysutil.h"
+
+namespace bw {
+
+/* Helper functions {{{ */
+
+/**
+ * \brief Formats \p value as decimal number without using stdio
+ *
+ * \param[out] buffer the output buffer, at least 21 bytes
+ * \param[in] value the number
+ * \return the length of the number (not NUL-terminated)
+ */
+static size_t formatNumber(char *buffer, unsigned long long value)
+{
+    char digits[20];
+    size_t count = 0;
+
+    do {
+        digits[count++] = '0' + value % 10;
+        value /= 10;
+    } while (value > 0);
+
+    for (size_t i = 0; i < count; ++i)
+        buffer[i] = digits[count - i - 1];
+
+    return count;
+}
+
+/* }}} */
+/* CrashRingBuffer {{{ */
+
+/**
+ * \brief The ring of one thread
+ *
+ * Only the owning thread writes. Each slot carries the record number plus one when it's
+ * complete and 0 while it's being written, so that dump() can detect torn records.
+ */
+struct CrashRingBuffer {
+    CrashRingBuffer(size_t capacity, size_t recordSize)
+        : next(NULL)
+        , threadNumber(0)
+        , sequences(new thread::Atomic<size_t>[capacity])
+        , lengths(new size_t[capacity])
+        , data(new char[capacity * recordSize])
+    {}
+
+    ~CrashRingBuffer()
+    {
+        delete[] sequences;
+        delete[] lengths;
+        delete[] data;
+    }
+
+    CrashRingBuffer                 *next;          // immutable once published
+    thread::Atomic<int>             owned;
+    unsigned int                    threadNumber;
+    thread::Atomic<size_t>          position;       // number of records written
+    thread::Atomic<size_t>          *sequences;
+    size_t                          *lengths;
+    char                            *data;
+};
+
+/* }}} */
+/* CrashRing {{{ */
+
+const size_t CrashRing::MaxRecordSize;
+
+CrashRing::CrashRing(size_t capacity, size_t recordSize)
+    : m_capacity(capacity > 0 ? capacity : 1)
+    , m_recordSize(recordSize < 64 ? 64 : recordSize > MaxRecordSize ? MaxRecordSize : recordSize)
+    , m_buffers(NULL)
+    , m_storage(releaseBuffer)
+{}
+
+CrashRing::~CrashRing()
+{
+    CrashRingBuffer *buffer = m_buffers.load();
+    while (buffer) {
+        CrashRingBuffer *next = buffer->next;
+        delete buffer;
+        buffer = next;
+    }
+}
+
+char *CrashRing::beginRecord()
+{
+    CrashRingBuffer *buffer = threadBuffer();
+    size_t slot = buffer->position.load(thread::MO_RELAXED) % m_capacity;
+
+    // mark the slot as being written before its contents change
+    buffer->sequences[slot].store(0, thread::MO_RELAXED);
+    thread::atomicFence(thread::MO_RELEASE);
+
+    return buffer->data + slot * m_recordSize;
+}
+
+void CrashRing::commitRecord(size_t length)
+{
+    CrashRingBuffer *buffer = static_cast<CrashRingBuffer *>(m_storage.get());
+    if (length == 0)
+        return;
+
+    size_t position = buffer->position.load(thread::MO_RELAXED);
+    size_t slot = position % m_capacity;
+
+    buffer->lengths[slot] = length < m_recordSize ? length : m_recordSize;
+    buffer->sequences[slot].store(position + 1, thread::MO_RELEASE);
+    buffer->position.store(position + 1, thread::MO_RELEASE);
+}
+
+void CrashRing::dump(int fd) const
+{
+    char record[MaxRecordSize];
+    char header[64];
+
+    for (CrashRingBuffer *buffer = m_buffers.load(thread::MO_ACQUIRE); buffer;
+            buffer = buffer->next) {
+        size_t end = buffer->position.load(thread::MO_ACQUIRE);
+        if (end == 0)
+            continue;
+        size_t start = end > m_capacity ? end - m_capacity : 0;
+
+        size_t length = 0;
+        std::memcpy(header, "--- thread ", 11);
+        length += 11;
+        length += formatNumber(header + length, buffer->threadNumber);
+        std::memcpy(header + length, " ---\n", 5);
+        length += 5;
+        writeAll(fd, header, length);
+
+        for (size_t i = start; i < end; ++i) {
+            size_t slot = i % m_capacity;
+            if (buffer->sequences[slot].load(thread::MO_ACQUIRE) != i + 1)
+                continue;
+
+            size_t recordLength = buffer->lengths[slot];
+            std::memcpy(record, buffer->data + slot * m_recordSize, recordLength);
+
+            // skip the record if the thread has overwritten it in the meantime
+            thread::atomicFence(thread::MO_ACQUIRE);
+            if (buffer->sequences[slot].load(thread::MO_RELAXED) != i + 1)
+                continue;
+
+            writeAll(fd, record, recordLength);
+        }
+    }
+}
+
+size_t CrashRing::recordSize() const
+{
+    return m_recordSize;
+}
+
+CrashRingBuffer *CrashRing::threadBuffer()
+{
+    CrashRingBuffer *buffer = static_cast<CrashRingBuffer *>(m_storage.get());
+    if (buffer)
+        return buffer;
+
+    // reuse the ring of a terminated thread
+    for (buffer = m_buffers.load(thread::MO_ACQUIRE); buffer; buffer = buffer->next) {
+        int expected = 0;
+        if (buffer->owned.compareExchange(expected, 1, thread::MO_ACQUIRE))
+            break;
+    }
+
+    if (buffer) {
+        buffer->position.store(0, thread::MO_RELAXED);
+        for (size_t i = 0; i < m_capacity; ++i)
+            buffer->sequences[i].store(0, thread::MO_RELAXED);
+    } else {
+        buffer = new CrashRingBuffer(m_capacity, m_recordSize);
+        buffer->owned.store(1, thread::MO_RELAXED);
+
+        CrashRingBuffer *head = m_buffers.load(thread::MO_RELAXED);
+        do {
+            buffer->next = head;
+        } while (!m_buffers.compareExchange(head, buffer, thread::MO_RELEASE));
+    }
+
+    buffer->threadNumber = m_nextThread.fetchAdd(1, thread::MO_RELAXED);
+    m_storage.set(buffer);
+
+    return buffer;
+}
+
+void CrashRing::releaseBuffer(void *buffer)
+{
+    static_cast<CrashRingBuffer *>(buffer)->owned.store(0, thread::MO_RELEASE);
+}
+
+/* }}} */
+
+} // end namespace bw
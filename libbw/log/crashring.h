@@ -0,0 +1,140 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_CRASHRING_H_
+#define LIBBW_LOG_CRASHRING_H_
+
+#include <cstddef>
+
+#include <libbw/noncopyable.h>
+#include <libbw/thread/atomic.h>
+#include <libbw/thread/threadstorage.h>
+
+namespace bw {
+
+struct CrashRingBuffer;
+
+/* CrashRing {{{ */
+
+/**
+ * \class CrashRing crashring.h libbw/log/crashring.h
+ * \brief Per-thread flight recorder for log records
+ *
+ * Each thread that writes a record gets its own ring of \p capacity fixed-size slots, so
+ * writers never contend with each other and never take a lock. When the ring of a thread
+ * is full, its oldest record is overwritten. Nothing is written to disk until dump() is
+ * called.
+ *
+ * dump() only uses async-signal-safe functions and may be called from a signal handler
+ * while other threads keep writing. A record that is overwritten during the dump is
+ * skipped.
+ *
+ * When a thread terminates, its ring is kept (including the records) until a new thread
+ * reuses it. The memory is only released by the destructor, which must not run while
+ * other threads still write records.
+ *
+ * The ring is used by Debug, see Debug::enableCrashRing().
+ *
+ * \ingroup log
+ */
+class CrashRing : private Noncopyable {
+
+public:
+    /**
+     * \brief Maximum value for the \p recordSize parameter of the constructor
+     */
+    static const size_t MaxRecordSize = 1024;
+
+public:
+    /**
+     * \brief Creates a new crash ring
+     *
+     * No memory is allocated before the first thread writes a record.
+     *
+     * \param[in] capacity the number of records per thread
+     * \param[in] recordSize the maximum size of one record in bytes, between 64 and
+     *            MaxRecordSize
+     */
+    CrashRing(size_t capacity, size_t recordSize);
+
+    /**
+     * \brief Destructor
+     */
+    ~CrashRing();
+
+public:
+    /**
+     * \brief Starts a new record in the ring of the calling thread
+     *
+     * The record is invisible to dump() until commitRecord() is called. Each call must be
+     * followed by exactly one call of commitRecord() in the same thread.
+     *
+     * \return a buffer of recordSize() bytes to write the record into
+     */
+    char *beginRecord();
+
+    /**
+     * \brief Finishes the record that has been started with beginRecord()
+     *
+     * \param[in] length the length of the record in bytes, 0 discards it
+     */
+    void commitRecord(size_t length);
+
+    /**
+     * \brief Writes the records of all threads to a file descriptor
+     *
+     * The records of each thread are written oldest first, preceded by a header line.
+     *
+     * \param[in] fd the file descriptor
+     */
+    void dump(int fd) const;
+
+    /**
+     * \brief Returns the maximum size of one record
+     *
+     * \return the size in bytes
+     */
+    size_t recordSize() const;
+
+private:
+    CrashRingBuffer *threadBuffer();
+    static void releaseBuffer(void *buffer);
+
+private:
+    size_t                              m_capacity;
+    size_t                              m_recordSize;
+    thread::Atomic<CrashRingBuffer *>   m_buffers;
+    thread::Atomic<unsigned int>        m_nextThread;
+    thread::ThreadStorage               m_storage;
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_CRASHRING_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
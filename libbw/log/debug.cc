@@ -26,44 +26,571 @@
  */
 #include <cstdio>
 #include <cstdarg>
+#include <cctype>
+#include <cstdlib>
 #include <cstring>
 #include <string>
+#include <vector>
 
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+
+#include "bwconfig.h"
 #include "debug.h"
+#include "binarylog.h"
+#include "exithandler.h"
+#include "optionparser.h"
+#include "stringutil.h"
+#ifdef HAVE_THREADS
+#  include <sched.h>
+#  include <thread/atomic.h>
+#  include <thread/condition.h>
+#  include <thread/mutexlocker.h>
+#  include <thread/thread.h>
+#  include "messagering.h"
+#  include "crashring.h"
+#endif
 
 namespace bw {
 
-Debug *Debug::m_instance = NULL;
+class DebugFlusher;
+
+/* DebugOutput {{{ */
+
+/**
+ * \brief The output handle, the flusher and the binary writer of Debug, replaced in
+ *        read-copy-update style
+ *
+ * Writers announce that they use the handle by incrementing the reader count of the
+ * current epoch. replace() publishes the new handle, switches the epoch so that new
+ * writers use the other counter, and waits until the count of the previous epoch drops
+ * to zero. Writers never wait.
+ *
+ * A writer may be delayed between reading the epoch and incrementing the counter, so
+ * acquire() reads the epoch again afterwards and retries with the other counter if it has
+ * been switched in the meantime. Otherwise a replace() could miss the writer because it
+ * waits on the counter of the current epoch only.
+ *
+ * The flusher of the asynchronous mode and the binary writer are only used between
+ * acquire() and release(), so after clearing their pointer, synchronize() guarantees that
+ * they can be deleted.
+ */
+struct DebugOutput {
+    explicit DebugOutput(FILE *initial);
+
+    FILE *acquire(unsigned int *epoch);
+    void release(unsigned int epoch);
+    FILE *get() const;
+    void replace(FILE *handle);
+    void synchronize();
+    BinaryLogWriter *getBinary() const;
+    BinaryLogWriter *exchangeBinary(BinaryLogWriter *writer);
+
+#ifdef HAVE_THREADS
+    thread::Atomic<FILE *>              handle;
+    thread::Atomic<DebugFlusher *>      flusher;
+    thread::Atomic<BinaryLogWriter *>   binary;
+    thread::Atomic<unsigned int>        epoch;
+    thread::Atomic<unsigned long>       readers[2];
+    thread::Mutex                       mutex;      // serializes synchronize()
+#else
+    FILE                                *handle;
+    BinaryLogWriter                     *binary;
+#endif
+};
+
+#ifdef HAVE_THREADS
+
+DebugOutput::DebugOutput(FILE *initial)
+    : handle(initial)
+    , flusher(NULL)
+    , binary(NULL)
+{}
+
+FILE *DebugOutput::acquire(unsigned int *currentEpoch)
+{
+    for (;;) {
+        unsigned int current = epoch.load(thread::MO_RELAXED) & 1;
+        readers[current].fetchAdd(1);
+        if ((epoch.load() & 1) == current) {
+            *currentEpoch = current;
+            return handle.load();
+        }
+        readers[current].fetchSub(1, thread::MO_RELEASE);
+    }
+}
+
+void DebugOutput::release(unsigned int currentEpoch)
+{
+    readers[currentEpoch].fetchSub(1, thread::MO_RELEASE);
+}
+
+FILE *DebugOutput::get() const
+{
+    return handle.load(thread::MO_ACQUIRE);
+}
+
+void DebugOutput::replace(FILE *newHandle)
+{
+    handle.store(newHandle);
+    synchronize();
+}
+
+void DebugOutput::synchronize()
+{
+    thread::MutexLocker locker(&mutex);
+
+    unsigned int previous = epoch.fetchAdd(1) & 1;
+    while (readers[previous].load() != 0)
+        sched_yield();
+}
+
+BinaryLogWriter *DebugOutput::getBinary() const
+{
+    return binary.load(thread::MO_ACQUIRE);
+}
+
+BinaryLogWriter *DebugOutput::exchangeBinary(BinaryLogWriter *writer)
+{
+    return binary.exchange(writer);
+}
+
+#else
+
+DebugOutput::DebugOutput(FILE *initial)
+    : handle(initial)
+    , binary(NULL)
+{}
+
+FILE *DebugOutput::acquire(unsigned int *currentEpoch)
+{
+    *currentEpoch = 0;
+    return handle;
+}
+
+void DebugOutput::release(unsigned int currentEpoch)
+{
+    (void)currentEpoch;
+}
+
+FILE *DebugOutput::get() const
+{
+    return handle;
+}
+
+void DebugOutput::replace(FILE *newHandle)
+{
+    handle = newHandle;
+}
+
+void DebugOutput::synchronize()
+{}
+
+BinaryLogWriter *DebugOutput::getBinary() const
+{
+    return binary;
+}
+
+BinaryLogWriter *DebugOutput::exchangeBinary(BinaryLogWriter *writer)
+{
+    BinaryLogWriter *previous = binary;
+    binary = writer;
+    return previous;
+}
+
+#endif /* HAVE_THREADS */
+
+/* }}} */
+/* DebugCategories {{{ */
+
+/**
+ * \brief Names of the registered debug categories
+ *
+ * The levels are stored in Debug itself so that the inline level check doesn't need to
+ * dereference another pointer. A name is written once before its handle is returned and
+ * never changes afterwards, so reading it needs no lock.
+ *
+ * \c generation counts the calls of Debug::updateThreshold(), see there.
+ */
+struct DebugCategories {
+    DebugCategories()
+        : count(1)
+#ifndef HAVE_THREADS
+        , generation(0)
+#endif
+    {
+        std::strcpy(names[Debug::DefaultCategory], "default");
+    }
+
+    char                            names[Debug::MaxCategories][Debug::MaxCategoryNameLength];
+    unsigned int                    count;
+#ifdef HAVE_THREADS
+    thread::Atomic<unsigned int>    generation;
+    thread::Mutex                   mutex;      // serializes registerCategory()
+#else
+    volatile sig_atomic_t           generation;
+#endif
+};
+
+/* }}} */
+/* DebugFlusher {{{ */
+
+#ifdef HAVE_THREADS
+
+/**
+ * \brief Background thread that writes the messages of the asynchronous mode
+ *
+ * Producers push complete records into the ring. The flusher thread drains the ring in
+ * batches and only sleeps if the ring is empty. Producers only take the mutex to wake up
+ * the flusher if it's actually sleeping.
+ */
+class DebugFlusher : public thread::Thread {
+
+public:
+    DebugFlusher(DebugOutput *output, size_t capacity, Debug::OverflowPolicy policy);
+
+public:
+    void enqueue(const char *record, size_t length);
+    void flush();
+    void stop();
+    unsigned long dropped() const;
+
+protected:
+    void run();
+
+private:
+    void wakeup();
+
+private:
+    DebugOutput                     *m_output;
+    MessageRing                     m_ring;
+    Debug::OverflowPolicy           m_policy;
+    thread::Atomic<unsigned long>   m_dropped;
+    thread::Atomic<size_t>          m_completed;
+    thread::Atomic<int>             m_sleeping;
+    thread::Atomic<int>             m_stop;
+    thread::Mutex                   m_mutex;
+    thread::Condition               m_wakeup;
+    thread::Condition               m_progress;
+};
+
+DebugFlusher::DebugFlusher(DebugOutput *output, size_t capacity,
+                           Debug::OverflowPolicy policy)
+    : m_output(output)
+    , m_ring(capacity, Debug::AsyncRecordSize)
+    , m_policy(policy)
+{}
+
+void DebugFlusher::enqueue(const char *record, size_t length)
+{
+    while (!m_ring.push(record, length)) {
+        switch (m_policy) {
+            case Debug::OP_DROP_NEWEST:
+                m_dropped.fetchAdd(1, thread::MO_RELAXED);
+                return;
+
+            case Debug::OP_DROP_OLDEST:
+                if (m_ring.pop(NULL, NULL)) {
+                    m_dropped.fetchAdd(1, thread::MO_RELAXED);
+                    m_completed.fetchAdd(1, thread::MO_RELEASE);
+                }
+                break;
+
+            case Debug::OP_BLOCK:
+                wakeup();
+                sched_yield();
+                break;
+        }
+    }
+
+    if (m_sleeping.load(thread::MO_SEQ_CST))
+        wakeup();
+}
+
+void DebugFlusher::flush()
+{
+    size_t target = m_ring.pushed();
+
+    thread::MutexLocker locker(&m_mutex);
+    while (m_completed.load(thread::MO_ACQUIRE) < target) {
+        m_wakeup.signal();
+        m_progress.wait(&m_mutex, 10);
+    }
+}
+
+void DebugFlusher::stop()
+{
+    m_stop.store(1);
+    wakeup();
+    join();
+}
+
+unsigned long DebugFlusher::dropped() const
+{
+    return m_dropped.load(thread::MO_RELAXED);
+}
+
+void DebugFlusher::wakeup()
+{
+    thread::MutexLocker locker(&m_mutex);
+    m_wakeup.signal();
+}
+
+void DebugFlusher::run()
+{
+    char record[Debug::AsyncRecordSize];
+
+    for (;;) {
+        // read the stop flag before draining so that nothing gets lost
+        bool stop = m_stop.load() != 0;
+        unsigned int epoch;
+        FILE *handle = m_output->acquire(&epoch);
+        size_t length;
+        bool written = false;
+
+        while (m_ring.pop(record, &length)) {
+            std::fwrite(record, 1, length, handle);
+            m_completed.fetchAdd(1, thread::MO_RELEASE);
+            written = true;
+        }
+        if (written)
+            std::fflush(handle);
+        m_output->release(epoch);
+
+        thread::MutexLocker locker(&m_mutex);
+        m_progress.broadcast();
+        if (stop)
+            break;
+
+        m_sleeping.store(1);
+        if (m_ring.empty() && !m_stop.load())
+            m_wakeup.wait(&m_mutex, 50);
+        m_sleeping.store(0);
+    }
+}
+
+#endif /* HAVE_THREADS */
+
+/* }}} */
+/* DebugExitHandler {{{ */
+
+/**
+ * \brief Writes pending asynchronous and binary messages on program termination
+ */
+class DebugExitHandler : public ExitHandler {
+
+public:
+    void exitCleanup()
+    {
+        Debug *debug = Debug::debug();
+        debug->m_exitHandler = NULL;
+        debug->flush();
+        debug->setSynchronous();
+    }
+};
+
+/* }}} */
+/* Record formatting {{{ */
+
+/**
+ * \brief Reusable per-thread buffer for synchronous output
+ *
+ * Large enough for virtually every debug message, so that the synchronous path never
+ * needs to allocate memory.
+ */
+static BW_COMPILER_THREAD_LOCAL char t_recordBuffer[4096];
+
+/**
+ * \brief Returns the prefix that is prepended to messages of \p level
+ *
+ * \param[in] level the debug level
+ * \return the prefix, an empty string for unknown levels
+ */
+static const char *levelPrefix(Debug::Level level)
+{
+    switch (level) {
+        case Debug::DL_TRACE:
+            return "TRACE: ";
+
+        case Debug::DL_INFO:
+            return "INFO: ";
+
+        case Debug::DL_DEBUG:
+            return "DEBUG: ";
+
+        default:    // make the compiler happy
+            return "";
+    }
+}
+
+/**
+ * \brief Formats a complete debug record
+ *
+ * The record consists of the level prefix, the formatted message and a trailing newline
+ * which is only appended if the message doesn't end with a newline already. The record is
+ * not NUL-terminated.
+ *
+ * \param[out] buffer the output buffer
+ * \param[in] size the size of \p buffer, must be larger than the level prefix plus
+ *            Debug::MaxCategoryNameLength
+ * \param[in] level the debug level
+ * \param[in] category the name of the category that is printed after the prefix, \c NULL
+ *            for no category
+ * \param[in] msg the printf()-like format string
+ * \param[in] args the arguments for \p msg
+ * \param[out] required the buffer size that is needed to hold the complete record. If
+ *             that's larger than \p size, the record has been truncated.
+ * \return the length of the record in \p buffer, 0 on formatting errors
+ */
+static size_t formatRecord(char *buffer, size_t size, Debug::Level level,
+                           const char *category, const char *msg, std::va_list args,
+                           size_t *required)
+{
+    const char *prefix = levelPrefix(level);
+    size_t len = std::strlen(prefix);
+    std::memcpy(buffer, prefix, len);
+
+    if (category) {
+        size_t categoryLength = std::strlen(category);
+        buffer[len++] = '[';
+        std::memcpy(buffer + len, category, categoryLength);
+        len += categoryLength;
+        buffer[len++] = ']';
+        buffer[len++] = ' ';
+    }
+
+    int ret = vsnprintf(buffer + len, size - len, msg, args);
+    if (ret < 0) {
+        *required = 0;
+        return 0;
+    }
+
+    // reserve space for the newline and the NUL byte written by vsnprintf()
+    *required = len + ret + 2;
+    if (*required > size)
+        len = size - 1;
+    else
+        len += ret;
+
+    // append '\n' if there's no one at the end
+    if (len == 0 || buffer[len-1] != '\n')
+        buffer[len++] = '\n';
+
+    return len;
+}
+
+/**
+ * \brief Parses the name or the number of a debug level
+ *
+ * \param[in] name \c trace, \c debug, \c info, \c none (case-insensitive) or a number
+ * \param[out] level the parsed level
+ * \return \c true on success, \c false if \p name is invalid
+ */
+static bool parseLevel(const std::string &name, Debug::Level *level)
+{
+    std::string lower;
+    for (size_t i = 0; i < name.size(); ++i)
+        lower += static_cast<char>(std::tolower(static_cast<unsigned char>(name[i])));
+
+    if (lower == "trace")
+        *level = Debug::DL_TRACE;
+    else if (lower == "debug")
+        *level = Debug::DL_DEBUG;
+    else if (lower == "info")
+        *level = Debug::DL_INFO;
+    else if (lower == "none")
+        *level = Debug::DL_NONE;
+    else {
+        char *end;
+        long value = std::strtol(lower.c_str(), &end, 10);
+        if (lower.empty() || *end != '\0' || value < 0)
+            return false;
+        *level = static_cast<Debug::Level>(value);
+    }
+
+    return true;
+}
+
+/* }}} */
+/* Crash handler {{{ */
+
+#ifdef HAVE_THREADS
+
+/**
+ * \brief The file passed to Debug::enableCrashRing()
+ *
+ * A fixed buffer since the signal handler must not access a std::string that another
+ * thread may be modifying.
+ */
+static char s_crashDumpFile[4096];
+
+/**
+ * \brief Signals that are handled by Debug::installCrashHandler()
+ */
+static const int s_crashSignals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+
+/**
+ * \brief Dumps the crash ring and terminates the program with the original signal
+ *
+ * The handler is installed with \c SA_RESETHAND and \c SA_NODEFER, so raising the signal
+ * again performs the default action.
+ */
+static void crashSignalHandler(int signo)
+{
+    Debug::debug()->dumpCrashRing();
+    raise(signo);
+}
+
+#endif /* HAVE_THREADS */
+
+/* }}} */
+/* Debug {{{ */
+
+const size_t Debug::AsyncRecordSize;
+const Debug::Category Debug::DefaultCategory;
+const unsigned int Debug::MaxCategories;
+const size_t Debug::MaxCategoryNameLength;
 
 Debug *Debug::debug()
 {
-    if (!m_instance)
-        m_instance = new Debug();
+    // function-local so that it's created on first use, even if that happens in a static
+    // constructor of another translation unit. The compiler serializes the initialization
+    // if several threads get here at the same time.
+    static Debug *s_instance = new Debug();
 
-    return m_instance;
+    return s_instance;
 }
 
 Debug::Debug()
     : m_debuglevel(DL_NONE)
-    , m_handle(stderr)
-{}
+    , m_threshold(DL_NONE)
+    , m_categories(new DebugCategories)
+    , m_output(new DebugOutput(stderr))
+    , m_exitHandler(NULL)
+    , m_crashRing(NULL)
+    , m_crashRingEnabled(false)
+{
+    for (unsigned int i = 0; i < MaxCategories; ++i) {
+        m_categoryThresholds[i] = DL_NONE;
+        m_categoryLevels[i] = -1;
+    }
+}
 
 void Debug::setLevel(Debug::Level level)
 {
-    m_debuglevel = level;
+    BW_COMPILER_STORE_RELAXED(m_debuglevel, level);
+    updateThreshold();
 }
 
 void Debug::setFileHandle(FILE *handle)
 {
-    if (!handle)
-        m_handle = stderr;
-    else
-        m_handle = handle;
+    m_output->replace(handle ? handle : stderr);
 }
 
 FILE *Debug::getFileHandle() const
 {
-    return m_handle;
+    return m_output->get();
 }
 
 void Debug::dbg(const char *msg, ...)
@@ -102,64 +629,502 @@ void Debug::msg(Debug::Level level, const char *msg, ...)
     va_end(valist);
 }
 
+void Debug::msg(Debug::Category category, Debug::Level level, const char *msg, ...)
+{
+    va_list valist;
+
+    va_start(valist, msg);
+    vmsg(category, level, msg, valist);
+    va_end(valist);
+}
+
 void Debug::vmsg(Debug::Level level, const char *msg, std::va_list args)
 {
     // if the global debug level is too small, then just do nothing
-    if (level < m_debuglevel)
+    if (level < BW_COMPILER_LOAD_RELAXED(m_threshold))
         return;
 
-    size_t len = strlen(msg) + 20;
-    char *newmsg = new char[len];
-    if (!newmsg)
+    output(level, BW_COMPILER_LOAD_RELAXED(m_debuglevel), NULL, msg, args);
+}
+
+void Debug::vmsg(Debug::Category category, Debug::Level level, const char *msg,
+                 std::va_list args)
+{
+    if (category >= MaxCategories)
+        category = DefaultCategory;
+    if (level < BW_COMPILER_LOAD_RELAXED(m_categoryThresholds[category]))
         return;
-    memset(newmsg, 0, len);
 
-    // prepend dump level
-    switch (level) {
-        case DL_TRACE:
-            strcat(newmsg, "TRACE: ");
-            break;
+    output(level, getCategoryLevel(category),
+           category != DefaultCategory ? m_categories->names[category] : NULL, msg, args);
+}
 
-        case DL_INFO:
-            strcat(newmsg, "INFO: ");
-            break;
+void Debug::output(Debug::Level level, Debug::Level outputLevel, const char *category,
+                   const char *msg, std::va_list args)
+{
+#ifdef HAVE_THREADS
+    if (BW_COMPILER_LOAD_RELAXED(m_crashRingEnabled)) {
+        // pairs with the release fence in enableCrashRing(), so m_crashRing is visible
+        thread::atomicFence(thread::MO_ACQUIRE);
 
-        case DL_DEBUG:
-            strcat(newmsg, "DEBUG: ");
-            break;
+        std::va_list argsCopy;
+        BW_COMPILER_VA_COPY(argsCopy, args);
 
-        default:    // make the compiler happy
-            break;
+        size_t required;
+        char *record = m_crashRing->beginRecord();
+        m_crashRing->commitRecord(formatRecord(record, m_crashRing->recordSize(), level,
+                                               category, msg, argsCopy, &required));
+        va_end(argsCopy);
+
+        if (level < outputLevel)
+            return;
     }
-    strcat(newmsg, msg);
+#endif
 
-    // append '\n' if there's no one at the end
-    len = strlen(newmsg);
-    if (newmsg[len-1] != '\n') {
-        newmsg[len++] = '\n';
-        newmsg[len] = '\0';
+    size_t required;
+    unsigned int epoch;
+    FILE *handle = m_output->acquire(&epoch);
+
+    BinaryLogWriter *binary = m_output->getBinary();
+    if (binary) {
+        binary->write(BinaryLogWriter::BS_DEBUG, level, msg, args);
+        m_output->release(epoch);
+        return;
+    }
+
+#ifdef HAVE_THREADS
+    DebugFlusher *flusher = m_output->flusher.load(thread::MO_ACQUIRE);
+    if (flusher) {
+        // records that don't fit into a ring slot are truncated
+        char record[AsyncRecordSize];
+        size_t len = formatRecord(record, sizeof(record), level, category, msg, args,
+                                  &required);
+        if (len > 0)
+            flusher->enqueue(record, len);
+        m_output->release(epoch);
+        return;
     }
+#endif
 
-    vfprintf(m_handle, newmsg, args);
+    std::va_list argsCopy;
+    BW_COMPILER_VA_COPY(argsCopy, args);
 
-    delete[] newmsg;
+    size_t len = formatRecord(t_recordBuffer, sizeof(t_recordBuffer), level, category, msg,
+                              args, &required);
+    if (required <= sizeof(t_recordBuffer))
+        std::fwrite(t_recordBuffer, 1, len, handle);
+    else {
+        // only very long messages need the heap
+        char *record = new char[required];
+        len = formatRecord(record, required, level, category, msg, argsCopy, &required);
+        std::fwrite(record, 1, len, handle);
+        delete[] record;
+    }
+    m_output->release(epoch);
+
+    va_end(argsCopy);
 }
 
 void Debug::msg(Debug::Level level, const std::string &buffer)
 {
+    if (!BW_COMPILER_LOAD_RELAXED(m_crashRingEnabled)) {
+        unsigned int epoch;
+        m_output->acquire(&epoch);
+        BinaryLogWriter *binary = m_output->getBinary();
+        if (binary && level >= BW_COMPILER_LOAD_RELAXED(m_debuglevel))
+            binary->writeText(BinaryLogWriter::BS_DEBUG, level, buffer);
+        m_output->release(epoch);
+        if (binary)
+            return;
+    }
+
     msg(level, "%s", buffer.c_str());
 }
 
+void Debug::msg(Debug::Category category, Debug::Level level, const std::string &buffer)
+{
+    msg(category, level, "%s", buffer.c_str());
+}
+
 Debug::Level Debug::getLevel() const
 {
-    return m_debuglevel;
+    return BW_COMPILER_LOAD_RELAXED(m_debuglevel);
 }
 
 bool Debug::isDebugEnabled() const
 {
-    return m_debuglevel < DL_NONE;
+    return BW_COMPILER_LOAD_RELAXED(m_threshold) < DL_NONE;
+}
+
+Debug::Category Debug::registerCategory(const char *name)
+{
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&m_categories->mutex);
+#endif
+    char truncated[MaxCategoryNameLength];
+    std::strncpy(truncated, name, sizeof(truncated) - 1);
+    truncated[sizeof(truncated) - 1] = '\0';
+
+    for (Category category = 0; category < m_categories->count; ++category)
+        if (std::strcmp(m_categories->names[category], truncated) == 0)
+            return category;
+
+    if (m_categories->count == MaxCategories)
+        return DefaultCategory;
+
+    Category category = m_categories->count;
+    std::strcpy(m_categories->names[category], truncated);
+    m_categories->count++;
+    updateThreshold();
+
+    return category;
+}
+
+const char *Debug::categoryName(Debug::Category category) const
+{
+    return m_categories->names[category < MaxCategories ? category : DefaultCategory];
+}
+
+void Debug::setCategoryLevel(Debug::Category category, Debug::Level level)
+{
+    if (category >= MaxCategories)
+        return;
+
+    BW_COMPILER_STORE_RELAXED(m_categoryLevels[category], static_cast<int>(level));
+    updateThreshold();
+}
+
+void Debug::resetCategoryLevel(Debug::Category category)
+{
+    if (category >= MaxCategories)
+        return;
+
+    BW_COMPILER_STORE_RELAXED(m_categoryLevels[category], -1);
+    updateThreshold();
+}
+
+Debug::Level Debug::getCategoryLevel(Debug::Category category) const
+{
+    int level = BW_COMPILER_LOAD_RELAXED(m_categoryLevels[category]);
+    return level >= 0 ? static_cast<Level>(level) : BW_COMPILER_LOAD_RELAXED(m_debuglevel);
+}
+
+bool Debug::configureCategories(const std::string &spec)
+{
+    std::vector<std::string> entries = stringsplit(spec, ",");
+    bool ok = true;
+
+    for (size_t i = 0; i < entries.size(); ++i) {
+        std::string entry = strip(entries[i]);
+        if (entry.empty())
+            continue;
+
+        std::string::size_type eq = entry.find('=');
+        Level level = DL_NONE;
+        if (eq == std::string::npos || !parseLevel(strip(entry.substr(eq + 1)), &level)) {
+            ok = false;
+            continue;
+        }
+
+        std::string name = strip(entry.substr(0, eq));
+        if (name == "*")
+            setLevel(level);
+        else if (!name.empty())
+            setCategoryLevel(registerCategory(name.c_str()), level);
+        else
+            ok = false;
+    }
+
+    return ok;
+}
+
+bool Debug::configureCategoriesFromEnvironment(const char *variable)
+{
+    const char *value = std::getenv(variable);
+    return value ? configureCategories(value) : true;
+}
+
+bool Debug::configureCategories(const OptionValue &value)
+{
+    return value ? configureCategories(value.getString()) : true;
+}
+
+void Debug::updateThreshold()
+{
+    // Concurrent calls, also from a signal handler, read the levels at different times, so
+    // the one that stores last might publish outdated thresholds. Therefore each call
+    // increments the generation and repeats the update if another call has started in the
+    // meantime. No lock is taken, so setLevel() stays async-signal-safe.
+#ifdef HAVE_THREADS
+    unsigned int current = m_categories->generation.fetchAdd(1) + 1;
+#else
+    sig_atomic_t current = ++m_categories->generation;
+#endif
+
+    for (;;) {
+        bool crashRing = BW_COMPILER_LOAD_RELAXED(m_crashRingEnabled);
+        BW_COMPILER_STORE_RELAXED(m_threshold,
+                                  crashRing ? DL_TRACE : BW_COMPILER_LOAD_RELAXED(m_debuglevel));
+
+        // the categories that are not registered yet don't matter, but updating them is
+        // cheaper than synchronizing with registerCategory()
+        for (Category category = 0; category < MaxCategories; ++category)
+            BW_COMPILER_STORE_RELAXED(m_categoryThresholds[category],
+                                      crashRing ? DL_TRACE : getCategoryLevel(category));
+
+#ifdef HAVE_THREADS
+        // a read-modify-write, so that the stores above happen before those of the next call
+        if (m_categories->generation.compareExchange(current, current))
+            break;
+#else
+        if (m_categories->generation == current)
+            break;
+        current = m_categories->generation;
+#endif
+    }
+}
+
+#ifdef HAVE_THREADS
+
+bool Debug::setAsynchronous(size_t capacity, OverflowPolicy policy)
+{
+    setSynchronous();
+
+    DebugFlusher *flusher = new DebugFlusher(m_output, capacity, policy);
+    if (!flusher->start()) {
+        delete flusher;
+        return false;
+    }
+
+    // another thread might have switched to asynchronous mode in the meantime
+    DebugFlusher *previous = m_output->flusher.exchange(flusher);
+    if (previous) {
+        m_output->synchronize();
+        previous->stop();
+        delete previous;
+    }
+
+    if (!m_exitHandler) {
+        m_exitHandler = new DebugExitHandler;
+        registerExitHandler(m_exitHandler);
+    }
+
+    return true;
+}
+
+void Debug::setSynchronous()
+{
+    DebugFlusher *flusher = m_output->flusher.exchange(NULL);
+    if (!flusher)
+        return;
+
+    // threads that are logging right now may still enqueue their records
+    m_output->synchronize();
+    flusher->stop();
+    delete flusher;
+
+    if (m_exitHandler && !isBinary()) {
+        unregisterExitHandler(m_exitHandler);
+        m_exitHandler = NULL;
+    }
+}
+
+unsigned long Debug::droppedMessages() const
+{
+    unsigned int epoch;
+    m_output->acquire(&epoch);
+    DebugFlusher *flusher = m_output->flusher.load(thread::MO_ACQUIRE);
+    unsigned long dropped = flusher ? flusher->dropped() : 0;
+    m_output->release(epoch);
+
+    return dropped;
+}
+
+void Debug::flush()
+{
+    unsigned int epoch;
+    m_output->acquire(&epoch);
+    DebugFlusher *flusher = m_output->flusher.load(thread::MO_ACQUIRE);
+    if (flusher)
+        flusher->flush();
+    BinaryLogWriter *binary = m_output->getBinary();
+    if (binary)
+        binary->flush();
+    m_output->release(epoch);
+
+    std::fflush(getFileHandle());
+}
+
+bool Debug::enableCrashRing(const char *dumpFile, size_t capacity, size_t recordSize)
+{
+    if (!dumpFile)
+        s_crashDumpFile[0] = '\0';
+    else if (std::strlen(dumpFile) < sizeof(s_crashDumpFile))
+        std::strcpy(s_crashDumpFile, dumpFile);
+
+    if (!m_crashRing)
+        m_crashRing = new CrashRing(capacity, recordSize);
+
+    thread::atomicFence(thread::MO_RELEASE);
+    BW_COMPILER_STORE_RELAXED(m_crashRingEnabled, true);
+    updateThreshold();
+
+    return true;
+}
+
+void Debug::disableCrashRing()
+{
+    BW_COMPILER_STORE_RELAXED(m_crashRingEnabled, false);
+    updateThreshold();
+}
+
+void Debug::dumpCrashRing()
+{
+    if (!m_crashRing)
+        return;
+
+    if (s_crashDumpFile[0] == '\0') {
+        dumpCrashRing(STDERR_FILENO);
+        return;
+    }
+
+    int fd = open(s_crashDumpFile, O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (fd < 0)
+        return;
+    dumpCrashRing(fd);
+    close(fd);
+}
+
+void Debug::dumpCrashRing(int fd)
+{
+    if (m_crashRing)
+        m_crashRing->dump(fd);
 }
 
+bool Debug::installCrashHandler()
+{
+    struct sigaction action;
+    std::memset(&action, 0, sizeof(action));
+    action.sa_handler = crashSignalHandler;
+    action.sa_flags = SA_RESETHAND | SA_NODEFER;
+    sigemptyset(&action.sa_mask);
+
+    for (size_t i = 0; i < sizeof(s_crashSignals) / sizeof(s_crashSignals[0]); ++i)
+        if (sigaction(s_crashSignals[i], &action, NULL) != 0)
+            return false;
+
+    return true;
+}
+
+#else
+
+bool Debug::setAsynchronous(size_t capacity, OverflowPolicy policy)
+{
+    (void)capacity;
+    (void)policy;
+
+    return false;
+}
+
+void Debug::setSynchronous()
+{}
+
+unsigned long Debug::droppedMessages() const
+{
+    return 0;
+}
+
+void Debug::flush()
+{
+    BinaryLogWriter *binary = m_output->getBinary();
+    if (binary)
+        binary->flush();
+    std::fflush(getFileHandle());
+}
+
+bool Debug::enableCrashRing(const char *dumpFile, size_t capacity, size_t recordSize)
+{
+    (void)dumpFile;
+    (void)capacity;
+    (void)recordSize;
+
+    return false;
+}
+
+void Debug::disableCrashRing()
+{}
+
+void Debug::dumpCrashRing()
+{}
+
+void Debug::dumpCrashRing(int fd)
+{
+    (void)fd;
+}
+
+bool Debug::installCrashHandler()
+{
+    return false;
+}
+
+#endif /* HAVE_THREADS */
+
+bool Debug::isAsynchronous() const
+{
+#ifdef HAVE_THREADS
+    return m_output->flusher.load(thread::MO_RELAXED) != NULL;
+#else
+    return false;
+#endif
+}
+
+bool Debug::setBinaryOutput(const char *filename)
+{
+    // threads that are logging right now may still write to the previous writer
+    BinaryLogWriter *previous = m_output->exchangeBinary(NULL);
+    if (previous) {
+        m_output->synchronize();
+        delete previous;
+    }
+
+    if (filename) {
+        BinaryLogWriter *binary = new BinaryLogWriter;
+        if (!binary->open(filename)) {
+            delete binary;
+            return false;
+        }
+
+        // another thread might have switched to binary output in the meantime
+        previous = m_output->exchangeBinary(binary);
+        if (previous) {
+            m_output->synchronize();
+            delete previous;
+        }
+
+        if (!m_exitHandler) {
+            m_exitHandler = new DebugExitHandler;
+            registerExitHandler(m_exitHandler);
+        }
+    } else if (m_exitHandler && !isAsynchronous()) {
+        unregisterExitHandler(m_exitHandler);
+        m_exitHandler = NULL;
+    }
+
+    return true;
+}
+
+bool Debug::isBinary() const
+{
+    return m_output->getBinary() != NULL;
+}
+
+bool Debug::isCrashRingEnabled() const
+{
+    return BW_COMPILER_LOAD_RELAXED(m_crashRingEnabled);
+}
+
+/* }}} */
+
 } // end namespace bw
 
 // :tabSize=4:indentSize=4:noTabs=true:mode=c++:folding=explicit:collapseFolds=1:maxLineLen=100:
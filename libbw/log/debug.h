@@ -36,6 +36,35 @@
 
 /* Macros {{{ */
 
+/**
+ * \brief Compile-time minimum debug level
+ *
+ * Debug macros with a level below this value compile to nothing: neither the message nor
+ * its arguments are evaluated. Define it before including this header or on the compiler
+ * command line, for example <tt>-DBW_DEBUG_MIN_LEVEL=20</tt> to keep only
+ * bw::Debug::DL_INFO messages in release builds. The default keeps all messages. The
+ * values correspond to bw::Debug::Level.
+ *
+ * \ingroup log
+ */
+#ifndef BW_DEBUG_MIN_LEVEL
+#define BW_DEBUG_MIN_LEVEL 0
+#endif
+
+/**
+ * \brief Checks if messages with \p level would be printed
+ *
+ * Evaluates to \c false at compile time if \p level is a constant below
+ * BW_DEBUG_MIN_LEVEL. Otherwise, only the current debug level is checked, which is cheap
+ * compared to formatting the message. \p level may be evaluated more than once; the
+ * BW_DEBUG() macros evaluate it exactly once.
+ *
+ * \param[in] level the debugging level
+ * \ingroup log
+ */
+#define BW_DEBUG_ENABLED(level) \
+    (static_cast<int>(level) >= BW_DEBUG_MIN_LEVEL && bw::Debug::debug()->isEnabled(level))
+
 /**
  * \brief Writes a debug message with a specified level
  *
@@ -52,8 +81,12 @@
  * \ingroup log
  * \see BW_DEBUG_DBG(), BW_DEBUG_INFO(), BW_DEBUG_TRACE()
  */
-#define BW_DEBUG(level, ...) \
-    bw::Debug::debug()->msg(level, __VA_ARGS__)
+#define BW_DEBUG(level, ...)                                \
+    do {                                                    \
+        const bw::Debug::Level _bwLevel = (level);          \
+        if (BW_DEBUG_ENABLED(_bwLevel))                     \
+            bw::Debug::debug()->msg(_bwLevel, __VA_ARGS__); \
+    } while (0)
 
 /**
  * \brief Writes a debug message with a specified level using C++ streams
@@ -73,9 +106,12 @@
  */
 #define BW_DEBUG_STREAM(level, output)                      \
     do {                                                    \
-        std::ostringstream _oss;                            \
-        _oss << output;                                     \
-        bw::Debug::debug()->msg(level, _oss.str());         \
+        const bw::Debug::Level _bwLevel = (level);          \
+        if (BW_DEBUG_ENABLED(_bwLevel)) {                   \
+            std::ostringstream _oss;                        \
+            _oss << output;                                 \
+            bw::Debug::debug()->msg(_bwLevel, _oss.str());  \
+        }                                                   \
     } while (0)
 
 /**
@@ -94,7 +130,7 @@
  * \see BW_DEBUG_INFO(), BW_DEBUG_TRACE()
  */
 #define BW_DEBUG_DBG(...) \
-    bw::Debug::debug()->dbg(__VA_ARGS__)
+    BW_DEBUG(bw::Debug::DL_DEBUG, __VA_ARGS__)
 
 /**
  * \brief Writes a debug message using C++ streams (debug level)
@@ -129,7 +165,7 @@
  * \see BW_DEBUG_DBG(), BW_DEBUG_TRACE()
  */
 #define BW_DEBUG_INFO(...) \
-    bw::Debug::debug()->info(__VA_ARGS__)
+    BW_DEBUG(bw::Debug::DL_INFO, __VA_ARGS__)
 
 /**
  * \brief Writes a debug message using C++ streams (info level)
@@ -164,7 +200,7 @@
  * \see BW_DEBUG_INFO(), BW_DEBUG_DBG()
  */
 #define BW_DEBUG_TRACE(...) \
-    bw::Debug::debug()->trace(__VA_ARGS__)
+    BW_DEBUG(bw::Debug::DL_TRACE, __VA_ARGS__)
 
 /**
  * \brief Writes a debug message using C++ streams (trace level)
@@ -182,10 +218,77 @@
  */
 #define BW_DEBUG_STREAM_TRACE(output) \
     BW_DEBUG_STREAM(bw::Debug::DL_TRACE, output)
+
+/**
+ * \brief Checks if messages of \p category with \p level would be printed
+ *
+ * Like BW_DEBUG_ENABLED(), but with the level of \p category, which costs one indexed
+ * load. The arguments may be evaluated more than once; the BW_DEBUG_CATEGORY() macros
+ * evaluate them exactly once.
+ *
+ * \param[in] category the handle returned by bw::Debug::registerCategory()
+ * \param[in] level the debugging level
+ * \ingroup log
+ */
+#define BW_DEBUG_CATEGORY_ENABLED(category, level)                                  \
+    (static_cast<int>(level) >= BW_DEBUG_MIN_LEVEL &&                               \
+     bw::Debug::debug()->isEnabled(category, level))
+
+/**
+ * \brief Writes a debug message of a category
+ *
+ * Example:
+ *
+ * \code
+ * #include <libbw/log/debug.h>
+ *
+ * static const bw::Debug::Category netDebug = bw::Debug::debug()->registerCategory("net");
+ *
+ * BW_DEBUG_CATEGORY(netDebug, bw::Debug::DL_TRACE, "Received %d bytes", 5);
+ * \endcode
+ *
+ * \param[in] category the handle returned by bw::Debug::registerCategory()
+ * \param[in] level the debugging level
+ * \param[in] ... the format string and an arbitrary number of arguments.
+ * \ingroup log
+ */
+#define BW_DEBUG_CATEGORY(category, level, ...)                         \
+    do {                                                                \
+        const bw::Debug::Category _bwCategory = (category);             \
+        const bw::Debug::Level _bwLevel = (level);                      \
+        if (BW_DEBUG_CATEGORY_ENABLED(_bwCategory, _bwLevel))           \
+            bw::Debug::debug()->msg(_bwCategory, _bwLevel, __VA_ARGS__); \
+    } while (0)
+
+/**
+ * \brief Writes a debug message of a category using C++ streams
+ *
+ * \param[in] category the handle returned by bw::Debug::registerCategory()
+ * \param[in] level the debugging level
+ * \param[in] output some stream operations like shown in BW_DEBUG_STREAM().
+ * \ingroup log
+ */
+#define BW_DEBUG_CATEGORY_STREAM(category, level, output)               \
+    do {                                                                \
+        const bw::Debug::Category _bwCategory = (category);             \
+        const bw::Debug::Level _bwLevel = (level);                      \
+        if (BW_DEBUG_CATEGORY_ENABLED(_bwCategory, _bwLevel)) {         \
+            std::ostringstream _oss;                                    \
+            _oss << output;                                             \
+            bw::Debug::debug()->msg(_bwCategory, _bwLevel, _oss.str()); \
+        }                                                               \
+    } while (0)
 /* }}} */
 
 namespace bw {
 
+class DebugExitHandler;
+class BinaryLogWriter;
+class CrashRing;
+class OptionValue;
+struct DebugOutput;
+struct DebugCategories;
+
 /* Debugging {{{ */
 
 /**
@@ -216,6 +319,24 @@ namespace bw {
  * Currently the class supports only one debugging file handle, by default the
  * standard error console but that can also be a file. See setFileHandle().
  *
+ * By default, messages are written synchronously in the thread that calls the debug
+ * function. On platforms with thread support, setAsynchronous() moves the I/O to a
+ * background thread: the caller only formats the message and puts it into a lock-free
+ * ring buffer.
+ *
+ * To have context for post-mortem analysis without paying for the output of all messages,
+ * enableCrashRing() records every message in a per-thread in-memory ring that is only
+ * written on demand, on Errorlog::LS_EMERG and on fatal signals.
+ *
+ * Modules can register their own category with registerCategory() and use the
+ * BW_DEBUG_CATEGORY() macros. Each category has its own level, which can be set at runtime,
+ * from an environment variable or from a command line option (see configureCategories()).
+ *
+ * The instance can be created and used by several threads concurrently. The debug level,
+ * the file handle and the output mode may be changed while other threads are logging:
+ * checking the level costs one relaxed atomic load, and the debug functions never wait for
+ * setLevel(), setFileHandle(), setSynchronous() or setBinaryOutput().
+ *
  * \author Bernhard Walle <bernhard@bwalle.de>
  * \ingroup log
  */
@@ -236,6 +357,45 @@ public:
         DL_NONE     = 100           /**< no debugging at all, be silent */
     };
 
+    /**
+     * \brief Overflow policy for asynchronous mode
+     *
+     * Determines what happens if a message is logged while the ring buffer of the
+     * asynchronous mode is full. See setAsynchronous().
+     */
+    enum OverflowPolicy {
+        OP_DROP_NEWEST,             /**< discard the new message */
+        OP_DROP_OLDEST,             /**< discard the oldest message in the buffer */
+        OP_BLOCK                    /**< wait until the flusher thread made room */
+    };
+
+    /**
+     * \brief Maximum size of a message in asynchronous mode
+     *
+     * Longer messages (including the level prefix and the trailing newline) are truncated.
+     */
+    static const size_t AsyncRecordSize = 512;
+
+    /**
+     * \brief Handle of a debug category, see registerCategory()
+     */
+    typedef unsigned int Category;
+
+    /**
+     * \brief The category \c "default" that always exists
+     */
+    static const Category DefaultCategory = 0;
+
+    /**
+     * \brief Maximum number of categories including DefaultCategory
+     */
+    static const unsigned int MaxCategories = 64;
+
+    /**
+     * \brief Maximum length of a category name including the terminating NUL byte
+     */
+    static const size_t MaxCategoryNameLength = 32;
+
 public:
     /**
      * \brief Singleton getter
@@ -313,6 +473,40 @@ public:
     void vmsg(Debug::Level level, const char *msg, std::va_list args)
     BW_COMPILER_PRINTF_FORMAT(3, 0);
 
+    /**
+     * \brief Prints a debug message of a category
+     *
+     * The message is printed if \p level passes the level of \p category (see
+     * setCategoryLevel()). It's prefixed with the name of the category.
+     *
+     * \param[in] category the handle returned by registerCategory()
+     * \param[in] level the debug level (see Debug::Level)
+     * \param[in] msg the printf()-like format string for the message
+     */
+    void msg(Debug::Category category, Debug::Level level, const char *msg, ...)
+    BW_COMPILER_PRINTF_FORMAT(4, 5);
+
+    /**
+     * \brief Prints a debug message of a category without formatting
+     *
+     * \param[in] category the handle returned by registerCategory()
+     * \param[in] level the debug level (see Debug::Level)
+     * \param[in] buffer a string to print
+     */
+    void msg(Debug::Category category, Debug::Level level, const std::string &buffer);
+
+    /**
+     * \brief Prints a debug message of a category (vfprintf()-style)
+     *
+     * \param[in] category the handle returned by registerCategory()
+     * \param[in] level the debug level (see Debug::Level)
+     * \param[in] msg the printf()-like format string for the message
+     * \param[in] args the arguments to \p msg
+     */
+    void vmsg(Debug::Category category, Debug::Level level, const char *msg,
+              std::va_list args)
+    BW_COMPILER_PRINTF_FORMAT(4, 0);
+
     /**
      * \brief Set the debug level
      *
@@ -320,6 +514,9 @@ public:
      * of course, the same debug level) as \p level are printed and/or
      * logged to the file handle.
      *
+     * The function is async-signal-safe, so the level can be changed from a signal
+     * handler (e.g. for \c SIGUSR1) while other threads are logging.
+     *
      * \param[in] level the new debug level
      */
     void setLevel(Debug::Level level);
@@ -351,6 +548,130 @@ public:
      */
     bool isDebugEnabled() const;
 
+    /**
+     * \brief Checks if messages with \p level are printed
+     *
+     * This is what the BW_DEBUG macros check before the message arguments are evaluated.
+     *
+     * \param[in] level the debug level to check
+     * \return \c true if messages with \p level are printed or recorded in the crash ring
+     *         (see enableCrashRing()), \c false otherwise
+     */
+    bool isEnabled(Debug::Level level) const
+    {
+        return level >= BW_COMPILER_LOAD_RELAXED(m_threshold);
+    }
+
+    /**
+     * \brief Checks if messages of \p category with \p level are printed
+     *
+     * This is what the BW_DEBUG_CATEGORY macros check before the message arguments are
+     * evaluated.
+     *
+     * \param[in] category the handle returned by registerCategory()
+     * \param[in] level the debug level to check
+     * \return \c true if such messages are printed or recorded in the crash ring,
+     *         \c false otherwise
+     */
+    bool isEnabled(Debug::Category category, Debug::Level level) const
+    {
+        return level >= BW_COMPILER_LOAD_RELAXED(m_categoryThresholds[category]);
+    }
+
+    /**
+     * \brief Registers a debug category
+     *
+     * Categories allow enabling verbose output for one module without the output of all
+     * other modules. Registering a name that already exists returns the existing handle.
+     * Each category uses the global level (see setLevel()) until setCategoryLevel() is
+     * called for it.
+     *
+     * Thread-safe. Typically, each module registers its category once and keeps the handle
+     * in a static variable.
+     *
+     * \param[in] name the name of the category, truncated to MaxCategoryNameLength - 1
+     *            characters
+     * \return the handle, DefaultCategory if MaxCategories categories have already been
+     *         registered
+     */
+    Debug::Category registerCategory(const char *name);
+
+    /**
+     * \brief Returns the name of a category
+     *
+     * \param[in] category the handle returned by registerCategory()
+     * \return the name
+     */
+    const char *categoryName(Debug::Category category) const;
+
+    /**
+     * \brief Sets the level of a category
+     *
+     * Async-signal-safe.
+     *
+     * \param[in] category the handle returned by registerCategory()
+     * \param[in] level the new level of \p category, independent of the global level
+     */
+    void setCategoryLevel(Debug::Category category, Debug::Level level);
+
+    /**
+     * \brief Lets a category follow the global level again
+     *
+     * \param[in] category the handle returned by registerCategory()
+     */
+    void resetCategoryLevel(Debug::Category category);
+
+    /**
+     * \brief Returns the level of a category
+     *
+     * \param[in] category the handle returned by registerCategory()
+     * \return the level set with setCategoryLevel() or the global level
+     */
+    Debug::Level getCategoryLevel(Debug::Category category) const;
+
+    /**
+     * \brief Sets the levels of categories from a string
+     *
+     * \p spec is a comma-separated list of <tt>name=level</tt> pairs, for example
+     * <tt>"net=trace,db=debug,*=info"</tt>. The level is one of \c trace, \c debug,
+     * \c info and \c none or a number. The name \c * sets the global level. Categories
+     * that have not been registered yet are registered.
+     *
+     * \param[in] spec the specification
+     * \return \c true on success, \c false if \p spec contains invalid entries. The valid
+     *         entries are applied anyway.
+     */
+    bool configureCategories(const std::string &spec);
+
+    /**
+     * \brief Sets the levels of categories from an environment variable
+     *
+     * \param[in] variable the name of the environment variable whose value has the format
+     *            of configureCategories()
+     * \return \c true on success or if the variable is not set, \c false if its value is
+     *         invalid
+     */
+    bool configureCategoriesFromEnvironment(const char *variable="BW_DEBUG_CATEGORIES");
+
+    /**
+     * \brief Sets the levels of categories from a command line option
+     *
+     * Example:
+     *
+     * \code
+     * bw::OptionParser op;
+     * op.addOption("debug-categories", 'C', bw::OT_STRING, "Levels of debug categories");
+     * op.parse(argc, argv);
+     * bw::Debug::debug()->configureCategories(op.getValue("debug-categories"));
+     * \endcode
+     *
+     * \param[in] value the value of an option of type OT_STRING, in the format of
+     *            configureCategories()
+     * \return \c true on success or if the option has not been given, \c false if its value
+     *         is invalid
+     */
+    bool configureCategories(const OptionValue &value);
+
     /**
      * \brief Set the file handle for output
      *
@@ -359,6 +680,11 @@ public:
      * Debug to see an example how that function can be used to write to a
      * file.
      *
+     * The new handle is published atomically, and the function waits until no other
+     * thread writes to the previous handle anymore. So the previous handle may be closed
+     * after the function returns. Messages that are pending in asynchronous mode are
+     * written to the new handle.
+     *
      * \param[in] handle the file handle
      */
     void setFileHandle(FILE *handle);
@@ -373,15 +699,175 @@ public:
      */
     FILE *getFileHandle() const;
 
+    /**
+     * \brief Switches to asynchronous output
+     *
+     * After calling this function, the debug functions only format the message and put it
+     * into a lock-free ring buffer of \p capacity entries. A background thread writes the
+     * messages to the file handle. Messages are written in the order in which they entered
+     * the buffer.
+     *
+     * Pending messages are written when setSynchronous() is called and on regular program
+     * termination with std::exit().
+     *
+     * \param[in] capacity the number of messages the ring buffer can hold
+     * \param[in] policy what to do if the ring buffer is full
+     * \return \c true on success, \c false if threads are not supported on the platform
+     *         or the thread could not be started. In that case, the output stays
+     *         synchronous.
+     */
+    bool setAsynchronous(size_t capacity = 4096, OverflowPolicy policy = OP_DROP_NEWEST);
+
+    /**
+     * \brief Switches back to synchronous output
+     *
+     * Writes all pending messages and stops the background thread. Does nothing if
+     * asynchronous output has not been enabled.
+     */
+    void setSynchronous();
+
+    /**
+     * \brief Checks if asynchronous output is enabled
+     *
+     * \return \c true if setAsynchronous() has been called successfully, \c false
+     *         otherwise
+     */
+    bool isAsynchronous() const;
+
+    /**
+     * \brief Returns the number of messages that have been dropped
+     *
+     * Messages are only dropped in asynchronous mode with the overflow policies
+     * OP_DROP_NEWEST and OP_DROP_OLDEST.
+     *
+     * \return the number of dropped messages since asynchronous mode has been enabled
+     */
+    unsigned long droppedMessages() const;
+
+    /**
+     * \brief Waits until all pending messages have been written
+     *
+     * In synchronous mode, this just flushes the file handle.
+     */
+    void flush();
+
+    /**
+     * \brief Switches to binary output
+     *
+     * After calling this function, debug messages are no longer formatted. Instead, they
+     * are written to \p filename in the binary format of BinaryLogWriter, which is much
+     * cheaper. The file handle and the asynchronous mode are not used for binary output.
+     * Use BinaryLogReader or the \c binlogdecode example to read the file.
+     *
+     * The format strings should be string literals. Format strings that are built at
+     * runtime are written correctly, but cost more, see BinaryLogWriter.
+     *
+     * Pending messages are written by flush() and on regular program termination with
+     * std::exit().
+     *
+     * \param[in] filename the name of the binary log file, or \c NULL to switch back to
+     *            text output
+     * \return \c true on success, \c false if the file cannot be opened. In that case,
+     *         the output is text.
+     */
+    bool setBinaryOutput(const char *filename);
+
+    /**
+     * \brief Checks if binary output is enabled
+     *
+     * \return \c true if setBinaryOutput() has been called successfully with a file name
+     */
+    bool isBinary() const;
+
+    /**
+     * \brief Records all messages in an in-memory crash ring
+     *
+     * After calling this function, messages of all levels are formatted into a per-thread
+     * ring of \p capacity records (see CrashRing), independent of the debug level. Only
+     * messages that pass the debug level are also written to the normal output. The ring
+     * itself is written by dumpCrashRing(), which happens automatically when an
+     * Errorlog::LS_EMERG message is logged and, after installCrashHandler(), when the
+     * program crashes.
+     *
+     * The ring is created by the first call. Later calls only enable recording again and
+     * change the dump file, \p capacity and \p recordSize are ignored. The ring is never
+     * freed since threads and signal handlers may still access it.
+     *
+     * Only available on platforms with thread support.
+     *
+     * \param[in] dumpFile the file that dumpCrashRing() appends to, \c NULL means
+     *            \c stderr
+     * \param[in] capacity the number of records per thread
+     * \param[in] recordSize the maximum size of one record, longer messages are truncated
+     * \return \c true on success, \c false if threads are not supported on the platform
+     */
+    bool enableCrashRing(const char *dumpFile=NULL, size_t capacity=256,
+                         size_t recordSize=256);
+
+    /**
+     * \brief Stops recording messages in the crash ring
+     *
+     * The records are kept and can still be dumped.
+     */
+    void disableCrashRing();
+
+    /**
+     * \brief Checks if messages are recorded in the crash ring
+     *
+     * \return \c true if enableCrashRing() has been called successfully and
+     *         disableCrashRing() has not been called afterwards
+     */
+    bool isCrashRingEnabled() const;
+
+    /**
+     * \brief Writes the crash ring to the dump file
+     *
+     * The dump file is the one that has been passed to enableCrashRing(). Does nothing if
+     * no crash ring has been created.
+     */
+    void dumpCrashRing();
+
+    /**
+     * \brief Writes the crash ring to a file descriptor
+     *
+     * Async-signal-safe. Does nothing if no crash ring has been created.
+     *
+     * \param[in] fd the file descriptor
+     */
+    void dumpCrashRing(int fd);
+
+    /**
+     * \brief Dumps the crash ring when the program crashes
+     *
+     * Installs a handler for \c SIGSEGV, \c SIGBUS, \c SIGILL, \c SIGFPE and \c SIGABRT
+     * that calls dumpCrashRing() and then raises the signal again with the default action,
+     * so a core dump is still created. Previously installed handlers for these signals are
+     * replaced.
+     *
+     * \return \c true on success, \c false if the platform doesn't support it
+     */
+    bool installCrashHandler();
+
 protected:
     Debug();
 
 private:
-    static Debug *m_instance;
+    void updateThreshold();
+    void output(Debug::Level level, Debug::Level outputLevel, const char *category,
+                const char *msg, std::va_list args);
 
 private:
     Level m_debuglevel;
-    FILE *m_handle;
+    Level m_threshold;
+    Level m_categoryThresholds[MaxCategories];
+    int m_categoryLevels[MaxCategories];        // -1 to follow m_debuglevel
+    DebugCategories *m_categories;
+    DebugOutput *m_output;
+    DebugExitHandler *m_exitHandler;
+    CrashRing *m_crashRing;
+    bool m_crashRingEnabled;
+
+    friend class DebugExitHandler;
 };
 
 /* }}} */
@@ -25,20 +25,55 @@
  * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
  */
 #include <cstdarg>
+#include <cstdio>
+#include <cstring>
+#include <string>
 
 #include "bwconfig.h"
 #include "errorlog.h"
+#include "ratelimiter.h"
 #include "fileerrorlog.h"
+#include "binaryerrorlog.h"
+#include "multierrorlog.h"
+#include "debug.h"
 #ifdef HAVE_SYSLOG
 #  include "syserrorlog.h"
 #endif
+#ifdef HAVE_THREADS
+#  include "batchedfileerrorlog.h"
+#  include "rotatingfileerrorlog.h"
+#endif
 
 namespace bw {
 
 /* Errorlog {{{ */
 
+/**
+ * \brief Calls Errorlog::vlog() with a variable argument list
+ */
+static void callVlog(Errorlog *errorlog, Errorlog::Level level, const char *msg, ...)
+BW_COMPILER_PRINTF_FORMAT(3, 4);
+
+static void callVlog(Errorlog *errorlog, Errorlog::Level level, const char *msg, ...)
+{
+    va_list valist;
+
+    va_start(valist, msg);
+    errorlog->vlog(level, msg, valist);
+    va_end(valist);
+}
+
 Errorlog *Errorlog::m_instance;
 
+Errorlog::Errorlog()
+    : m_rateLimiter(NULL)
+{}
+
+Errorlog::~Errorlog()
+{
+    delete m_rateLimiter;
+}
+
 const char *Errorlog::levelToString(enum Errorlog::Level level)
 {
     switch (level) {
@@ -57,6 +92,31 @@ const char *Errorlog::levelToString(enum Errorlog::Level level)
     }
 }
 
+size_t Errorlog::formatRecord(char *buffer, size_t size, const char *timestamp,
+                              Errorlog::Level level, const char *msg, std::va_list args,
+                              size_t *required)
+{
+    int prefix = std::snprintf(buffer, size, "%s [%-10.10s] ", timestamp, levelToString(level));
+    if (prefix < 0 || size_t(prefix) >= size) {
+        *required = prefix < 0 ? 0 : prefix + 1;
+        return 0;
+    }
+
+    int ret = vsnprintf(buffer + prefix, size - prefix, msg, args);
+    if (ret < 0) {
+        *required = 0;
+        return 0;
+    }
+
+    // the NUL byte written by vsnprintf() is replaced by the newline
+    *required = prefix + ret + 1;
+    if (*required > size)
+        return 0;
+
+    buffer[prefix + ret] = '\n';
+    return prefix + ret + 1;
+}
+
 bool Errorlog::configure(enum LogMethod method, const char *option)
 {
     if (m_instance) {
@@ -74,6 +134,34 @@ bool Errorlog::configure(enum LogMethod method, const char *option)
         m_instance = new SysErrorlog(option);
         break;
 #endif
+
+    case LM_BATCHED_FILE:
+#ifdef HAVE_THREADS
+        m_instance = new BatchedFileErrorlog(option);
+#else
+        m_instance = new FileErrorlog(option);
+#endif
+        break;
+
+    case LM_BINARY:
+        m_instance = new BinaryErrorlog(option);
+        break;
+
+    case LM_ROTATING_FILE:
+#ifdef HAVE_THREADS
+        m_instance = new RotatingFileErrorlog(option);
+#else
+        m_instance = new FileErrorlog(
+            option ? std::string(option).substr(0, std::strcspn(option, ";")).c_str() : NULL);
+#endif
+        break;
+
+    case LM_MULTI:
+        m_instance = new MultiErrorlog();
+        break;
+
+    default:
+        break;
     }
 
     return m_instance != NULL;
@@ -89,7 +177,7 @@ void Errorlog::emerg(const char *msg, ...)
     va_list valist;
 
     va_start(valist, msg);
-    vlog(LS_EMERG, msg, valist);
+    dispatch(LS_EMERG, msg, valist);
     va_end(valist);
 }
 
@@ -98,7 +186,7 @@ void Errorlog::alert(const char *msg, ...)
     va_list valist;
 
     va_start(valist, msg);
-    vlog(LS_ALERT, msg, valist);
+    dispatch(LS_ALERT, msg, valist);
     va_end(valist);
 }
 
@@ -107,7 +195,7 @@ void Errorlog::crit(const char *msg, ...)
     va_list valist;
 
     va_start(valist, msg);
-    vlog(LS_CRIT, msg, valist);
+    dispatch(LS_CRIT, msg, valist);
     va_end(valist);
 }
 
@@ -116,7 +204,7 @@ void Errorlog::err(const char *msg, ...)
     va_list valist;
 
     va_start(valist, msg);
-    vlog(LS_ERR, msg, valist);
+    dispatch(LS_ERR, msg, valist);
     va_end(valist);
 }
 
@@ -125,7 +213,7 @@ void Errorlog::warning(const char *msg, ...)
     va_list valist;
 
     va_start(valist, msg);
-    vlog(LS_WARNING, msg, valist);
+    dispatch(LS_WARNING, msg, valist);
     va_end(valist);
 }
 
@@ -134,10 +222,52 @@ void Errorlog::log(Errorlog::Level level, const char *msg, ...)
     va_list valist;
 
     va_start(valist, msg);
-    vlog(level, msg, valist);
+    dispatch(level, msg, valist);
     va_end(valist);
 }
 
+void Errorlog::setRateLimit(unsigned int burst, unsigned int rate)
+{
+    delete m_rateLimiter;
+    m_rateLimiter = burst > 0 ? new RateLimiter(burst, rate) : NULL;
+}
+
+void Errorlog::reportSuppressed()
+{
+    if (!m_rateLimiter)
+        return;
+
+    unsigned int index = 0;
+    const void *key;
+    int level;
+    unsigned long count;
+
+    while (m_rateLimiter->takeSuppressed(&index, &key, &level, &count))
+        logSuppressed(static_cast<Level>(level), count, static_cast<const char *>(key));
+}
+
+void Errorlog::dispatch(Errorlog::Level level, const char *msg, std::va_list args)
+{
+    if (m_rateLimiter && level > LS_ALERT) {
+        unsigned long suppressed;
+        if (!m_rateLimiter->admit(msg, level, &suppressed))
+            return;
+        if (suppressed > 0)
+            logSuppressed(level, suppressed, msg);
+    }
+
+    vlog(level, msg, args);
+
+    // give post-mortem context for the panic
+    if (level == LS_EMERG)
+        Debug::debug()->dumpCrashRing();
+}
+
+void Errorlog::logSuppressed(Errorlog::Level level, unsigned long count, const char *msg)
+{
+    callVlog(this, level, "%lu similar messages suppressed: \"%s\"", count, msg);
+}
+
 /* }}} */
 
 } // end namespace bw
@@ -263,6 +263,8 @@
 
 namespace bw {
 
+class RateLimiter;
+
 /* Errorlog {{{ */
 
 /**
@@ -291,6 +293,9 @@ namespace bw {
  * platforms that have a pthread implementation which includes Linux, Mac OS and BSDs)
  * the error logging is thread safe, i.e. lines don't get mixed.
  *
+ * To protect the application against floods of identical errors, setRateLimit() enables a
+ * token bucket per call site. Suppressed messages are reported as one summary line.
+ *
  * \author Bernhard Walle <bernhard@bwalle.de>
  * \ingroup log
  */
@@ -302,7 +307,15 @@ public:
      */
     enum LogMethod {
         LM_FILE,            /**< logging to a C FILE object */
-        LM_SYSLOG           /**< logging to syslog on Unix */
+        LM_SYSLOG,          /**< logging to syslog on Unix */
+        LM_BATCHED_FILE,    /**< logging to a file, written in batches by a background
+                                 thread (see BatchedFileErrorlog) */
+        LM_BINARY,          /**< logging to a file in the binary format of
+                                 BinaryLogWriter */
+        LM_ROTATING_FILE,   /**< logging to a file that is rotated by size or time
+                                 (see RotatingFileErrorlog) */
+        LM_MULTI            /**< logging to several sinks with individual levels
+                                 (see MultiErrorlog) */
     };
 
     /**
@@ -317,8 +330,21 @@ public:
      * If \p method is LM_SYSLOG, then \p option is the \c ident parameter for openlog(). Please
      * note that LM_SYSLOG is only available on Unix.
      *
-     * \param[in] method the log method which can be LM_FILE on all operating systems and
-     *            LM_SYSLOG on Unix.
+     * If \p method is LM_BATCHED_FILE, then \p option has the same meaning as for LM_FILE.
+     * On platforms without thread support, LM_BATCHED_FILE behaves like LM_FILE.
+     *
+     * If \p method is LM_BINARY, then \p option is the name of the log file.
+     *
+     * If \p method is LM_ROTATING_FILE, then \p option is the name of the log file,
+     * optionally followed by rotation settings as described in RotatingFileErrorlog. On
+     * platforms without thread support, LM_ROTATING_FILE behaves like LM_FILE with the
+     * settings removed.
+     *
+     * If \p method is LM_MULTI, then \p option is ignored. The sinks have to be added to the
+     * MultiErrorlog afterwards, see there for an example.
+     *
+     * \param[in] method the log method which can be LM_FILE, LM_BATCHED_FILE, LM_BINARY,
+     *            LM_ROTATING_FILE or LM_MULTI on all operating systems and LM_SYSLOG on Unix.
      * \param[in] option the option argument as described above.
      * \return \c true on success and \c false on failure. The only failure cause can be calling
      *         configure() with LM_SYSLOG on Windows.
@@ -338,7 +364,7 @@ public:
     /**
      * \brief D'tor
      */
-    virtual ~Errorlog() {}
+    virtual ~Errorlog();
 
 public:
     /**
@@ -442,8 +468,71 @@ public:
      */
     void log(Errorlog::Level level, const std::string msg);
 
+    /**
+     * \brief Limits the number of messages per call site
+     *
+     * Each call site, identified by the address of its format string, may emit \p burst
+     * messages at once and \p rate messages per second in the long run. Further messages
+     * are dropped and counted. The next message of the call site that passes is preceded by
+     * a line <tt>"N similar messages suppressed"</tt>.
+     *
+     * Messages of the levels LS_EMERG and LS_ALERT are never dropped. Since all
+     * BW_ERROR_STREAM() invocations share the format string <tt>"%s"</tt>, they also share
+     * a bucket.
+     *
+     * Rate limiting applies to emerg(), alert(), crit(), err(), warning(), log() and the
+     * BW_ERROR macros, but not to direct calls of vlog(). Call that function before logging
+     * starts, not concurrently with logging threads.
+     *
+     * \param[in] burst the number of messages that may pass at once, 0 disables rate
+     *            limiting (the default)
+     * \param[in] rate the number of messages per second that may pass in the long run
+     */
+    void setRateLimit(unsigned int burst, unsigned int rate);
+
+    /**
+     * \brief Logs the summaries of suppressed messages
+     *
+     * Normally, suppressed messages are reported when the next message of the same call
+     * site passes. Call this function periodically or before program termination to report
+     * call sites that stopped logging.
+     */
+    void reportSuppressed();
+
+protected:
+    /**
+     * \brief Constructor
+     */
+    Errorlog();
+
+    /**
+     * \brief Formats a complete record including timestamp and trailing newline
+     *
+     * Helper for subclasses that write text records. The record looks like
+     * <tt>"<timestamp> [WARNING   ] <message>\\n"</tt>.
+     *
+     * \param[out] buffer the output buffer
+     * \param[in] size the size of \p buffer
+     * \param[in] timestamp the formatted time of the record
+     * \param[in] level the error level
+     * \param[in] msg the printf()-like format string
+     * \param[in] args the arguments for \p msg
+     * \param[out] required the buffer size that is needed for the complete record. If that's
+     *             larger than \p size, the return value is 0 and nothing useful has been
+     *             written to \p buffer.
+     * \return the length of the record (not NUL-terminated)
+     */
+    static size_t formatRecord(char *buffer, size_t size, const char *timestamp,
+                               Errorlog::Level level, const char *msg, std::va_list args,
+                               size_t *required);
+
+private:
+    void dispatch(Errorlog::Level level, const char *msg, std::va_list args);
+    void logSuppressed(Errorlog::Level level, unsigned long count, const char *msg);
+
 private:
     static Errorlog *m_instance;
+    RateLimiter *m_rateLimiter;
 };
 
 /* }}} */
@@ -0,0 +1,78 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_ERRORLOGSINK_H_
+#define LIBBW_LOG_ERRORLOGSINK_H_
+
+#include <cstddef>
+
+#include <libbw/noncopyable.h>
+#include "errorlog.h"
+
+namespace bw {
+
+/* ErrorlogSink {{{ */
+
+/**
+ * \class ErrorlogSink errorlogsink.h libbw/log/errorlogsink.h
+ * \brief Destination of MultiErrorlog
+ *
+ * Unlike Errorlog subclasses, a sink receives the message already formatted, so that
+ * MultiErrorlog only needs to format each message once for all sinks.
+ *
+ * Implementations must be thread-safe.
+ *
+ * \ingroup log
+ */
+class ErrorlogSink : private Noncopyable {
+
+public:
+    /**
+     * \brief Destructor
+     */
+    virtual ~ErrorlogSink() {}
+
+public:
+    /**
+     * \brief Writes one message
+     *
+     * \param[in] level the error level
+     * \param[in] timestamp the formatted time of the message (see TimestampCache)
+     * \param[in] message the formatted message without trailing newline. It's
+     *            NUL-terminated.
+     * \param[in] length the length of \p message
+     */
+    virtual void write(Errorlog::Level level, const char *timestamp, const char *message,
+                       size_t length) = 0;
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_ERRORLOGSINK_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
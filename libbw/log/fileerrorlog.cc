@@ -30,7 +30,6 @@
 
 #include "fileerrorlog.h"
 #include "bwconfig.h"
-#include "datetime.h"
 #ifdef HAVE_THREADS
 #  include <thread/mutexlocker.h>
 #endif
@@ -65,10 +64,13 @@ FileErrorlog::~FileErrorlog()
 
 void FileErrorlog::vlog(Errorlog::Level level, const char *msg, std::va_list args)
 {
+    char timestamp[TimestampCache::MaxLength];
+    m_timestamps.format(timestamp, sizeof(timestamp));
+
 #ifdef HAVE_THREADS
     thread::MutexLocker locker(&m_mutex);
 #endif
-    fprintf(m_file, "%s [%-10.10s] ", bw::Datetime::now().str().c_str(), levelToString(level));
+    fprintf(m_file, "%s [%-10.10s] ", timestamp, levelToString(level));
     vfprintf(m_file, msg, args);
     fprintf(m_file, "\n");
     fflush(m_file);
@@ -31,6 +31,7 @@
 #include <string>
 
 #include "errorlog.h"
+#include "timestampcache.h"
 #include "bwconfig.h"
 #ifdef HAVE_THREADS
 #  include <thread/mutex.h>
@@ -76,6 +77,7 @@ protected:
 private:
     std::FILE *m_file;
     bool m_closeInDtor;
+    TimestampCache m_timestamps;
 #ifdef HAVE_THREADS
     thread::Mutex m_mutex;
 #endif
@@ -0,0 +1,138 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstring>
+
+#include "messagering.h"
+
+namespace bw {
+
+/* MessageRing {{{ */
+
+MessageRing::MessageRing(size_t capacity, size_t slotSize)
+    : m_slotSize(slotSize)
+{
+    size_t size = 2;
+    while (size < capacity)
+        size <<= 1;
+    m_mask = size - 1;
+
+    m_slots = new Slot[size];
+    m_data = new char[size * slotSize];
+    for (size_t i = 0; i < size; ++i) {
+        m_slots[i].sequence.store(i, thread::MO_RELAXED);
+        m_slots[i].length = 0;
+    }
+}
+
+MessageRing::~MessageRing()
+{
+    delete[] m_slots;
+    delete[] m_data;
+}
+
+bool MessageRing::push(const char *data, size_t length)
+{
+    size_t pos = m_enqueuePos.load(thread::MO_RELAXED);
+    Slot *slot;
+
+    for (;;) {
+        slot = &m_slots[pos & m_mask];
+        size_t seq = slot->sequence.load(thread::MO_ACQUIRE);
+        long diff = long(seq) - long(pos);
+
+        if (diff == 0) {
+            if (m_enqueuePos.compareExchange(pos, pos + 1, thread::MO_RELAXED))
+                break;
+        } else if (diff < 0)
+            return false;
+        else
+            pos = m_enqueuePos.load(thread::MO_RELAXED);
+    }
+
+    if (length > m_slotSize)
+        length = m_slotSize;
+    std::memcpy(m_data + (pos & m_mask) * m_slotSize, data, length);
+    slot->length = length;
+    slot->sequence.store(pos + 1, thread::MO_RELEASE);
+
+    return true;
+}
+
+bool MessageRing::pop(char *buffer, size_t *length)
+{
+    size_t pos = m_dequeuePos.load(thread::MO_RELAXED);
+    Slot *slot;
+
+    for (;;) {
+        slot = &m_slots[pos & m_mask];
+        size_t seq = slot->sequence.load(thread::MO_ACQUIRE);
+        long diff = long(seq) - long(pos + 1);
+
+        if (diff == 0) {
+            if (m_dequeuePos.compareExchange(pos, pos + 1, thread::MO_RELAXED))
+                break;
+        } else if (diff < 0)
+            return false;
+        else
+            pos = m_dequeuePos.load(thread::MO_RELAXED);
+    }
+
+    if (buffer)
+        std::memcpy(buffer, m_data + (pos & m_mask) * m_slotSize, slot->length);
+    if (length)
+        *length = slot->length;
+    slot->sequence.store(pos + m_mask + 1, thread::MO_RELEASE);
+
+    return true;
+}
+
+bool MessageRing::empty() const
+{
+    size_t pos = m_dequeuePos.load(thread::MO_RELAXED);
+    const Slot *slot = &m_slots[pos & m_mask];
+
+    return slot->sequence.load(thread::MO_ACQUIRE) != pos + 1;
+}
+
+size_t MessageRing::pushed() const
+{
+    return m_enqueuePos.load(thread::MO_ACQUIRE);
+}
+
+size_t MessageRing::capacity() const
+{
+    return m_mask + 1;
+}
+
+size_t MessageRing::slotSize() const
+{
+    return m_slotSize;
+}
+
+/* }}} */
+
+} // end namespace bw
@@ -0,0 +1,148 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_MESSAGERING_H_
+#define LIBBW_LOG_MESSAGERING_H_
+
+#include <cstddef>
+
+#include <libbw/noncopyable.h>
+#include <libbw/thread/atomic.h>
+
+namespace bw {
+
+/* MessageRing {{{ */
+
+/**
+ * \class MessageRing messagering.h libbw/log/messagering.h
+ * \brief Bounded lock-free queue of preformatted log records
+ *
+ * The ring consists of a fixed number of fixed-size slots. Each slot carries a sequence
+ * number that tells producers and consumers whether the slot is free or filled, so neither
+ * push() nor pop() takes a lock (the algorithm is the bounded MPMC queue by Dmitry Vyukov).
+ *
+ * The ring is used by Debug with many producers and a single flusher thread as consumer.
+ * Producers may also call pop() themselves to discard the oldest record when the ring is
+ * full.
+ *
+ * \ingroup log
+ */
+class MessageRing : private Noncopyable {
+
+public:
+    /**
+     * \brief Creates a new ring
+     *
+     * \param[in] capacity the number of slots. The value is rounded up to the next power of
+     *            two.
+     * \param[in] slotSize the maximum size of a single record in bytes
+     */
+    MessageRing(size_t capacity, size_t slotSize);
+
+    /**
+     * \brief Destructor
+     */
+    ~MessageRing();
+
+public:
+    /**
+     * \brief Appends a record
+     *
+     * If \p length exceeds slotSize(), the record is truncated.
+     *
+     * \param[in] data the record
+     * \param[in] length the length of \p data in bytes
+     * \return \c true on success, \c false if the ring is full
+     */
+    bool push(const char *data, size_t length);
+
+    /**
+     * \brief Removes the oldest record
+     *
+     * \param[out] buffer the buffer where the record is copied to. It must be at least
+     *             slotSize() bytes large. Passing \c NULL just discards the record.
+     * \param[out] length the length of the record, may be \c NULL
+     * \return \c true on success, \c false if the ring is empty
+     */
+    bool pop(char *buffer, size_t *length);
+
+    /**
+     * \brief Checks if the ring contains records
+     *
+     * The result is only a snapshot if other threads access the ring concurrently.
+     *
+     * \return \c true if the ring is empty, \c false otherwise
+     */
+    bool empty() const;
+
+    /**
+     * \brief Returns the number of records that have been pushed successfully
+     *
+     * \return the number of records pushed since construction
+     */
+    size_t pushed() const;
+
+    /**
+     * \brief Returns the number of slots
+     *
+     * \return the capacity which is always a power of two
+     */
+    size_t capacity() const;
+
+    /**
+     * \brief Returns the maximum size of a single record
+     *
+     * \return the slot size in bytes
+     */
+    size_t slotSize() const;
+
+private:
+    struct Slot {
+        thread::Atomic<size_t> sequence;
+        size_t length;
+    };
+
+    // keep producer and consumer positions on different cache lines
+    enum { CacheLineSize = 64 };
+
+    Slot *m_slots;
+    char *m_data;
+    size_t m_mask;
+    size_t m_slotSize;
+    char m_pad0[CacheLineSize];
+    thread::Atomic<size_t> m_enqueuePos;
+    char m_pad1[CacheLineSize];
+    thread::Atomic<size_t> m_dequeuePos;
+    char m_pad2[CacheLineSize];
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_MESSAGERING_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,115 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdio>
+
+#include "multierrorlog.h"
+
+namespace bw {
+
+/* MultiErrorlog {{{ */
+
+MultiErrorlog::MultiErrorlog()
+    : m_maxThreshold(-1)
+{}
+
+MultiErrorlog::~MultiErrorlog()
+{
+    for (size_t i = 0; i < m_sinks.size(); ++i)
+        delete m_sinks[i].sink;
+}
+
+void MultiErrorlog::addSink(ErrorlogSink *sink, Errorlog::Level threshold)
+{
+    if (!sink)
+        return;
+
+    Entry entry;
+    entry.sink = sink;
+    entry.threshold = threshold;
+    m_sinks.push_back(entry);
+
+    updateMaxThreshold();
+}
+
+void MultiErrorlog::setThreshold(ErrorlogSink *sink, Errorlog::Level threshold)
+{
+    for (size_t i = 0; i < m_sinks.size(); ++i)
+        if (m_sinks[i].sink == sink)
+            BW_COMPILER_STORE_RELAXED(m_sinks[i].threshold, threshold);
+
+    updateMaxThreshold();
+}
+
+void MultiErrorlog::vlog(Errorlog::Level level, const char *msg, std::va_list args)
+{
+    // nobody is interested, so don't waste time formatting
+    if (static_cast<int>(level) > BW_COMPILER_LOAD_RELAXED(m_maxThreshold))
+        return;
+
+    char timestamp[TimestampCache::MaxLength];
+    char stackMessage[1024];
+    char *message = stackMessage;
+
+    m_timestamps.format(timestamp, sizeof(timestamp));
+
+    std::va_list argsCopy;
+    BW_COMPILER_VA_COPY(argsCopy, args);
+    int ret = std::vsnprintf(stackMessage, sizeof(stackMessage), msg, args);
+    if (ret < 0) {
+        ret = 0;
+        stackMessage[0] = '\0';
+    } else if (static_cast<size_t>(ret) >= sizeof(stackMessage)) {
+        message = new char[ret + 1];
+        std::vsnprintf(message, ret + 1, msg, argsCopy);
+    }
+    va_end(argsCopy);
+
+    size_t length = static_cast<size_t>(ret);
+
+    for (size_t i = 0; i < m_sinks.size(); ++i)
+        if (level <= BW_COMPILER_LOAD_RELAXED(m_sinks[i].threshold))
+            m_sinks[i].sink->write(level, timestamp, message, length);
+
+    if (message != stackMessage)
+        delete[] message;
+}
+
+void MultiErrorlog::updateMaxThreshold()
+{
+    int maxThreshold = -1;
+    for (size_t i = 0; i < m_sinks.size(); ++i) {
+        int threshold = BW_COMPILER_LOAD_RELAXED(m_sinks[i].threshold);
+        if (threshold > maxThreshold)
+            maxThreshold = threshold;
+    }
+
+    BW_COMPILER_STORE_RELAXED(m_maxThreshold, maxThreshold);
+}
+
+/* }}} */
+
+} // end namespace bw
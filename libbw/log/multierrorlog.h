@@ -0,0 +1,128 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_MULTIERRORLOG_H_
+#define LIBBW_LOG_MULTIERRORLOG_H_
+
+#include <vector>
+
+#include "errorlog.h"
+#include "errorlogsink.h"
+#include "timestampcache.h"
+
+namespace bw {
+
+/* MultiErrorlog {{{ */
+
+/**
+ * \brief Error log implementation that dispatches to several sinks
+ *
+ * Each sink has its own threshold: it receives all messages whose level is at least as
+ * severe as the threshold. The message is formatted only once for all sinks, and not at
+ * all if no sink accepts its level.
+ *
+ * Use Errorlog::configure() with Errorlog::LM_MULTI to create an instance and add the
+ * sinks before logging starts:
+ *
+ * \code
+ * bw::Errorlog::configure(bw::Errorlog::LM_MULTI);
+ * bw::MultiErrorlog *log = dynamic_cast<bw::MultiErrorlog *>(bw::Errorlog::instance());
+ * log->addSink(new bw::FileErrorlogSink("stderr"), bw::Errorlog::LS_ERR);
+ * log->addSink(new bw::FileErrorlogSink("/var/log/foo.log"), bw::Errorlog::LS_WARNING);
+ * \endcode
+ *
+ * \ingroup log
+ */
+class MultiErrorlog : public Errorlog {
+
+public:
+    /// Let Errorlog create instances of MultiErrorlog, and only Errorlog.
+    friend class Errorlog;
+
+public:
+    /**
+     * \brief Adds a sink
+     *
+     * Not thread-safe: add all sinks before any thread starts logging.
+     *
+     * \param[in] sink the sink, MultiErrorlog takes the ownership
+     * \param[in] threshold the least severe level that \p sink receives. LS_WARNING
+     *            means all messages, LS_EMERG only panic messages.
+     */
+    void addSink(ErrorlogSink *sink, Errorlog::Level threshold=LS_WARNING);
+
+    /**
+     * \brief Changes the threshold of a sink
+     *
+     * May be called while other threads are logging. Concurrent calls of setThreshold()
+     * must be serialized by the caller.
+     *
+     * \param[in] sink a sink that has been added with addSink()
+     * \param[in] threshold the new threshold
+     */
+    void setThreshold(ErrorlogSink *sink, Errorlog::Level threshold);
+
+protected:
+    /**
+     * \brief Creates a new MultiErrorlog without sinks.
+     *
+     * Don't use that function directly. Instead, use Errorlog::configure().
+     */
+    MultiErrorlog();
+
+    /**
+     * \brief Destructor
+     *
+     * Deletes all sinks.
+     */
+    ~MultiErrorlog();
+
+    /**
+     * \copydoc Errorlog::vlog()
+     */
+    void vlog(Errorlog::Level level, const char *msg, std::va_list args);
+
+private:
+    void updateMaxThreshold();
+
+private:
+    struct Entry {
+        ErrorlogSink    *sink;
+        Errorlog::Level threshold;
+    };
+
+    std::vector<Entry>  m_sinks;
+    int                 m_maxThreshold;     // -1 if there are no sinks
+    TimestampCache      m_timestamps;
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_MULTIERRORLOG_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
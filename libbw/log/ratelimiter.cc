@@ -0,0 +1,203 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstddef>
+
+#include "bwconfig.h"
+#include "ratelimiter.h"
+#include "sysutil.h"
+#ifdef HAVE_THREADS
+#  include <thread/atomic.h>
+#endif
+
+namespace bw {
+
+/* Helper functions {{{ */
+
+#ifndef HAVE_THREADS
+
+/**
+ * \brief Replacement for thread::Atomic on platforms without threads
+ */
+template <typename T>
+class PlainValue {
+
+public:
+    PlainValue()
+        : m_value(T())
+    {}
+
+    T load() const
+    {
+        return m_value;
+    }
+
+    void store(T value)
+    {
+        m_value = value;
+    }
+
+    T exchange(T value)
+    {
+        T old = m_value;
+        m_value = value;
+        return old;
+    }
+
+    bool compareExchange(T &expected, T desired)
+    {
+        if (m_value != expected) {
+            expected = m_value;
+            return false;
+        }
+        m_value = desired;
+        return true;
+    }
+
+    T fetchAdd(T value)
+    {
+        T old = m_value;
+        m_value += value;
+        return old;
+    }
+
+private:
+    T m_value;
+};
+
+#endif /* HAVE_THREADS */
+
+/* }}} */
+/* RateLimiterSlot {{{ */
+
+/**
+ * \brief Token bucket of one call site
+ *
+ * The bucket is implemented as generic cell rate algorithm: instead of the number of
+ * tokens, only the theoretical arrival time of the next message is stored, which can be
+ * updated with a single compare-and-swap.
+ */
+struct RateLimiterSlot {
+#ifdef HAVE_THREADS
+    thread::Atomic<const void *>    key;
+    thread::Atomic<long long>       arrival;
+    thread::Atomic<unsigned long>   suppressed;
+    thread::Atomic<int>             level;
+#else
+    PlainValue<const void *>        key;
+    PlainValue<long long>           arrival;
+    PlainValue<unsigned long>       suppressed;
+    PlainValue<int>                 level;
+#endif
+};
+
+static const unsigned int RateLimiterSlots = 1024;
+
+/* }}} */
+/* RateLimiter {{{ */
+
+RateLimiter::RateLimiter(unsigned int burst, unsigned int rate)
+    : m_interval(1000000 / (rate > 0 ? rate : 1))
+    , m_tolerance(m_interval * (burst > 0 ? burst - 1 : 0))
+    , m_slots(new RateLimiterSlot[RateLimiterSlots])
+{}
+
+RateLimiter::~RateLimiter()
+{
+    delete[] m_slots;
+}
+
+bool RateLimiter::admit(const void *key, int level, unsigned long *suppressed)
+{
+    RateLimiterSlot *slot = findSlot(key);
+    if (!slot) {
+        *suppressed = 0;
+        return true;
+    }
+
+    long long now = static_cast<long long>(monotonicNanoseconds() / 1000);
+    long long arrival = slot->arrival.load();
+
+    for (;;) {
+        long long next = (arrival > now ? arrival : now) + m_interval;
+        if (next - now > m_tolerance + m_interval) {
+            slot->suppressed.fetchAdd(1);
+            slot->level.store(level);
+            return false;
+        }
+        if (slot->arrival.compareExchange(arrival, next))
+            break;
+    }
+
+    *suppressed = slot->suppressed.exchange(0);
+    return true;
+}
+
+bool RateLimiter::takeSuppressed(unsigned int *index, const void **key, int *level,
+                                 unsigned long *suppressed)
+{
+    for (; *index < RateLimiterSlots; ++*index) {
+        RateLimiterSlot *slot = &m_slots[*index];
+        if (!slot->key.load() || slot->suppressed.load() == 0)
+            continue;
+
+        *suppressed = slot->suppressed.exchange(0);
+        if (*suppressed == 0)
+            continue;
+
+        *key = slot->key.load();
+        *level = slot->level.load();
+        ++*index;
+        return true;
+    }
+
+    return false;
+}
+
+RateLimiterSlot *RateLimiter::findSlot(const void *key)
+{
+    size_t index = (reinterpret_cast<size_t>(key) >> 3) * 2654435761U;
+
+    for (unsigned int i = 0; i < RateLimiterSlots; ++i, ++index) {
+        RateLimiterSlot *slot = &m_slots[index & (RateLimiterSlots - 1)];
+
+        const void *current = slot->key.load();
+        if (current == key)
+            return slot;
+        if (current)
+            continue;
+
+        // claim the empty slot, unless another thread was faster
+        if (slot->key.compareExchange(current, key) || current == key)
+            return slot;
+    }
+
+    return NULL;
+}
+
+/* }}} */
+
+} // end namespace bw
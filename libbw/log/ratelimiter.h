@@ -0,0 +1,112 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_RATELIMITER_H_
+#define LIBBW_LOG_RATELIMITER_H_
+
+#include <libbw/noncopyable.h>
+
+namespace bw {
+
+struct RateLimiterSlot;
+
+/* RateLimiter {{{ */
+
+/**
+ * \class RateLimiter ratelimiter.h libbw/log/ratelimiter.h
+ * \brief Token bucket per call site
+ *
+ * Each key (usually the address of a format string, i.e. the call site) gets its own
+ * token bucket that allows \p burst messages at once and refills with \p rate messages
+ * per second. Messages that are rejected are counted, so that the next message that
+ * passes can report how many have been suppressed.
+ *
+ * The buckets are stored in a fixed-size table. admit() doesn't take a lock, it only
+ * needs one compare-and-swap on the hot path. If the table is full, messages of new keys
+ * always pass.
+ *
+ * \ingroup log
+ */
+class RateLimiter : private Noncopyable {
+
+public:
+    /**
+     * \brief Creates a new rate limiter
+     *
+     * \param[in] burst the number of messages that may pass at once
+     * \param[in] rate the number of messages per second that may pass in the long run
+     */
+    RateLimiter(unsigned int burst, unsigned int rate);
+
+    /**
+     * \brief Destructor
+     */
+    ~RateLimiter();
+
+public:
+    /**
+     * \brief Checks if a message may pass
+     *
+     * \param[in] key the call site
+     * \param[in] level the level of the message, reported by takeSuppressed()
+     * \param[out] suppressed the number of messages with the same \p key that have been
+     *             suppressed since the last message that passed. Only set if the return
+     *             value is \c true.
+     * \return \c true if the message may pass, \c false if it must be dropped
+     */
+    bool admit(const void *key, int level, unsigned long *suppressed);
+
+    /**
+     * \brief Collects the suppressed messages of one call site
+     *
+     * Used to report suppressed messages of call sites that don't log anymore. Call the
+     * function with \p index starting at 0 until it returns \c false.
+     *
+     * \param[in,out] index the table position where the search starts, is advanced
+     * \param[out] key the call site
+     * \param[out] level the level of the last suppressed message
+     * \param[out] suppressed the number of suppressed messages, which is reset to 0
+     * \return \c true if a call site with suppressed messages has been found
+     */
+    bool takeSuppressed(unsigned int *index, const void **key, int *level,
+                        unsigned long *suppressed);
+
+private:
+    RateLimiterSlot *findSlot(const void *key);
+
+private:
+    long long       m_interval;         // microseconds per token
+    long long       m_tolerance;        // microseconds of burst
+    RateLimiterSlot *m_slots;
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_RATELIMITER_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,106 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstring>
+
+#include "ringerrorlogsink.h"
+#ifdef HAVE_THREADS
+#  include <thread/mutexlocker.h>
+#endif
+
+namespace bw {
+
+/* RingErrorlogSink {{{ */
+
+RingErrorlogSink::RingErrorlogSink(size_t capacity, size_t recordSize)
+    : m_capacity(capacity > 0 ? capacity : 1)
+    , m_recordSize(recordSize > 1 ? recordSize : 2)
+    , m_buffer(m_capacity * m_recordSize)
+    , m_lengths(m_capacity)
+    , m_next(0)
+    , m_count(0)
+{}
+
+void RingErrorlogSink::write(Errorlog::Level level, const char *timestamp, const char *message,
+                             size_t length)
+{
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&m_mutex);
+#endif
+    char *record = &m_buffer[m_next * m_recordSize];
+
+    int ret = std::snprintf(record, m_recordSize, "%s [%-10.10s] ", timestamp,
+                            Errorlog::levelToString(level));
+    size_t used = ret < 0 ? 0 : static_cast<size_t>(ret);
+    if (used >= m_recordSize)
+        used = m_recordSize - 1;
+
+    size_t copy = length < m_recordSize - 1 - used ? length : m_recordSize - 1 - used;
+    std::memcpy(record + used, message, copy);
+    m_lengths[m_next] = used + copy;
+
+    m_next = (m_next + 1) % m_capacity;
+    if (m_count < m_capacity)
+        ++m_count;
+}
+
+std::vector<std::string> RingErrorlogSink::records() const
+{
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&m_mutex);
+#endif
+    std::vector<std::string> result;
+    result.reserve(m_count);
+
+    size_t index = (m_next + m_capacity - m_count) % m_capacity;
+    for (size_t i = 0; i < m_count; ++i, index = (index + 1) % m_capacity)
+        result.push_back(std::string(&m_buffer[index * m_recordSize], m_lengths[index]));
+
+    return result;
+}
+
+void RingErrorlogSink::dump(std::FILE *file) const
+{
+    std::vector<std::string> lines = records();
+    for (size_t i = 0; i < lines.size(); ++i) {
+        std::fwrite(lines[i].data(), 1, lines[i].size(), file);
+        std::fputc('\n', file);
+    }
+    std::fflush(file);
+}
+
+void RingErrorlogSink::clear()
+{
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&m_mutex);
+#endif
+    m_next = 0;
+    m_count = 0;
+}
+
+/* }}} */
+
+} // end namespace bw
@@ -0,0 +1,113 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_RINGERRORLOGSINK_H_
+#define LIBBW_LOG_RINGERRORLOGSINK_H_
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "errorlogsink.h"
+#include "bwconfig.h"
+#ifdef HAVE_THREADS
+#  include <thread/mutex.h>
+#endif
+
+namespace bw {
+
+/* RingErrorlogSink {{{ */
+
+/**
+ * \class RingErrorlogSink ringerrorlogsink.h libbw/log/ringerrorlogsink.h
+ * \brief ErrorlogSink that keeps the last messages in memory
+ *
+ * The memory for all records is allocated in the constructor, so writing never allocates.
+ * Records that don't fit into a slot are truncated. When the ring is full, the oldest
+ * record is overwritten.
+ *
+ * Useful to attach the most recent errors to a crash report or a status page.
+ *
+ * \ingroup log
+ */
+class RingErrorlogSink : public ErrorlogSink {
+
+public:
+    /**
+     * \brief Creates a new RingErrorlogSink
+     *
+     * \param[in] capacity the number of records that are kept
+     * \param[in] recordSize the maximum size of one record in bytes, including timestamp
+     *            and level
+     */
+    RingErrorlogSink(size_t capacity=128, size_t recordSize=256);
+
+public:
+    /**
+     * \copydoc ErrorlogSink::write()
+     */
+    void write(Errorlog::Level level, const char *timestamp, const char *message,
+               size_t length);
+
+    /**
+     * \brief Returns the stored records
+     *
+     * \return the records in the format of FileErrorlog without trailing newline, oldest
+     *         first
+     */
+    std::vector<std::string> records() const;
+
+    /**
+     * \brief Writes the stored records to \p file
+     *
+     * \param[in] file the output file, oldest record first
+     */
+    void dump(std::FILE *file) const;
+
+    /**
+     * \brief Removes all records
+     */
+    void clear();
+
+private:
+    size_t                  m_capacity;
+    size_t                  m_recordSize;
+    std::vector<char>       m_buffer;
+    std::vector<size_t>     m_lengths;
+    size_t                  m_next;
+    size_t                  m_count;
+#ifdef HAVE_THREADS
+    mutable thread::Mutex   m_mutex;
+#endif
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_RINGERRORLOGSINK_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,252 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+
+#include "bwconfig.h"
+#include "rotatingfileerrorlog.h"
+#include "stringutil.h"
+#include "sysutil.h"
+
+namespace bw {
+
+/* Helper functions {{{ */
+
+/**
+ * \brief Parses a number with an optional unit suffix
+ *
+ * \param[in] value the string, e.g. <tt>"10M"</tt>
+ * \param[in] units the suffix characters, e.g. <tt>"kMG"</tt>
+ * \param[in] factors the multiplier for each character in \p units
+ * \return the value
+ */
+static unsigned long long parseValue(const std::string &value, const char *units,
+                                     const unsigned long long *factors)
+{
+    char *end;
+    unsigned long long result = std::strtoull(value.c_str(), &end, 10);
+
+    if (*end != '\0') {
+        const char *unit = std::strchr(units, *end);
+        if (unit)
+            result *= factors[unit - units];
+    }
+
+    return result;
+}
+
+/* }}} */
+/* RotatingFileErrorlog {{{ */
+
+const unsigned long long RotatingFileErrorlog::DefaultMaxSize;
+const unsigned int RotatingFileErrorlog::DefaultKeepCount;
+
+RotatingFileErrorlog::RotatingFileErrorlog(const char *option)
+    : m_fd(-1)
+    , m_nextFd(-1)
+    , m_maxSize(DefaultMaxSize)
+    , m_keepCount(DefaultKeepCount)
+    , m_stderrFallback(false)
+{
+    parseOption(option ? option : "");
+
+    m_fd = ::open(m_filename.c_str(), O_WRONLY | O_APPEND | O_CREAT, 0644);
+    if (m_fd < 0) {
+        std::cerr << "Warning: Unable to open '" << m_filename << "' for writing." << std::endl;
+        m_fd = STDERR_FILENO;
+        m_stderrFallback = true;
+        m_maxSize.store(0, thread::MO_RELAXED);
+        m_interval.store(0, thread::MO_RELAXED);
+        return;
+    }
+
+    struct stat st;
+    if (fstat(m_fd, &st) == 0)
+        m_size.store(st.st_size, thread::MO_RELAXED);
+
+    setRotationInterval(m_interval.load(thread::MO_RELAXED));
+    prepareNextFile();
+}
+
+RotatingFileErrorlog::~RotatingFileErrorlog()
+{
+    if (m_nextFd >= 0) {
+        ::close(m_nextFd);
+        ::unlink((m_filename + ".next").c_str());
+    }
+    if (!m_stderrFallback)
+        ::close(m_fd);
+}
+
+void RotatingFileErrorlog::setMaxSize(unsigned long long bytes)
+{
+    m_maxSize.store(bytes, thread::MO_RELAXED);
+}
+
+void RotatingFileErrorlog::setRotationInterval(unsigned long seconds)
+{
+    m_interval.store(seconds, thread::MO_RELAXED);
+    m_rotateAt.store(seconds ? std::time(NULL) + seconds : 0, thread::MO_RELAXED);
+}
+
+void RotatingFileErrorlog::setKeepCount(unsigned int count)
+{
+    m_keepCount = count > 0 ? count : 1;
+}
+
+void RotatingFileErrorlog::rotate()
+{
+    if (m_stderrFallback)
+        return;
+
+    // only one thread rotates, the others just continue writing
+    int expected = 0;
+    if (!m_rotating.compareExchange(expected, 1, thread::MO_ACQUIRE))
+        return;
+
+    std::remove(rotatedName(m_keepCount).c_str());
+    for (unsigned int i = m_keepCount - 1; i > 0; --i)
+        std::rename(rotatedName(i).c_str(), rotatedName(i + 1).c_str());
+    std::rename(m_filename.c_str(), rotatedName(1).c_str());
+
+    if (m_nextFd < 0)
+        prepareNextFile();
+
+    if (m_nextFd >= 0) {
+        std::rename((m_filename + ".next").c_str(), m_filename.c_str());
+
+        // writers keep using m_fd which now refers to the new file
+        ::dup2(m_nextFd, m_fd);
+        ::close(m_nextFd);
+        m_nextFd = -1;
+    }
+
+    m_size.store(0, thread::MO_RELAXED);
+    setRotationInterval(m_interval.load(thread::MO_RELAXED));
+    prepareNextFile();
+
+    m_rotating.store(0, thread::MO_RELEASE);
+}
+
+void RotatingFileErrorlog::vlog(Errorlog::Level level, const char *msg, std::va_list args)
+{
+    char timestamp[TimestampCache::MaxLength];
+    char stackRecord[1024];
+    char *record = stackRecord;
+    size_t required;
+
+    m_timestamps.format(timestamp, sizeof(timestamp));
+
+    std::va_list argsCopy;
+    BW_COMPILER_VA_COPY(argsCopy, args);
+    size_t length = formatRecord(stackRecord, sizeof(stackRecord), timestamp, level, msg, args,
+                                 &required);
+    if (required > sizeof(stackRecord)) {
+        record = new char[required];
+        length = formatRecord(record, required, timestamp, level, msg, argsCopy, &required);
+    }
+    va_end(argsCopy);
+
+    // O_APPEND makes a single write() atomic with respect to other writers
+    writeAll(m_fd, record, length);
+
+    if (record != stackRecord)
+        delete[] record;
+
+    unsigned long long size = m_size.fetchAdd(length, thread::MO_RELAXED) + length;
+    unsigned long long maxSize = m_maxSize.load(thread::MO_RELAXED);
+    long long rotateAt = m_rotateAt.load(thread::MO_RELAXED);
+
+    if ((maxSize > 0 && size >= maxSize) || (rotateAt > 0 && std::time(NULL) >= rotateAt))
+        rotate();
+}
+
+void RotatingFileErrorlog::parseOption(const std::string &option)
+{
+    static const unsigned long long sizeFactors[] = { 1024, 1024, 1024 * 1024,
+                                                      1024 * 1024 * 1024 };
+    static const unsigned long long timeFactors[] = { 1, 60, 60 * 60, 24 * 60 * 60 };
+
+    std::vector<std::string> parts = stringsplit(option, ";");
+    if (parts.empty()) {
+        m_filename = option;
+        return;
+    }
+
+    m_filename = strip(parts[0]);
+    for (size_t i = 1; i < parts.size(); ++i) {
+        std::string::size_type eq = parts[i].find('=');
+        if (eq == std::string::npos)
+            continue;
+
+        std::string key = strip(parts[i].substr(0, eq));
+        std::string value = strip(parts[i].substr(eq + 1));
+
+        if (key == "maxsize")
+            m_maxSize.store(parseValue(value, "kKMG", sizeFactors), thread::MO_RELAXED);
+        else if (key == "interval")
+            m_interval.store(parseValue(value, "smhd", timeFactors), thread::MO_RELAXED);
+        else if (key == "keep")
+            setKeepCount(std::atoi(value.c_str()));
+        else
+            std::cerr << "Warning: Unknown log option '" << key << "'." << std::endl;
+    }
+}
+
+void RotatingFileErrorlog::prepareNextFile()
+{
+    std::string next = m_filename + ".next";
+
+    m_nextFd = ::open(next.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_TRUNC, 0644);
+    if (m_nextFd < 0)
+        return;
+
+#if defined(HAVE_FALLOCATE) && defined(FALLOC_FL_KEEP_SIZE)
+    // reserve the blocks without changing the file size, so O_APPEND starts at 0
+    unsigned long long maxSize = m_maxSize.load(thread::MO_RELAXED);
+    if (maxSize > 0)
+        ::fallocate(m_nextFd, FALLOC_FL_KEEP_SIZE, 0, maxSize);
+#endif
+}
+
+std::string RotatingFileErrorlog::rotatedName(unsigned int index) const
+{
+    return m_filename + "." + str(index);
+}
+
+/* }}} */
+
+} // end namespace bw
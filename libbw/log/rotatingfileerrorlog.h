@@ -0,0 +1,162 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_ROTATINGFILEERRORLOG_H_
+#define LIBBW_LOG_ROTATINGFILEERRORLOG_H_
+
+#include <string>
+
+#include "errorlog.h"
+#include "timestampcache.h"
+#include <thread/atomic.h>
+
+namespace bw {
+
+/* RotatingFileErrorlog {{{ */
+
+/**
+ * \brief Error log implementation that rotates the log file itself
+ *
+ * The log file is rotated when it exceeds a maximum size or when the rotation interval
+ * expires, whatever comes first. On rotation, \c file becomes \c file.1, \c file.1 becomes
+ * \c file.2 and so on. The oldest file is removed.
+ *
+ * Each record is written with a single write() call to a file descriptor that has been
+ * opened with \c O_APPEND, so there is no user-space buffer that could get out of sync and
+ * no lock for writers. The successor of the current file is created in advance as
+ * \c file.next, and its disk space is reserved with fallocate() where available. Rotation
+ * renames the files and atomically replaces the file behind the descriptor with dup2().
+ * Other threads keep writing during the rotation: their records end up either at the end
+ * of \c file.1 or at the beginning of the new \c file, but are never lost.
+ *
+ * Don't combine that with an external logrotate configuration for the same file.
+ *
+ * If the file cannot be opened, the records are written to \c stderr without rotation,
+ * like FileErrorlog does.
+ *
+ * Only available on platforms with thread support. Use Errorlog::configure() with
+ * Errorlog::LM_ROTATING_FILE to create an instance.
+ *
+ * \ingroup log
+ */
+class RotatingFileErrorlog : public Errorlog {
+
+public:
+    /// Let Errorlog create instances of RotatingFileErrorlog, and only Errorlog.
+    friend class Errorlog;
+
+    /**
+     * \brief Default value for setMaxSize(): 10 MiB
+     */
+    static const unsigned long long DefaultMaxSize = 10 * 1024 * 1024;
+
+    /**
+     * \brief Default value for setKeepCount()
+     */
+    static const unsigned int DefaultKeepCount = 5;
+
+public:
+    /**
+     * \brief Sets the size limit
+     *
+     * \param[in] bytes the size in bytes after which the file is rotated, 0 disables
+     *            rotation by size
+     */
+    void setMaxSize(unsigned long long bytes);
+
+    /**
+     * \brief Sets the rotation interval
+     *
+     * \param[in] seconds the maximum age of the current file in seconds, 0 disables
+     *            rotation by time (the default)
+     */
+    void setRotationInterval(unsigned long seconds);
+
+    /**
+     * \brief Sets the number of rotated files that are kept
+     *
+     * \param[in] count the number of old files, at least 1
+     */
+    void setKeepCount(unsigned int count);
+
+    /**
+     * \brief Rotates the log file now
+     *
+     * Does nothing if another thread is rotating the file at the moment or if the records
+     * are written to \c stderr because the file could not be opened.
+     */
+    void rotate();
+
+protected:
+    /**
+     * \brief Creates a new RotatingFileErrorlog.
+     *
+     * Don't use that function directly. Instead, use Errorlog::configure().
+     *
+     * \param[in] option the name of the log file, optionally followed by settings that are
+     *            separated by semicolons: <tt>maxsize=</tt> (with the suffixes \c k, \c M
+     *            and \c G), <tt>interval=</tt> (seconds, with the suffixes \c m, \c h and
+     *            \c d) and <tt>keep=</tt>. Example:
+     *            <tt>"/var/log/foo.log;maxsize=50M;interval=1d;keep=7"</tt>
+     */
+    RotatingFileErrorlog(const char *option);
+
+    /**
+     * \brief Destructor
+     */
+    ~RotatingFileErrorlog();
+
+    /**
+     * \copydoc Errorlog::vlog()
+     */
+    void vlog(Errorlog::Level level, const char *msg, std::va_list args);
+
+private:
+    void parseOption(const std::string &option);
+    void prepareNextFile();
+    std::string rotatedName(unsigned int index) const;
+
+private:
+    std::string                                 m_filename;
+    int                                         m_fd;
+    int                                         m_nextFd;
+    thread::Atomic<unsigned long long>          m_maxSize;
+    thread::Atomic<unsigned long>               m_interval;
+    unsigned int                                m_keepCount;
+    thread::Atomic<unsigned long long>          m_size;
+    thread::Atomic<long long>                   m_rotateAt;
+    thread::Atomic<int>                         m_rotating;
+    bool                                        m_stderrFallback;
+    TimestampCache                              m_timestamps;
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_ROTATINGFILEERRORLOG_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,77 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <syslog.h>
+
+#include "syserrorlogsink.h"
+
+namespace bw {
+
+/* SysErrorlogSink {{{ */
+
+SysErrorlogSink::SysErrorlogSink(const char *ident)
+{
+    openlog(ident, LOG_CONS, LOG_LOCAL0);
+}
+
+SysErrorlogSink::~SysErrorlogSink()
+{
+    closelog();
+}
+
+void SysErrorlogSink::write(Errorlog::Level level, const char *timestamp, const char *message,
+                            size_t length)
+{
+    (void)timestamp;
+    (void)length;
+
+    int priority;
+    switch (level) {
+        case Errorlog::LS_EMERG:
+            priority = LOG_EMERG;
+            break;
+        case Errorlog::LS_ALERT:
+            priority = LOG_ALERT;
+            break;
+        case Errorlog::LS_CRIT:
+            priority = LOG_CRIT;
+            break;
+        case Errorlog::LS_ERR:
+            priority = LOG_ERR;
+            break;
+        case Errorlog::LS_WARNING:
+            priority = LOG_WARNING;
+            break;
+        default:
+            return;
+    }
+
+    syslog(priority, "%s", message);
+}
+
+/* }}} */
+
+} // end namespace bw
@@ -0,0 +1,74 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_SYSERRORLOGSINK_H_
+#define LIBBW_LOG_SYSERRORLOGSINK_H_
+
+#include "errorlogsink.h"
+
+namespace bw {
+
+/* SysErrorlogSink {{{ */
+
+/**
+ * \class SysErrorlogSink syserrorlogsink.h libbw/log/syserrorlogsink.h
+ * \brief ErrorlogSink that writes to syslog
+ *
+ * Only available on Unix.
+ *
+ * \ingroup log
+ */
+class SysErrorlogSink : public ErrorlogSink {
+
+public:
+    /**
+     * \brief Creates a new SysErrorlogSink
+     *
+     * \param[in] ident the syslog ident string. The string is not copied, so it must stay
+     *            valid as long as the sink exists.
+     */
+    SysErrorlogSink(const char *ident="");
+
+    /**
+     * \brief Destructor
+     */
+    ~SysErrorlogSink();
+
+public:
+    /**
+     * \copydoc ErrorlogSink::write()
+     */
+    void write(Errorlog::Level level, const char *timestamp, const char *message,
+               size_t length);
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_SYSERRORLOGSINK_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,181 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstring>
+
+#include "sysutil.h"
+#include "timestampcache.h"
+
+namespace bw {
+
+/* Helper functions {{{ */
+
+static void putDigits(char *buffer, long value, int digits)
+{
+    for (int i = digits - 1; i >= 0; --i) {
+        buffer[i] = '0' + value % 10;
+        value /= 10;
+    }
+}
+
+/**
+ * \brief Formats \p second like Datetime::str() into \p text
+ *
+ * \param[in] second the seconds since the epoch
+ * \param[out] text the 19 characters of <tt>"YYYY-MM-DD HH:MM:SS"</tt>, padded with NUL bytes
+ */
+static void renderSecond(long long second, char *text)
+{
+    time_t time = static_cast<time_t>(second);
+    struct tm tm;
+
+#ifdef HAVE_LOCALTIME_R
+    localtime_r(&time, &tm);
+#else
+    tm = *std::localtime(&time);
+#endif
+
+    putDigits(text, tm.tm_year + 1900, 4);
+    text[4] = '-';
+    putDigits(text + 5, tm.tm_mon + 1, 2);
+    text[7] = '-';
+    putDigits(text + 8, tm.tm_mday, 2);
+    text[10] = ' ';
+    putDigits(text + 11, tm.tm_hour, 2);
+    text[13] = ':';
+    putDigits(text + 14, tm.tm_min, 2);
+    text[16] = ':';
+    putDigits(text + 17, tm.tm_sec, 2);
+}
+
+/* }}} */
+/* TimestampCache {{{ */
+
+// "YYYY-MM-DD HH:MM:SS"
+static const size_t SecondLength = 19;
+
+const size_t TimestampCache::MaxLength;
+
+TimestampCache::TimestampCache(Resolution resolution)
+    : m_second(-1)
+    , m_resolution(resolution)
+{
+#ifndef HAVE_THREADS
+    std::memset(m_text, 0, sizeof(m_text));
+#endif
+}
+
+size_t TimestampCache::format(char *buffer, size_t size)
+{
+    long long second;
+    long nanosecond;
+    realtimeClock(&second, &nanosecond);
+
+    unsigned long long words[TextWords];
+    char *text = reinterpret_cast<char *>(words);
+
+#ifdef HAVE_THREADS
+    unsigned long sequence = m_sequence.load(thread::MO_ACQUIRE);
+    bool hit = false;
+
+    if ((sequence & 1) == 0 && m_second.load(thread::MO_RELAXED) == second) {
+        for (int i = 0; i < TextWords; ++i)
+            words[i] = m_text[i].load(thread::MO_RELAXED);
+        thread::atomicFence(thread::MO_ACQUIRE);
+        hit = m_sequence.load(thread::MO_RELAXED) == sequence;
+    }
+
+    if (!hit) {
+        std::memset(words, 0, sizeof(words));
+        renderSecond(second, text);
+
+        // publish the new second, unless another thread is already doing that
+        if ((sequence & 1) == 0 &&
+                m_sequence.compareExchange(sequence, sequence + 1, thread::MO_ACQUIRE)) {
+            thread::atomicFence(thread::MO_RELEASE);
+            if (second > m_second.load(thread::MO_RELAXED)) {
+                m_second.store(second, thread::MO_RELAXED);
+                for (int i = 0; i < TextWords; ++i)
+                    m_text[i].store(words[i], thread::MO_RELAXED);
+            }
+            m_sequence.store(sequence + 2, thread::MO_RELEASE);
+        }
+    }
+#else
+    if (m_second != second) {
+        std::memset(m_text, 0, sizeof(m_text));
+        renderSecond(second, reinterpret_cast<char *>(m_text));
+        m_second = second;
+    }
+    std::memcpy(words, m_text, sizeof(words));
+#endif
+
+    char result[MaxLength];
+    size_t length = SecondLength;
+    std::memcpy(result, text, SecondLength);
+
+    switch (m_resolution) {
+        case TR_MILLISECONDS:
+            result[length++] = '.';
+            putDigits(result + length, nanosecond / 1000000, 3);
+            length += 3;
+            break;
+
+        case TR_MICROSECONDS:
+            result[length++] = '.';
+            putDigits(result + length, nanosecond / 1000, 6);
+            length += 6;
+            break;
+
+        default:
+            break;
+    }
+
+    if (size == 0)
+        return 0;
+    if (length >= size)
+        length = size - 1;
+    std::memcpy(buffer, result, length);
+    buffer[length] = '\0';
+
+    return length;
+}
+
+FixedString<TimestampCache::MaxLength - 1> TimestampCache::format()
+{
+    FixedString<MaxLength - 1> result;
+    result.resize(format(result.data(), MaxLength));
+    return result;
+}
+
+TimestampCache::Resolution TimestampCache::resolution() const
+{
+    return m_resolution;
+}
+
+/* }}} */
+
+} // end namespace bw
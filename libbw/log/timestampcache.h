@@ -0,0 +1,130 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_TIMESTAMPCACHE_H_
+#define LIBBW_LOG_TIMESTAMPCACHE_H_
+
+#include <cstddef>
+#include <ctime>
+
+#include "bwconfig.h"
+#include "fixedstring.h"
+#ifdef HAVE_THREADS
+#  include <thread/atomic.h>
+#endif
+
+namespace bw {
+
+/* TimestampCache {{{ */
+
+/**
+ * \class TimestampCache timestampcache.h libbw/log/timestampcache.h
+ * \brief Fast formatter for the local time prefix of log records
+ *
+ * Produces the same <tt>"YYYY-MM-DD HH:MM:SS"</tt> string as <tt>Datetime::now().str()</tt>,
+ * optionally followed by milliseconds or microseconds. The expensive part, localtime_r()
+ * and the formatting of the date, is only done once per second. All other calls copy the
+ * cached string.
+ *
+ * One object can be shared by all threads. Readers never take a lock: the cache is
+ * protected by a sequence counter, and a thread that sees the cache being updated simply
+ * formats the timestamp itself.
+ *
+ * \ingroup log
+ */
+class TimestampCache {
+
+public:
+    /**
+     * \brief Sub-second part of the timestamp
+     */
+    enum Resolution {
+        TR_SECONDS,         /**< <tt>"2012-01-31 12:00:00"</tt> */
+        TR_MILLISECONDS,    /**< <tt>"2012-01-31 12:00:00.123"</tt> */
+        TR_MICROSECONDS     /**< <tt>"2012-01-31 12:00:00.123456"</tt> */
+    };
+
+    /**
+     * \brief Buffer size that is sufficient for format() with every resolution
+     */
+    static const size_t MaxLength = 32;
+
+public:
+    /**
+     * \brief Creates a new timestamp cache
+     *
+     * Without clock_gettime() support, the sub-second part is always zero.
+     *
+     * \param[in] resolution the sub-second part that is appended by format()
+     */
+    TimestampCache(Resolution resolution=TR_SECONDS);
+
+public:
+    /**
+     * \brief Formats the current local time
+     *
+     * \param[out] buffer the output buffer. The result is always NUL-terminated.
+     * \param[in] size the size of \p buffer. Use MaxLength to never truncate.
+     * \return the length of the timestamp in \p buffer, without the NUL byte
+     */
+    size_t format(char *buffer, size_t size);
+
+    /**
+     * \brief Formats the current local time
+     *
+     * \return the timestamp, on the stack
+     */
+    FixedString<MaxLength - 1> format();
+
+    /**
+     * \brief Returns the resolution
+     *
+     * \return the resolution that has been passed to the constructor
+     */
+    Resolution resolution() const;
+
+private:
+    // 19 characters of "YYYY-MM-DD HH:MM:SS" in three words
+    enum { TextWords = 3 };
+
+#ifdef HAVE_THREADS
+    thread::Atomic<unsigned long>       m_sequence;
+    thread::Atomic<long long>           m_second;
+    thread::Atomic<unsigned long long>  m_text[TextWords];
+#else
+    long long                           m_second;
+    unsigned long long                  m_text[TextWords];
+#endif
+    Resolution                          m_resolution;
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_TIMESTAMPCACHE_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,313 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdio>
+
+#include <unistd.h>
+
+#include "bwconfig.h"
+#include "sysutil.h"
+#include "tracer.h"
+#ifdef HAVE_THREADS
+#  include <thread/atomic.h>
+#  include <thread/threadstorage.h>
+#endif
+
+namespace bw {
+
+/* Helper functions {{{ */
+
+/**
+ * \brief Writes \p string as JSON string literal
+ */
+static void writeJsonString(std::FILE *fp, const char *string)
+{
+    std::fputc('"', fp);
+    for (const char *p = string; *p; ++p) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\')
+            std::fprintf(fp, "\\%c", c);
+        else if (c < 0x20)
+            std::fprintf(fp, "\\u%04x", c);
+        else
+            std::fputc(c, fp);
+    }
+    std::fputc('"', fp);
+}
+
+/* }}} */
+
+#ifdef HAVE_THREADS
+
+/* TraceEvent {{{ */
+
+/**
+ * \brief One finished span
+ */
+struct TraceEvent {
+    const char          *name;
+    Debug::Category     category;
+    unsigned int        thread;
+    unsigned long long  begin;
+    unsigned long long  duration;
+};
+
+/* }}} */
+/* TraceBuffer {{{ */
+
+/**
+ * \brief The spans of one thread
+ *
+ * Only the owning thread appends. Events below \c count are complete. The buffer belongs
+ * to the recording session \c generation, older contents are discarded by the owner on
+ * the next append, so that start() never has to touch buffers of other threads.
+ */
+struct TraceBuffer {
+    TraceBuffer(size_t capacity)
+        : next(NULL)
+        , threadNumber(0)
+        , capacity(capacity)
+        , events(new TraceEvent[capacity])
+    {}
+
+    ~TraceBuffer()
+    {
+        delete[] events;
+    }
+
+    TraceBuffer                     *next;          // immutable once published
+    thread::Atomic<int>             owned;
+    unsigned int                    threadNumber;
+    thread::Atomic<unsigned int>    generation;
+    thread::Atomic<size_t>          count;
+    size_t                          capacity;
+    TraceEvent                      *events;
+};
+
+/* }}} */
+/* TraceState {{{ */
+
+static void releaseTraceBuffer(void *buffer)
+{
+    static_cast<TraceBuffer *>(buffer)->owned.store(0, thread::MO_RELEASE);
+}
+
+/**
+ * \brief Global state of Tracer
+ *
+ * The buffers are never freed: a thread might still be appending to its buffer while
+ * another one calls stop().
+ */
+struct TraceState {
+    TraceState()
+        : buffers(NULL)
+        , storage(releaseTraceBuffer)
+    {}
+
+    thread::Atomic<TraceBuffer *>   buffers;
+    thread::Atomic<size_t>          capacity;
+    thread::Atomic<unsigned int>    generation;
+    thread::Atomic<unsigned int>    nextThread;
+    thread::Atomic<unsigned long>   dropped;
+    thread::ThreadStorage           storage;
+};
+
+static TraceState *traceState()
+{
+    static TraceState *s_state = new TraceState;
+
+    return s_state;
+}
+
+static TraceBuffer *threadTraceBuffer(TraceState *state)
+{
+    TraceBuffer *buffer = static_cast<TraceBuffer *>(state->storage.get());
+    if (buffer)
+        return buffer;
+
+    // reuse the buffer of a terminated thread, its events stay valid
+    for (buffer = state->buffers.load(thread::MO_ACQUIRE); buffer; buffer = buffer->next) {
+        int expected = 0;
+        if (buffer->owned.compareExchange(expected, 1, thread::MO_ACQUIRE))
+            break;
+    }
+
+    if (!buffer) {
+        buffer = new TraceBuffer(state->capacity.load(thread::MO_RELAXED));
+        buffer->owned.store(1, thread::MO_RELAXED);
+
+        TraceBuffer *head = state->buffers.load(thread::MO_RELAXED);
+        do {
+            buffer->next = head;
+        } while (!state->buffers.compareExchange(head, buffer, thread::MO_RELEASE));
+    }
+
+    buffer->threadNumber = state->nextThread.fetchAdd(1, thread::MO_RELAXED) + 1;
+    state->storage.set(buffer);
+
+    return buffer;
+}
+
+/* }}} */
+
+#endif /* HAVE_THREADS */
+
+/* Tracer {{{ */
+
+const size_t Tracer::DefaultEventsPerThread;
+
+bool Tracer::m_recording = false;
+
+#ifdef HAVE_THREADS
+
+bool Tracer::start(size_t eventsPerThread)
+{
+    TraceState *state = traceState();
+
+    size_t expected = 0;
+    state->capacity.compareExchange(expected, eventsPerThread > 0 ? eventsPerThread : 1,
+                                    thread::MO_RELAXED);
+    state->generation.fetchAdd(1, thread::MO_RELEASE);
+    state->dropped.store(0, thread::MO_RELAXED);
+
+    BW_COMPILER_STORE_RELAXED(m_recording, true);
+    return true;
+}
+
+void Tracer::stop()
+{
+    BW_COMPILER_STORE_RELAXED(m_recording, false);
+}
+
+bool Tracer::write(const char *filename)
+{
+    std::FILE *fp = std::fopen(filename, "w");
+    if (!fp)
+        return false;
+
+    TraceState *state = traceState();
+    unsigned int generation = state->generation.load(thread::MO_ACQUIRE);
+    Debug *debug = Debug::debug();
+    long pid = static_cast<long>(getpid());
+    bool first = true;
+
+    std::fputs("{\"traceEvents\":[", fp);
+    for (TraceBuffer *buffer = state->buffers.load(thread::MO_ACQUIRE); buffer;
+            buffer = buffer->next) {
+        if (buffer->generation.load(thread::MO_ACQUIRE) != generation)
+            continue;
+
+        size_t count = buffer->count.load(thread::MO_ACQUIRE);
+        for (size_t i = 0; i < count; ++i) {
+            const TraceEvent &event = buffer->events[i];
+
+            std::fputs(first ? "\n{\"name\":" : ",\n{\"name\":", fp);
+            writeJsonString(fp, event.name);
+            if (event.category != Debug::DefaultCategory) {
+                std::fputs(",\"cat\":", fp);
+                writeJsonString(fp, debug->categoryName(event.category));
+            }
+            std::fprintf(fp, ",\"ph\":\"X\",\"ts\":%llu.%03llu,\"dur\":%llu.%03llu,"
+                         "\"pid\":%ld,\"tid\":%u}",
+                         event.begin / 1000, event.begin % 1000,
+                         event.duration / 1000, event.duration % 1000,
+                         pid, event.thread);
+            first = false;
+        }
+    }
+    std::fputs("\n],\"displayTimeUnit\":\"ns\"}\n", fp);
+
+    bool ok = !std::ferror(fp);
+    return std::fclose(fp) == 0 && ok;
+}
+
+unsigned long Tracer::droppedSpans()
+{
+    return traceState()->dropped.load(thread::MO_RELAXED);
+}
+
+void Tracer::record(Debug::Category category, const char *name, unsigned long long begin,
+                    unsigned long long end)
+{
+    TraceState *state = traceState();
+    TraceBuffer *buffer = threadTraceBuffer(state);
+
+    // the first span after start() discards the events of the previous session
+    unsigned int generation = state->generation.load(thread::MO_ACQUIRE);
+    if (buffer->generation.load(thread::MO_RELAXED) != generation) {
+        buffer->count.store(0, thread::MO_RELAXED);
+        buffer->generation.store(generation, thread::MO_RELEASE);
+    }
+
+    size_t count = buffer->count.load(thread::MO_RELAXED);
+    if (count >= buffer->capacity) {
+        state->dropped.fetchAdd(1, thread::MO_RELAXED);
+        return;
+    }
+
+    TraceEvent &event = buffer->events[count];
+    event.name = name;
+    event.category = category;
+    event.thread = buffer->threadNumber;
+    event.begin = begin;
+    event.duration = end > begin ? end - begin : 0;
+
+    buffer->count.store(count + 1, thread::MO_RELEASE);
+}
+
+#else
+
+bool Tracer::start(size_t)
+{
+    return false;
+}
+
+void Tracer::stop()
+{}
+
+bool Tracer::write(const char *)
+{
+    return false;
+}
+
+unsigned long Tracer::droppedSpans()
+{
+    return 0;
+}
+
+void Tracer::record(Debug::Category, const char *, unsigned long long, unsigned long long)
+{}
+
+#endif /* HAVE_THREADS */
+
+unsigned long long Tracer::now()
+{
+    return monotonicNanoseconds();
+}
+
+/* }}} */
+
+} // end namespace bw
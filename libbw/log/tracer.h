@@ -0,0 +1,237 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_LOG_TRACER_H_
+#define LIBBW_LOG_TRACER_H_
+
+#include <cstddef>
+
+#include <libbw/compiler.h>
+#include <libbw/noncopyable.h>
+#include "debug.h"
+
+/* Macros {{{ */
+
+/// \cond
+#define BW_TRACE_CONCAT_(a, b) a##b
+#define BW_TRACE_CONCAT(a, b) BW_TRACE_CONCAT_(a, b)
+/// \endcond
+
+/**
+ * \brief Records the rest of the enclosing scope as trace span
+ *
+ * Example:
+ *
+ * \code
+ * #include <libbw/log/tracer.h>
+ *
+ * void parse()
+ * {
+ *     BW_TRACE_SPAN("parse");
+ *     // ...
+ * }
+ * \endcode
+ *
+ * The span is only recorded while bw::Tracer is recording and the debug level allows
+ * bw::Debug::DL_TRACE messages. If BW_DEBUG_MIN_LEVEL excludes DL_TRACE, the macro compiles
+ * to nothing.
+ *
+ * \param[in] name the name of the span, must be a string literal
+ * \ingroup log
+ */
+#define BW_TRACE_SPAN(name) \
+    BW_TRACE_SPAN_CATEGORY(bw::Debug::DefaultCategory, name)
+
+/**
+ * \brief Records the rest of the enclosing scope as trace span of a debug category
+ *
+ * Like BW_TRACE_SPAN(), but the level of \p category is checked, and the category name
+ * appears in the trace.
+ *
+ * \param[in] category the handle returned by bw::Debug::registerCategory()
+ * \param[in] name the name of the span, must be a string literal
+ * \ingroup log
+ */
+#if BW_DEBUG_MIN_LEVEL > 0
+#define BW_TRACE_SPAN_CATEGORY(category, name) \
+    do {} while (0)
+#else
+#define BW_TRACE_SPAN_CATEGORY(category, name) \
+    bw::TraceSpan BW_TRACE_CONCAT(_bwTraceSpan, __LINE__)(category, name)
+#endif
+
+/* }}} */
+
+namespace bw {
+
+/* Tracer {{{ */
+
+/**
+ * \class Tracer tracer.h libbw/log/tracer.h
+ * \brief Collects trace spans and writes them in the Chrome trace event format
+ *
+ * Each thread records its spans into its own buffer, without locks. The buffers are only
+ * read by write(), which produces a JSON file that can be opened in
+ * <tt>chrome://tracing</tt> or in Perfetto.
+ *
+ * Timestamps are taken from \c CLOCK_MONOTONIC. Only available on platforms with thread
+ * support.
+ *
+ * \ingroup log
+ */
+class Tracer : private Noncopyable {
+
+public:
+    /**
+     * \brief Default for the \p eventsPerThread parameter of start()
+     */
+    static const size_t DefaultEventsPerThread = 65536;
+
+public:
+    /**
+     * \brief Starts recording
+     *
+     * Spans that have been recorded before are discarded.
+     *
+     * \param[in] eventsPerThread the number of spans each thread can record. When the
+     *            buffer of a thread is full, further spans are dropped. Only the value of
+     *            the first call is used.
+     * \return \c true on success, \c false if the platform doesn't support tracing
+     */
+    static bool start(size_t eventsPerThread=DefaultEventsPerThread);
+
+    /**
+     * \brief Stops recording
+     *
+     * The spans that have been recorded so far are kept for write().
+     */
+    static void stop();
+
+    /**
+     * \brief Checks if spans are recorded
+     *
+     * \return \c true between start() and stop()
+     */
+    static bool isRecording()
+    {
+        return BW_COMPILER_LOAD_RELAXED(m_recording);
+    }
+
+    /**
+     * \brief Writes the recorded spans as Chrome trace event JSON
+     *
+     * Can be called while recording. Spans that have not finished yet are not included.
+     *
+     * \param[in] filename the name of the output file, which is overwritten
+     * \return \c true on success, \c false if the file cannot be written
+     */
+    static bool write(const char *filename);
+
+    /**
+     * \brief Returns the number of spans that have been dropped
+     *
+     * \return the number of spans since the last start() that didn't fit into the buffer
+     *         of their thread
+     */
+    static unsigned long droppedSpans();
+
+    /**
+     * \brief Returns a monotonic timestamp
+     *
+     * \return the time in nanoseconds since an unspecified point in the past
+     */
+    static unsigned long long now();
+
+    /**
+     * \brief Records a finished span
+     *
+     * Usually called by TraceSpan.
+     *
+     * \param[in] category the debug category of the span
+     * \param[in] name the name of the span, must be a string literal
+     * \param[in] begin the start time from now()
+     * \param[in] end the end time from now()
+     */
+    static void record(Debug::Category category, const char *name, unsigned long long begin,
+                       unsigned long long end);
+
+private:
+    static bool m_recording;
+};
+
+/* }}} */
+/* TraceSpan {{{ */
+
+/**
+ * \class TraceSpan tracer.h libbw/log/tracer.h
+ * \brief Records its lifetime as trace span
+ *
+ * Use the BW_TRACE_SPAN() macro instead of creating objects directly.
+ *
+ * \ingroup log
+ */
+class TraceSpan : private Noncopyable {
+
+public:
+    /**
+     * \brief Starts the span if tracing is enabled for \p category
+     *
+     * \param[in] category the debug category
+     * \param[in] name the name of the span, must be a string literal
+     */
+    TraceSpan(Debug::Category category, const char *name)
+        : m_category(category)
+        , m_name(NULL)
+        , m_begin(0)
+    {
+        if (Tracer::isRecording() && Debug::debug()->isEnabled(category, Debug::DL_TRACE)) {
+            m_name = name;
+            m_begin = Tracer::now();
+        }
+    }
+
+    /**
+     * \brief Ends the span
+     */
+    ~TraceSpan()
+    {
+        if (m_name)
+            Tracer::record(m_category, m_name, m_begin, Tracer::now());
+    }
+
+private:
+    Debug::Category     m_category;
+    const char          *m_name;
+    unsigned long long  m_begin;
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_LOG_TRACER_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,99 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include "counter.h"
+#include "shard.h"
+
+namespace bw {
+namespace metrics {
+
+/* CounterCell {{{ */
+
+/**
+ * \brief The counter of one shard, alone on its cache line
+ */
+struct CounterCell {
+    thread::Atomic<unsigned long long>  value;
+    char                                padding[64 - sizeof(unsigned long long)];
+};
+
+/* }}} */
+/* Counter {{{ */
+
+Counter::Counter()
+    : m_cells(new CounterCell[ShardCount])
+{}
+
+Counter::~Counter()
+{
+    delete[] m_cells;
+}
+
+void Counter::add(unsigned long long delta)
+{
+    m_cells[currentShard()].value.fetchAdd(delta, thread::MO_RELAXED);
+}
+
+unsigned long long Counter::value() const
+{
+    unsigned long long sum = 0;
+    for (unsigned int i = 0; i < ShardCount; ++i)
+        sum += m_cells[i].value.load(thread::MO_RELAXED);
+
+    return sum;
+}
+
+void Counter::reset()
+{
+    for (unsigned int i = 0; i < ShardCount; ++i)
+        m_cells[i].value.store(0, thread::MO_RELAXED);
+}
+
+/* }}} */
+/* Gauge {{{ */
+
+Gauge::Gauge()
+{}
+
+void Gauge::set(long long value)
+{
+    m_value.store(value, thread::MO_RELAXED);
+}
+
+void Gauge::add(long long delta)
+{
+    m_value.fetchAdd(delta, thread::MO_RELAXED);
+}
+
+long long Gauge::value() const
+{
+    return m_value.load(thread::MO_RELAXED);
+}
+
+/* }}} */
+
+} // end namespace metrics
+} // end namespace bw
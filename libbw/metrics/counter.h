@@ -0,0 +1,140 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_METRICS_COUNTER_H_
+#define LIBBW_METRICS_COUNTER_H_
+
+#include <libbw/noncopyable.h>
+#include <libbw/thread/atomic.h>
+
+namespace bw {
+namespace metrics {
+
+struct CounterCell;
+
+/* Counter {{{ */
+
+/**
+ * \class Counter counter.h libbw/metrics/counter.h
+ * \brief Monotonic event counter
+ *
+ * Each thread increments its own cache line, so add() is a single uncontended atomic
+ * addition. value() sums up the shards of all threads.
+ *
+ * \ingroup metrics
+ */
+class Counter : private Noncopyable {
+
+public:
+    /**
+     * \brief Creates a new counter with the value 0
+     */
+    Counter();
+
+    /**
+     * \brief Destructor
+     */
+    ~Counter();
+
+public:
+    /**
+     * \brief Increments the counter
+     *
+     * \param[in] delta the value to add
+     */
+    void add(unsigned long long delta=1);
+
+    /**
+     * \brief Returns the current value
+     *
+     * The result is only a snapshot if other threads increment the counter concurrently.
+     *
+     * \return the sum of all increments
+     */
+    unsigned long long value() const;
+
+    /**
+     * \brief Sets the counter to 0
+     *
+     * Increments that happen concurrently may get lost.
+     */
+    void reset();
+
+private:
+    CounterCell *m_cells;
+};
+
+/* }}} */
+/* Gauge {{{ */
+
+/**
+ * \class Gauge counter.h libbw/metrics/counter.h
+ * \brief Value that can go up and down, like a queue length
+ *
+ * \ingroup metrics
+ */
+class Gauge : private Noncopyable {
+
+public:
+    /**
+     * \brief Creates a new gauge with the value 0
+     */
+    Gauge();
+
+public:
+    /**
+     * \brief Sets the value
+     *
+     * \param[in] value the new value
+     */
+    void set(long long value);
+
+    /**
+     * \brief Changes the value
+     *
+     * \param[in] delta the value to add, may be negative
+     */
+    void add(long long delta);
+
+    /**
+     * \brief Returns the current value
+     *
+     * \return the value
+     */
+    long long value() const;
+
+private:
+    thread::Atomic<long long> m_value;
+};
+
+/* }}} */
+
+} // end namespace metrics
+} // end namespace bw
+
+#endif /* LIBBW_METRICS_COUNTER_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,227 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <libbw/sysutil.h>
+
+#include "bwconfig.h"
+#include "histogram.h"
+#include "shard.h"
+
+namespace bw {
+namespace metrics {
+
+/* HistogramShard {{{ */
+
+/**
+ * \brief The samples recorded by the threads of one shard
+ *
+ * The number of samples is not stored separately, it's the sum of the buckets. That saves
+ * one atomic operation per sample.
+ */
+struct HistogramShard {
+    thread::Atomic<unsigned long long>  buckets[Histogram::BucketCount];
+    thread::Atomic<unsigned long long>  sum;
+    thread::Atomic<unsigned long long>  max;
+};
+
+/* }}} */
+/* HistogramSnapshot {{{ */
+
+HistogramSnapshot::HistogramSnapshot()
+    : m_buckets(Histogram::BucketCount)
+    , m_count(0)
+    , m_sum(0)
+    , m_max(0)
+{}
+
+void HistogramSnapshot::merge(const HistogramSnapshot &other)
+{
+    for (unsigned int i = 0; i < Histogram::BucketCount; ++i)
+        m_buckets[i] += other.m_buckets[i];
+
+    m_count += other.m_count;
+    m_sum += other.m_sum;
+    if (other.m_max > m_max)
+        m_max = other.m_max;
+}
+
+unsigned long long HistogramSnapshot::count() const
+{
+    return m_count;
+}
+
+double HistogramSnapshot::mean() const
+{
+    return m_count > 0 ? static_cast<double>(m_sum) / m_count : 0.0;
+}
+
+unsigned long long HistogramSnapshot::max() const
+{
+    return m_max;
+}
+
+unsigned long long HistogramSnapshot::percentile(double percent) const
+{
+    if (m_count == 0)
+        return 0;
+
+    // the rank of the sample, at least the first one
+    unsigned long long rank = static_cast<unsigned long long>(percent / 100.0 * m_count + 0.5);
+    if (rank < 1)
+        rank = 1;
+
+    unsigned long long seen = 0;
+    for (unsigned int i = 0; i < Histogram::BucketCount; ++i) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            unsigned long long upper = Histogram::bucketUpperBound(i);
+            return upper < m_max ? upper : m_max;
+        }
+    }
+
+    return m_max;
+}
+
+/* }}} */
+/* Histogram {{{ */
+
+const unsigned int Histogram::SubBucketBits;
+const unsigned int Histogram::BucketCount;
+
+Histogram::Histogram()
+    : m_shards(new thread::Atomic<HistogramShard *>[ShardCount])
+{}
+
+Histogram::~Histogram()
+{
+    for (unsigned int i = 0; i < ShardCount; ++i)
+        delete m_shards[i].load();
+    delete[] m_shards;
+}
+
+void Histogram::record(unsigned long long value)
+{
+    HistogramShard *current = shard();
+
+    current->buckets[bucketIndex(value)].fetchAdd(1, thread::MO_RELAXED);
+    current->sum.fetchAdd(value, thread::MO_RELAXED);
+
+    unsigned long long max = current->max.load(thread::MO_RELAXED);
+    while (value > max && !current->max.compareExchange(max, value, thread::MO_RELAXED))
+        ;
+}
+
+HistogramSnapshot Histogram::snapshot() const
+{
+    HistogramSnapshot result;
+
+    for (unsigned int i = 0; i < ShardCount; ++i) {
+        HistogramShard *current = m_shards[i].load(thread::MO_ACQUIRE);
+        if (!current)
+            continue;
+
+        for (unsigned int j = 0; j < BucketCount; ++j) {
+            unsigned long long count = current->buckets[j].load(thread::MO_RELAXED);
+            result.m_buckets[j] += count;
+            result.m_count += count;
+        }
+        result.m_sum += current->sum.load(thread::MO_RELAXED);
+
+        unsigned long long max = current->max.load(thread::MO_RELAXED);
+        if (max > result.m_max)
+            result.m_max = max;
+    }
+
+    return result;
+}
+
+void Histogram::reset()
+{
+    for (unsigned int i = 0; i < ShardCount; ++i) {
+        HistogramShard *current = m_shards[i].load(thread::MO_ACQUIRE);
+        if (!current)
+            continue;
+
+        for (unsigned int j = 0; j < BucketCount; ++j)
+            current->buckets[j].store(0, thread::MO_RELAXED);
+        current->sum.store(0, thread::MO_RELAXED);
+        current->max.store(0, thread::MO_RELAXED);
+    }
+}
+
+unsigned int Histogram::bucketIndex(unsigned long long value)
+{
+    if (value < (1ULL << SubBucketBits))
+        return static_cast<unsigned int>(value);
+
+    // the position of the highest bit determines the power of two, the next
+    // SubBucketBits bits the linear bucket within it
+    unsigned int shift = 63 - __builtin_clzll(value) - SubBucketBits;
+    return ((shift + 1) << SubBucketBits) +
+           static_cast<unsigned int>((value >> shift) - (1ULL << SubBucketBits));
+}
+
+unsigned long long Histogram::bucketUpperBound(unsigned int index)
+{
+    if (index < (1U << SubBucketBits))
+        return index;
+
+    unsigned int shift = (index >> SubBucketBits) - 1;
+    unsigned long long sub = index & ((1U << SubBucketBits) - 1);
+    unsigned long long lower = ((1ULL << SubBucketBits) + sub) << shift;
+
+    return lower + ((1ULL << shift) - 1);
+}
+
+HistogramShard *Histogram::shard()
+{
+    thread::Atomic<HistogramShard *> &slot = m_shards[currentShard()];
+
+    HistogramShard *current = slot.load(thread::MO_ACQUIRE);
+    if (current)
+        return current;
+
+    HistogramShard *created = new HistogramShard;
+    if (slot.compareExchange(current, created, thread::MO_ACQ_REL))
+        return created;
+
+    // another thread of the same shard was faster
+    delete created;
+    return current;
+}
+
+/* }}} */
+/* ScopedTimer {{{ */
+
+unsigned long long ScopedTimer::now()
+{
+    return monotonicNanoseconds();
+}
+
+/* }}} */
+
+} // end namespace metrics
+} // end namespace bw
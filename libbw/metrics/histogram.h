@@ -0,0 +1,252 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_METRICS_HISTOGRAM_H_
+#define LIBBW_METRICS_HISTOGRAM_H_
+
+#include <vector>
+
+#include <libbw/noncopyable.h>
+#include <libbw/thread/atomic.h>
+
+namespace bw {
+namespace metrics {
+
+struct HistogramShard;
+
+/* HistogramSnapshot {{{ */
+
+/**
+ * \class HistogramSnapshot histogram.h libbw/metrics/histogram.h
+ * \brief Merged contents of one or more Histogram objects
+ *
+ * \ingroup metrics
+ */
+class HistogramSnapshot {
+
+public:
+    /**
+     * \brief Creates an empty snapshot
+     */
+    HistogramSnapshot();
+
+public:
+    /**
+     * \brief Adds the samples of \p other
+     *
+     * \param[in] other another snapshot
+     */
+    void merge(const HistogramSnapshot &other);
+
+    /**
+     * \brief Returns the number of samples
+     *
+     * \return the number of samples
+     */
+    unsigned long long count() const;
+
+    /**
+     * \brief Returns the average of all samples
+     *
+     * \return the exact mean, 0 if there are no samples
+     */
+    double mean() const;
+
+    /**
+     * \brief Returns the largest sample
+     *
+     * \return the exact maximum, 0 if there are no samples
+     */
+    unsigned long long max() const;
+
+    /**
+     * \brief Returns a percentile
+     *
+     * \param[in] percent the percentile between 0 and 100, e.g. 99.9
+     * \return the highest value that is equivalent to the sample at that percentile, i.e.
+     *         the result is at most one bucket width (about 3 %) too high
+     */
+    unsigned long long percentile(double percent) const;
+
+private:
+    friend class Histogram;
+
+    std::vector<unsigned long long> m_buckets;
+    unsigned long long              m_count;
+    unsigned long long              m_sum;
+    unsigned long long              m_max;
+};
+
+/* }}} */
+/* Histogram {{{ */
+
+/**
+ * \class Histogram histogram.h libbw/metrics/histogram.h
+ * \brief Log-linear histogram for latencies and sizes
+ *
+ * The value range is divided into powers of two, and each power of two into 32 linear
+ * buckets (the layout of HdrHistogram with about 3 % relative error). Values up to 31 are
+ * stored exactly. The full range of <tt>unsigned long long</tt> is covered.
+ *
+ * Each thread records into its own shard, which is allocated on first use, so record()
+ * costs a few uncontended atomic operations and never takes a lock. snapshot() merges the
+ * shards.
+ *
+ * \ingroup metrics
+ */
+class Histogram : private Noncopyable {
+
+public:
+    /**
+     * \brief Number of linear buckets per power of two, as exponent of two
+     */
+    static const unsigned int SubBucketBits = 5;
+
+    /**
+     * \brief Total number of buckets
+     */
+    static const unsigned int BucketCount = (64 - SubBucketBits + 1) << SubBucketBits;
+
+public:
+    /**
+     * \brief Creates an empty histogram
+     */
+    Histogram();
+
+    /**
+     * \brief Destructor
+     */
+    ~Histogram();
+
+public:
+    /**
+     * \brief Records a sample
+     *
+     * \param[in] value the sample, for example a latency in nanoseconds
+     */
+    void record(unsigned long long value);
+
+    /**
+     * \brief Returns the merged samples of all threads
+     *
+     * \return the snapshot
+     */
+    HistogramSnapshot snapshot() const;
+
+    /**
+     * \brief Removes all samples
+     *
+     * Samples that are recorded concurrently may get lost.
+     */
+    void reset();
+
+    /**
+     * \brief Returns the bucket of a value
+     *
+     * \param[in] value the value
+     * \return the bucket index, less than BucketCount
+     */
+    static unsigned int bucketIndex(unsigned long long value);
+
+    /**
+     * \brief Returns the largest value of a bucket
+     *
+     * \param[in] index the bucket index
+     * \return the largest value that bucketIndex() maps to \p index
+     */
+    static unsigned long long bucketUpperBound(unsigned int index);
+
+private:
+    HistogramShard *shard();
+
+private:
+    thread::Atomic<HistogramShard *> *m_shards;
+};
+
+/* }}} */
+/* ScopedTimer {{{ */
+
+/**
+ * \class ScopedTimer histogram.h libbw/metrics/histogram.h
+ * \brief Records the lifetime of a scope in a Histogram
+ *
+ * Example:
+ *
+ * \code
+ * static bw::metrics::Histogram *latency =
+ *     bw::metrics::Registry::instance()->histogram("request_ns");
+ *
+ * void handleRequest()
+ * {
+ *     bw::metrics::ScopedTimer timer(latency);
+ *     // ...
+ * }
+ * \endcode
+ *
+ * \ingroup metrics
+ */
+class ScopedTimer : private Noncopyable {
+
+public:
+    /**
+     * \brief Starts the timer
+     *
+     * \param[in] histogram the histogram that receives the elapsed nanoseconds
+     */
+    explicit ScopedTimer(Histogram *histogram)
+        : m_histogram(histogram)
+        , m_start(now())
+    {}
+
+    /**
+     * \brief Stops the timer and records the elapsed time
+     */
+    ~ScopedTimer()
+    {
+        m_histogram->record(now() - m_start);
+    }
+
+public:
+    /**
+     * \brief Returns a monotonic timestamp
+     *
+     * \return the time in nanoseconds since an unspecified point in the past
+     */
+    static unsigned long long now();
+
+private:
+    Histogram           *m_histogram;
+    unsigned long long  m_start;
+};
+
+/* }}} */
+
+} // end namespace metrics
+} // end namespace bw
+
+#endif /* LIBBW_METRICS_HISTOGRAM_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
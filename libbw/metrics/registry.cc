@@ -0,0 +1,153 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdio>
+
+#include <libbw/thread/mutexlocker.h>
+
+#include "registry.h"
+#include "stringutil.h"
+
+namespace bw {
+namespace metrics {
+
+/* Helper functions {{{ */
+
+/**
+ * \brief Returns the metric with \p name from \p map, creating it if necessary
+ */
+template <typename T>
+static T *findOrCreate(std::map<std::string, T *> &map, const std::string &name)
+{
+    typename std::map<std::string, T *>::iterator it = map.find(name);
+    if (it != map.end())
+        return it->second;
+
+    T *metric = new T;
+    map[name] = metric;
+    return metric;
+}
+
+/* }}} */
+/* Registry {{{ */
+
+Registry *Registry::instance()
+{
+    static Registry *s_instance = new Registry;
+
+    return s_instance;
+}
+
+Registry::Registry()
+{}
+
+Counter *Registry::counter(const std::string &name)
+{
+    thread::MutexLocker locker(&m_mutex);
+    return findOrCreate(m_counters, name);
+}
+
+Gauge *Registry::gauge(const std::string &name)
+{
+    thread::MutexLocker locker(&m_mutex);
+    return findOrCreate(m_gauges, name);
+}
+
+Histogram *Registry::histogram(const std::string &name)
+{
+    thread::MutexLocker locker(&m_mutex);
+    return findOrCreate(m_histograms, name);
+}
+
+void Registry::dump(std::FILE *file)
+{
+    std::string lines = formatLines();
+    std::fwrite(lines.data(), 1, lines.size(), file);
+    std::fflush(file);
+}
+
+bool Registry::dump(const char *filename)
+{
+    std::FILE *file = std::fopen(filename, "a");
+    if (!file)
+        return false;
+
+    dump(file);
+    std::fclose(file);
+    return true;
+}
+
+void Registry::dumpToErrorlog(Errorlog::Level level)
+{
+    Errorlog *log = Errorlog::instance();
+    if (!log)
+        return;
+
+    std::vector<std::string> lines = stringsplit(formatLines(), "\n");
+    for (size_t i = 0; i < lines.size(); ++i)
+        if (!lines[i].empty())
+            log->log(level, "%s", lines[i].c_str());
+}
+
+std::string Registry::formatLines()
+{
+    thread::MutexLocker locker(&m_mutex);
+    std::string result;
+    char line[512];
+
+    for (std::map<std::string, Counter *>::const_iterator it = m_counters.begin();
+            it != m_counters.end(); ++it) {
+        std::snprintf(line, sizeof(line), "counter %s %llu\n", it->first.c_str(),
+                      it->second->value());
+        result += line;
+    }
+
+    for (std::map<std::string, Gauge *>::const_iterator it = m_gauges.begin();
+            it != m_gauges.end(); ++it) {
+        std::snprintf(line, sizeof(line), "gauge %s %lld\n", it->first.c_str(),
+                      it->second->value());
+        result += line;
+    }
+
+    for (std::map<std::string, Histogram *>::const_iterator it = m_histograms.begin();
+            it != m_histograms.end(); ++it) {
+        HistogramSnapshot snapshot = it->second->snapshot();
+        std::snprintf(line, sizeof(line),
+                      "histogram %s count=%llu mean=%.1f p50=%llu p90=%llu p99=%llu "
+                      "p99.9=%llu max=%llu\n",
+                      it->first.c_str(), snapshot.count(), snapshot.mean(),
+                      snapshot.percentile(50), snapshot.percentile(90),
+                      snapshot.percentile(99), snapshot.percentile(99.9), snapshot.max());
+        result += line;
+    }
+
+    return result;
+}
+
+/* }}} */
+
+} // end namespace metrics
+} // end namespace bw
@@ -0,0 +1,150 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_METRICS_REGISTRY_H_
+#define LIBBW_METRICS_REGISTRY_H_
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include <libbw/noncopyable.h>
+#include <libbw/log/errorlog.h>
+#include <libbw/thread/mutex.h>
+
+#include "counter.h"
+#include "histogram.h"
+
+namespace bw {
+namespace metrics {
+
+/* Registry {{{ */
+
+/**
+ * \class Registry registry.h libbw/metrics/registry.h
+ * \brief Named metrics of the process
+ *
+ * The registry creates the metrics on first request and owns them for the lifetime of the
+ * process, so the returned pointers can be kept in static variables. Looking up a metric
+ * takes a lock, updating it doesn't.
+ *
+ * Example:
+ *
+ * \code
+ * static bw::metrics::Counter *requests =
+ *     bw::metrics::Registry::instance()->counter("requests");
+ *
+ * requests->add();
+ * // ...
+ * bw::metrics::Registry::instance()->dump(stderr);
+ * \endcode
+ *
+ * \ingroup metrics
+ */
+class Registry : private Noncopyable {
+
+public:
+    /**
+     * \brief Returns the only instance
+     *
+     * \return the registry
+     */
+    static Registry *instance();
+
+public:
+    /**
+     * \brief Returns a counter
+     *
+     * \param[in] name the name of the counter
+     * \return the counter, created on the first call with \p name
+     */
+    Counter *counter(const std::string &name);
+
+    /**
+     * \brief Returns a gauge
+     *
+     * \param[in] name the name of the gauge
+     * \return the gauge, created on the first call with \p name
+     */
+    Gauge *gauge(const std::string &name);
+
+    /**
+     * \brief Returns a histogram
+     *
+     * \param[in] name the name of the histogram
+     * \return the histogram, created on the first call with \p name
+     */
+    Histogram *histogram(const std::string &name);
+
+    /**
+     * \brief Writes all metrics to a file
+     *
+     * One line per metric, sorted by name, for example
+     * <tt>histogram request_ns count=10 mean=1200.0 p50=1023 p90=2047 p99=4095
+     * p99.9=4095 max=4000</tt>.
+     *
+     * \param[in] file the output file
+     */
+    void dump(std::FILE *file);
+
+    /**
+     * \brief Appends all metrics to a file
+     *
+     * \param[in] filename the name of the file
+     * \return \c true on success, \c false if the file cannot be opened
+     */
+    bool dump(const char *filename);
+
+    /**
+     * \brief Writes all metrics to the error log
+     *
+     * Does nothing if Errorlog has not been configured.
+     *
+     * \param[in] level the level of the messages
+     */
+    void dumpToErrorlog(Errorlog::Level level=Errorlog::LS_WARNING);
+
+protected:
+    Registry();
+
+private:
+    std::string formatLines();
+
+private:
+    thread::Mutex                           m_mutex;
+    std::map<std::string, Counter *>        m_counters;
+    std::map<std::string, Gauge *>          m_gauges;
+    std::map<std::string, Histogram *>      m_histograms;
+};
+
+/* }}} */
+
+} // end namespace metrics
+} // end namespace bw
+
+#endif /* LIBBW_METRICS_REGISTRY_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,63 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_METRICS_SHARD_H_
+#define LIBBW_METRICS_SHARD_H_
+
+namespace bw {
+namespace metrics {
+
+/* Shards {{{ */
+
+/**
+ * \brief Number of per-thread shards of each metric
+ *
+ * Each metric keeps this many independent copies of its data. A thread always updates the
+ * same shard, so threads don't share cache lines unless there are more threads than
+ * shards. Reading a metric merges all shards.
+ *
+ * \ingroup metrics
+ */
+static const unsigned int ShardCount = 64;
+
+/**
+ * \brief Returns the shard of the calling thread
+ *
+ * The value is assigned on the first call in each thread and never changes.
+ *
+ * \return a number between 0 and ShardCount - 1
+ * \ingroup metrics
+ */
+unsigned int currentShard();
+
+/* }}} */
+
+} // end namespace metrics
+} // end namespace bw
+
+#endif /* LIBBW_METRICS_SHARD_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -104,7 +104,7 @@ Option::Option()
 
 Option::Option(const std::string &name, char letter, OptionType type,
                const std::string &description)
-    : m_longName(name)
+    : m_longName(intern(name))
     , m_description(description)
     , m_letter(letter)
     , m_type(type)
@@ -112,10 +112,15 @@ Option::Option(const std::string &name, char letter, OptionType type,
 
 void Option::setLongName(const std::string &name)
 {
-    m_longName = name;
+    m_longName = intern(name);
 }
 
 std::string Option::getLongName() const
+{
+    return m_longName.str();
+}
+
+InternedString Option::getInternedLongName() const
 {
     return m_longName;
 }
@@ -245,40 +250,48 @@ void OptionParser::addOptions(const OptionGroup &group)
 }
 
 bool OptionParser::parse(int argc, char *argv[])
+{
+    char buffer[1024];
+    Arena arena(buffer, sizeof(buffer));
+    return parse(argc, argv, arena);
+}
+
+bool OptionParser::parse(int argc, char *argv[], Arena &arena)
 {
     struct option *cur, *opt;
-    std::string   getopt_string;
     int totalNumber = calcTotalNumberOfOptions();
 
-    opt = new option[totalNumber + 1];
-    if (!opt) {
-        std::cerr << "OptionParser::parse(): malloc failed" << std::endl;
-        return false;
-    }
+    opt = static_cast<struct option *>(arena.allocate(sizeof(option) * (totalNumber + 1)));
     cur = opt;
 
+    // each option needs at most 2 characters
+    char *getopt_string = static_cast<char *>(arena.allocate(2 * totalNumber + 1, 1));
+    char *getopt_cur = getopt_string;
+
     for (std::vector<OptionGroup>::const_iterator it = m_options.begin();
             it != m_options.end(); ++it) {
 
-        const std::vector<Option> options = it->options();
+        const std::vector<Option> &options = it->options();
 
         for (std::vector<Option>::const_iterator opIter = options.begin();
                 opIter != options.end(); ++opIter) {
 
-            const Option opt = *opIter;
-            cur->name = strdup(opt.getLongName().c_str());
-            cur->has_arg = opt.getType() != OT_FLAG;
+            const Option &op = *opIter;
+            // the interned name stays valid, no need to copy it
+            cur->name = op.getInternedLongName().c_str();
+            cur->has_arg = op.getType() != OT_FLAG;
             cur->flag = 0;
-            cur->val = opt.getLetter();
+            cur->val = op.getLetter();
 
-            getopt_string += opt.getLetter();
-            if (opt.getType() != OT_FLAG)
-                getopt_string += ":";
+            *getopt_cur++ = op.getLetter();
+            if (op.getType() != OT_FLAG)
+                *getopt_cur++ = ':';
 
             cur++;
         }
     }
     memset(cur, 0, sizeof(option));
+    *getopt_cur = '\0';
 
     // now parse the options
     int c;
@@ -286,7 +299,7 @@ bool OptionParser::parse(int argc, char *argv[])
     for (;;) {
         int option_index = 0;
 
-        c = getopt_long(argc, argv, getopt_string.c_str(),
+        c = getopt_long(argc, argv, getopt_string,
                 opt, &option_index);
         if (c == -1)
             break;
@@ -326,14 +339,6 @@ bool OptionParser::parse(int argc, char *argv[])
         while (optind < argc)
             m_args.push_back(argv[optind++]);
 
-    // free stuff
-    cur = opt;
-    for (int i = 0; i < totalNumber; i++) {
-        free((void *)cur->name);
-        cur++;
-    }
-    delete[] opt;
-
     return true;
 }
 
@@ -342,14 +347,14 @@ OptionValue OptionParser::getValue(const std::string &name)
     for (std::vector<OptionGroup>::const_iterator it = m_options.begin();
             it != m_options.end(); ++it) {
 
-        const std::vector<Option> options = it->options();
+        const std::vector<Option> &options = it->options();
 
         for (std::vector<Option>::const_iterator opIter = options.begin();
                 opIter != options.end(); ++opIter) {
 
             const Option &op = *opIter;
 
-            if (op.getLongName() == name)
+            if (op.getInternedLongName().view() == name)
                 return op.getValue();
         }
     }
@@ -408,14 +413,14 @@ void OptionParser::printHelp(std::ostream &os, const std::string &name) const
         if (!group.getTitle().empty())
              os << group.getTitle() << ":" << std::endl;
 
-        const std::vector<Option> options = it->options();
+        const std::vector<Option> &options = it->options();
 
         for (std::vector<Option>::const_iterator opIter = options.begin();
                 opIter != options.end(); ++opIter) {
 
             const Option &opt = *opIter;
 
-            os << "    --" << opt.getLongName();
+            os << "    --" << opt.getInternedLongName();
             std::string placeholder = opt.getPlaceholder();
             if (placeholder.length() > 0)
                 os << "=" << opt.getPlaceholder();
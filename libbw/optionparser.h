@@ -50,6 +50,8 @@
 #include <string>
 #include <vector>
 
+#include <libbw/stringutil.h>
+
 namespace bw {
 
 /* OptionType {{{ */
@@ -254,6 +256,16 @@ public:
      */
     std::string getLongName() const;
 
+    /**
+     * \brief Returns the long name without copying it
+     *
+     * The name is stored in the global StringPool, so options with the same name share
+     * the characters, and the handle can be compared in O(1).
+     *
+     * \return the long name
+     */
+    InternedString getInternedLongName() const;
+
     /**
      * \brief Set the short letter
      *
@@ -360,7 +372,7 @@ public:
     std::string getPlaceholder() const;
 
 private:
-    std::string m_longName;
+    InternedString m_longName;
     std::string m_description;
     char        m_letter;
     OptionType  m_type;
@@ -739,6 +751,23 @@ public:
      */
     bool parse(int argc, char *argv[]);
 
+    /**
+     * \brief Parses the command line arguments with temporary memory from an arena
+     *
+     * Like parse(int, char *[]), but the option table that is passed to getopt_long()
+     * is allocated from \p arena. That's useful if many command lines are parsed, e.g.
+     * commands received over a socket, with an arena that is reset after each request.
+     * parse(int, char *[]) uses an arena on the stack.
+     *
+     * \param[in] argc the number of arguments
+     * \param[in] argv the argument vector, being the program name the
+     *            0-th element (i.e. ignored)
+     * \param[in] arena the arena for temporary memory
+     * \return \c true if the command line has been parsed successfully,
+     *         \c false if the command line did contain options that are invalid
+     */
+    bool parse(int argc, char *argv[], Arena &arena);
+
     /**
      * \brief Returns the option value for a option
      *
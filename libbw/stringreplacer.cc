@@ -0,0 +1,322 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "stringreplacer.h"
+#include "stringscan.h"
+
+namespace bw {
+
+/* Helper functions {{{ */
+
+/**
+ * \brief Largest number of start characters that is skipped with findAnyOf()
+ */
+static const size_t MaxVectorSkip = 16;
+
+/**
+ * \brief Number of characters that StringReplacer::skip() checks before using findAnyOf()
+ */
+static const ptrdiff_t ScalarSkip = 16;
+
+/**
+ * \brief Sink for StringReplacer::scan() that only counts the output size
+ */
+struct SizeSink {
+    SizeSink()
+        : size(0)
+    {}
+
+    void append(const char *, size_t length)
+    {
+        size += length;
+    }
+
+    size_t size;
+};
+
+/**
+ * \brief Sink for StringReplacer::scan() that writes into a buffer that is large enough
+ */
+struct BufferSink {
+    BufferSink(char *buffer)
+        : p(buffer)
+    {}
+
+    void append(const char *str, size_t length)
+    {
+        std::memcpy(p, str, length);
+        p += length;
+    }
+
+    char *p;
+};
+
+/* }}} */
+/* StringReplacer {{{ */
+
+StringReplacer::StringReplacer()
+{
+    build();
+}
+
+void StringReplacer::add(const StringView &pattern, const StringView &replacement)
+{
+    if (pattern.empty())
+        return;
+
+    for (size_t i = 0; i < m_patterns.size(); ++i) {
+        if (pattern == m_patterns[i]) {
+            m_replacements[i] = replacement.str();
+            return;
+        }
+    }
+
+    m_patterns.push_back(pattern.str());
+    m_lengths.push_back(pattern.size());
+    m_replacements.push_back(replacement.str());
+    build();
+}
+
+void StringReplacer::add(char c, const StringView &replacement)
+{
+    add(StringView(&c, 1), replacement);
+}
+
+bool StringReplacer::empty() const
+{
+    return m_patterns.empty();
+}
+
+size_t StringReplacer::replacedSize(const StringView &input) const
+{
+    SizeSink sink;
+    scan(input, sink);
+    return sink.size;
+}
+
+std::string StringReplacer::replace(const StringView &input) const
+{
+    std::string result;
+    replace(input, result);
+    return result;
+}
+
+size_t StringReplacer::replace(const StringView &input, std::string &output) const
+{
+    SizeSink sizeSink;
+    size_t count = scan(input, sizeSink);
+    if (count == 0) {
+        output.append(input.data(), input.size());
+        return 0;
+    }
+
+    size_t oldSize = output.size();
+    output.resize(oldSize + sizeSink.size);
+    if (sizeSink.size > 0) {
+        BufferSink bufferSink(&output[oldSize]);
+        scan(input, bufferSink);
+    }
+
+    return count;
+}
+
+/*
+ * The input characters are mapped to classes first: class 0 for all characters that don't
+ * occur in any pattern, and one class for each other character. That keeps the transition
+ * table small for the typical case of a few short patterns.
+ *
+ * m_next[state * m_classes + class] is the complete transition function of the automaton,
+ * i.e. the trie edges with the failure links already resolved, so scanning needs exactly
+ * one table lookup per character. m_depth is the length of the prefix that a state
+ * represents, and m_output the longest pattern that is a suffix of it, or -1.
+ */
+void StringReplacer::build()
+{
+    std::memset(m_classOf, 0, sizeof(m_classOf));
+    std::memset(m_isFirstChar, 0, sizeof(m_isFirstChar));
+    m_classes = 1;
+    m_firstChars.clear();
+
+    for (size_t i = 0; i < m_patterns.size(); ++i) {
+        const std::string &pattern = m_patterns[i];
+        for (size_t j = 0; j < pattern.size(); ++j) {
+            unsigned char c = pattern[j];
+            if (m_classOf[c] == 0)
+                m_classOf[c] = m_classes++;
+        }
+
+        unsigned char first = pattern[0];
+        if (!m_isFirstChar[first]) {
+            m_isFirstChar[first] = true;
+            m_firstChars += pattern[0];
+        }
+    }
+
+    // trie
+    m_next.assign(m_classes, -1);
+    m_depth.assign(1, 0);
+    m_output.assign(1, -1);
+
+    for (size_t i = 0; i < m_patterns.size(); ++i) {
+        const std::string &pattern = m_patterns[i];
+        int state = 0;
+        for (size_t j = 0; j < pattern.size(); ++j) {
+            size_t edge = state * m_classes + m_classOf[static_cast<unsigned char>(pattern[j])];
+            if (m_next[edge] < 0) {
+                m_next[edge] = m_depth.size();
+                m_next.resize(m_next.size() + m_classes, -1);
+                m_depth.push_back(m_depth[state] + 1);
+                m_output.push_back(-1);
+            }
+            state = m_next[edge];
+        }
+        m_output[state] = i;
+    }
+
+    // failure links in breadth-first order, so that the failure state of each state is
+    // complete when the state is processed
+    std::vector<int> fail(m_depth.size(), 0);
+    std::vector<int> queue;
+    queue.reserve(m_depth.size());
+
+    for (size_t c = 0; c < m_classes; ++c) {
+        if (m_next[c] < 0)
+            m_next[c] = 0;
+        else
+            queue.push_back(m_next[c]);
+    }
+
+    for (size_t head = 0; head < queue.size(); ++head) {
+        int state = queue[head];
+        if (m_output[state] < 0)
+            m_output[state] = m_output[fail[state]];
+
+        for (size_t c = 0; c < m_classes; ++c) {
+            int &next = m_next[state * m_classes + c];
+            int fallback = m_next[fail[state] * m_classes + c];
+            if (next < 0)
+                next = fallback;
+            else {
+                fail[next] = fallback;
+                queue.push_back(next);
+            }
+        }
+    }
+}
+
+const char *StringReplacer::skip(const char *begin, const char *end) const
+{
+    // in text that needs escaping, the next match is often close, and then a table lookup
+    // is cheaper than setting up the vector search
+    const char *scalarEnd = end - begin > ScalarSkip ? begin + ScalarSkip : end;
+    for (; begin != scalarEnd; ++begin) {
+        if (m_isFirstChar[static_cast<unsigned char>(*begin)])
+            return begin;
+    }
+    if (begin == end)
+        return end;
+
+    if (m_firstChars.size() <= MaxVectorSkip)
+        return findAnyOf(begin, end, m_firstChars.data(), m_firstChars.size());
+
+    while (begin != end && !m_isFirstChar[static_cast<unsigned char>(*begin)])
+        ++begin;
+    return begin;
+}
+
+template <typename Sink>
+size_t StringReplacer::scan(const StringView &input, Sink &sink) const
+{
+    if (m_patterns.empty()) {
+        sink.append(input.data(), input.size());
+        return 0;
+    }
+
+    // local copies, the compiler cannot know that the sink doesn't modify the members
+    const unsigned short *classOf = m_classOf;
+    const size_t classes = m_classes;
+    const int *next = &m_next[0];
+    const int *depth = &m_depth[0];
+    const int *output = &m_output[0];
+    const size_t *lengths = &m_lengths[0];
+
+    const char *p = input.data();
+    const char *end = p + input.size();
+    const char *copied = p;
+    size_t count = 0;
+
+    while ((p = skip(p, end)) != end) {
+        int state = 0;
+        int match = -1;
+        const char *matchBegin = NULL;
+        const char *q;
+
+        for (q = p; q != end; ++q) {
+            state = next[state * classes + classOf[static_cast<unsigned char>(*q)]];
+
+            // no pattern that starts at or before the current match can still end later
+            const char *stateBegin = q + 1 - depth[state];
+            if (match >= 0 && stateBegin > matchBegin)
+                break;
+            if (state == 0)
+                break;
+
+            int found = output[state];
+            if (found >= 0) {
+                const char *foundBegin = q + 1 - lengths[found];
+                if (match < 0 || foundBegin <= matchBegin) {
+                    match = found;
+                    matchBegin = foundBegin;
+                }
+            }
+        }
+
+        if (match < 0) {
+            // the character at q cannot start a pattern
+            p = q == end ? end : q + 1;
+            continue;
+        }
+
+        const std::string &replacement = m_replacements[match];
+        sink.append(copied, matchBegin - copied);
+        sink.append(replacement.data(), replacement.size());
+        p = copied = matchBegin + lengths[match];
+        ++count;
+    }
+    sink.append(copied, end - copied);
+
+    return count;
+}
+
+/* }}} */
+
+} // end namespace bw
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,161 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_STRINGREPLACER_H_
+#define LIBBW_STRINGREPLACER_H_
+
+#include <string>
+#include <vector>
+
+#include <libbw/stringview.h>
+
+namespace bw {
+
+/* StringReplacer {{{ */
+
+/**
+ * \class StringReplacer stringreplacer.h libbw/stringreplacer.h
+ * \brief Replaces many substrings in one pass
+ *
+ * The patterns are compiled into an Aho-Corasick automaton, so the input is scanned once
+ * regardless of the number of patterns. Text that cannot start a match is skipped with the
+ * vectorized findAnyOf() if at most 16 different characters start a pattern.
+ *
+ * Matches are leftmost-longest and don't overlap: at each position, the longest pattern
+ * that starts there is replaced, and scanning continues behind it, so replaced text is
+ * never scanned again. For example, with the patterns <tt>"\r\n"</tt> and <tt>"\n"</tt>,
+ * a CRLF is replaced by the replacement of <tt>"\r\n"</tt>.
+ *
+ * Example that escapes a record:
+ *
+ * \code
+ * bw::StringReplacer escaper;
+ * escaper.add('\\', "\\\\");
+ * escaper.add('"', "\\\"");
+ * escaper.add('\n', "\\n");
+ *
+ * std::string line;
+ * escaper.replace(record, line);
+ * \endcode
+ *
+ * Each add() rebuilds the automaton, so a replacer is meant to be set up once and then
+ * reused. The const member functions can be called from several threads at the same time.
+ *
+ * \ingroup string
+ */
+class StringReplacer {
+
+public:
+    /**
+     * \brief Creates a replacer without patterns
+     */
+    StringReplacer();
+
+    /**
+     * \brief Adds a pattern
+     *
+     * If \p pattern has been added before, its replacement is changed. Empty patterns are
+     * ignored. Both strings are copied.
+     *
+     * \param[in] pattern the text to search
+     * \param[in] replacement the text that replaces \p pattern
+     */
+    void add(const StringView &pattern, const StringView &replacement);
+
+    /**
+     * \brief Adds a single character pattern
+     *
+     * \param[in] c the character to search
+     * \param[in] replacement the text that replaces \p c
+     */
+    void add(char c, const StringView &replacement);
+
+    /**
+     * \brief Checks if patterns have been added
+     *
+     * \return \c true if there are no patterns
+     */
+    bool empty() const;
+
+    /**
+     * \brief Computes the size of the replaced string
+     *
+     * \param[in] input the input string
+     * \return the length of replace(\p input)
+     */
+    size_t replacedSize(const StringView &input) const;
+
+    /**
+     * \brief Replaces all patterns
+     *
+     * \param[in] input the input string
+     * \return the replaced string
+     */
+    std::string replace(const StringView &input) const;
+
+    /**
+     * \brief Replaces all patterns and appends the result
+     *
+     * The output size is computed first, so \p output grows at most once, and not at all if
+     * its capacity is large enough. \p input must not point into \p output.
+     *
+     * \param[in] input the input string
+     * \param[in,out] output the string the result is appended to
+     * \return the number of replacements
+     */
+    size_t replace(const StringView &input, std::string &output) const;
+
+private:
+    void build();
+    const char *skip(const char *begin, const char *end) const;
+
+    template <typename Sink>
+    size_t scan(const StringView &input, Sink &sink) const;
+
+private:
+    std::vector<std::string> m_patterns;
+    std::vector<size_t> m_lengths;
+    std::vector<std::string> m_replacements;
+
+    // the automaton, see build()
+    unsigned short m_classOf[256];
+    size_t m_classes;
+    std::vector<int> m_next;
+    std::vector<int> m_depth;
+    std::vector<int> m_output;
+
+    // characters that start a pattern
+    std::string m_firstChars;
+    bool m_isFirstChar[256];
+};
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_STRINGREPLACER_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
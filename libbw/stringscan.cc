@@ -0,0 +1,598 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstdlib>
+#include <cstring>
+
+#include "bwconfig.h"
+#include "compiler.h"
+#include "stringscan.h"
+
+#if defined(__SSE2__)
+#  include <emmintrin.h>
+#  define BW_STRINGSCAN_SSE2
+#endif
+#if defined(HAVE_AVX2_DISPATCH) && defined(BW_STRINGSCAN_SSE2)
+#  include <immintrin.h>
+#  define BW_STRINGSCAN_AVX2
+#endif
+
+namespace bw {
+
+/* Helper functions {{{ */
+
+/**
+ * \brief Largest character set that is compared with vector instructions
+ */
+static const size_t MaxVectorSet = 16;
+
+/**
+ * \brief Small character set, checked by comparing with each character
+ */
+struct SmallCharSet {
+    SmallCharSet(const char *set, size_t size)
+        : set(set)
+        , size(size)
+    {}
+
+    bool contains(char c) const
+    {
+        for (size_t i = 0; i < size; ++i)
+            if (set[i] == c)
+                return true;
+        return false;
+    }
+
+    const char  *set;
+    size_t      size;
+};
+
+/**
+ * \brief Large character set, checked with a bitmap
+ */
+struct TableCharSet {
+    TableCharSet(const char *set, size_t size)
+    {
+        std::memset(bits, 0, sizeof(bits));
+        for (size_t i = 0; i < size; ++i) {
+            unsigned char c = static_cast<unsigned char>(set[i]);
+            bits[c >> 3] |= 1 << (c & 7);
+        }
+    }
+
+    bool contains(char c) const
+    {
+        unsigned char uc = static_cast<unsigned char>(c);
+        return (bits[uc >> 3] & (1 << (uc & 7))) != 0;
+    }
+
+    unsigned char bits[32];
+};
+
+template <typename CharSet>
+static const char *scalarFind(const char *begin, const char *end, const CharSet &set,
+                              bool wanted)
+{
+    for (const char *p = begin; p != end; ++p)
+        if (set.contains(*p) == wanted)
+            return p;
+    return end;
+}
+
+template <typename CharSet>
+static const char *scalarFindLast(const char *begin, const char *end, const CharSet &set)
+{
+    for (const char *p = end; p != begin; --p)
+        if (!set.contains(p[-1]))
+            return p - 1;
+    return end;
+}
+
+/* }}} */
+/* Scalar implementation {{{ */
+
+static const char *scalarFindAnyOf(const char *begin, const char *end, const char *set,
+                                   size_t setSize)
+{
+    if (setSize > MaxVectorSet)
+        return scalarFind(begin, end, TableCharSet(set, setSize), true);
+    return scalarFind(begin, end, SmallCharSet(set, setSize), true);
+}
+
+static const char *scalarFindFirstNotOf(const char *begin, const char *end, const char *set,
+                                        size_t setSize)
+{
+    if (setSize > MaxVectorSet)
+        return scalarFind(begin, end, TableCharSet(set, setSize), false);
+    return scalarFind(begin, end, SmallCharSet(set, setSize), false);
+}
+
+static const char *scalarFindLastNotOf(const char *begin, const char *end, const char *set,
+                                       size_t setSize)
+{
+    if (setSize > MaxVectorSet)
+        return scalarFindLast(begin, end, TableCharSet(set, setSize));
+    return scalarFindLast(begin, end, SmallCharSet(set, setSize));
+}
+
+static size_t scalarCountChar(const char *begin, const char *end, char c)
+{
+    size_t count = 0;
+    for (const char *p = begin; p != end; ++p)
+        count += *p == c;
+    return count;
+}
+
+static inline char foldCase(char c)
+{
+    return static_cast<unsigned char>(c - 'A') < 26 ? c | 0x20 : c;
+}
+
+static bool scalarEqualsIgnoreCase(const char *a, const char *b, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+        if (a[i] != b[i] && foldCase(a[i]) != foldCase(b[i]))
+            return false;
+    return true;
+}
+
+/* }}} */
+/* SSE2 implementation {{{ */
+
+#ifdef BW_STRINGSCAN_SSE2
+
+/**
+ * \brief Returns a bit mask of the bytes of \p chunk that are in the set
+ */
+static inline unsigned int sse2Match(__m128i chunk, const __m128i *set, size_t setSize)
+{
+    __m128i match = _mm_cmpeq_epi8(chunk, set[0]);
+    for (size_t i = 1; i < setSize; ++i)
+        match = _mm_or_si128(match, _mm_cmpeq_epi8(chunk, set[i]));
+    return static_cast<unsigned int>(_mm_movemask_epi8(match));
+}
+
+static const char *sse2Find(const char *begin, const char *end, const char *set,
+                            size_t setSize, bool wanted)
+{
+    __m128i vectors[MaxVectorSet];
+    for (size_t i = 0; i < setSize; ++i)
+        vectors[i] = _mm_set1_epi8(set[i]);
+
+    unsigned int flip = wanted ? 0 : 0xffff;
+    const char *p = begin;
+    for (; end - p >= 16; p += 16) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned int mask = sse2Match(chunk, vectors, setSize) ^ flip;
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+
+    // the last chunk overlaps with bytes that have already been checked
+    if (p != end) {
+        p = end - 16;
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned int mask = sse2Match(chunk, vectors, setSize) ^ flip;
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+
+    return end;
+}
+
+static const char *sse2FindAnyOf(const char *begin, const char *end, const char *set,
+                                 size_t setSize)
+{
+    if (end - begin < 16 || setSize == 0 || setSize > MaxVectorSet)
+        return scalarFindAnyOf(begin, end, set, setSize);
+    return sse2Find(begin, end, set, setSize, true);
+}
+
+static const char *sse2FindFirstNotOf(const char *begin, const char *end, const char *set,
+                                      size_t setSize)
+{
+    if (end - begin < 16 || setSize == 0 || setSize > MaxVectorSet)
+        return scalarFindFirstNotOf(begin, end, set, setSize);
+
+    // strings often don't start with the characters to skip at all
+    if (!SmallCharSet(set, setSize).contains(*begin))
+        return begin;
+    return sse2Find(begin, end, set, setSize, false);
+}
+
+static const char *sse2FindLastNotOf(const char *begin, const char *end, const char *set,
+                                     size_t setSize)
+{
+    if (end - begin < 16 || setSize == 0 || setSize > MaxVectorSet)
+        return scalarFindLastNotOf(begin, end, set, setSize);
+
+    if (!SmallCharSet(set, setSize).contains(end[-1]))
+        return end - 1;
+
+    __m128i vectors[MaxVectorSet];
+    for (size_t i = 0; i < setSize; ++i)
+        vectors[i] = _mm_set1_epi8(set[i]);
+
+    const char *p = end;
+    while (p - begin >= 16) {
+        p -= 16;
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        unsigned int mask = sse2Match(chunk, vectors, setSize) ^ 0xffff;
+        if (mask)
+            return p + 31 - __builtin_clz(mask);
+    }
+
+    // the overlapping bytes are all in the set, so they don't produce a match
+    if (p != begin) {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        unsigned int mask = sse2Match(chunk, vectors, setSize) ^ 0xffff;
+        if (mask)
+            return begin + 31 - __builtin_clz(mask);
+    }
+
+    return end;
+}
+
+static size_t sse2CountChar(const char *begin, const char *end, char c)
+{
+    __m128i needle = _mm_set1_epi8(c);
+    __m128i zero = _mm_setzero_si128();
+    size_t count = 0;
+
+    const char *p = begin;
+    while (end - p >= 16) {
+        // matches are -1, so subtracting them counts per byte, for at most 255 chunks
+        __m128i counts = zero;
+        for (int i = 0; i < 255 && end - p >= 16; ++i, p += 16) {
+            __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+            counts = _mm_sub_epi8(counts, _mm_cmpeq_epi8(chunk, needle));
+        }
+
+        __m128i sums = _mm_sad_epu8(counts, zero);
+        count += _mm_cvtsi128_si32(sums) + _mm_extract_epi16(sums, 4);
+    }
+
+    return count + scalarCountChar(p, end, c);
+}
+
+/**
+ * \brief Converts the uppercase ASCII letters of \p chunk to lowercase
+ */
+static inline __m128i sse2FoldCase(__m128i chunk)
+{
+    // shift 'A'..'Z' to the lowest signed values, so one signed compare checks the range
+    __m128i shifted = _mm_add_epi8(chunk, _mm_set1_epi8(static_cast<char>(0x80 - 'A')));
+    __m128i upper = _mm_cmplt_epi8(shifted, _mm_set1_epi8(static_cast<char>(0x80 + 26)));
+    return _mm_or_si128(chunk, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+}
+
+static inline bool sse2EqualsIgnoreCaseChunk(const char *a, const char *b)
+{
+    __m128i x = sse2FoldCase(_mm_loadu_si128(reinterpret_cast<const __m128i *>(a)));
+    __m128i y = sse2FoldCase(_mm_loadu_si128(reinterpret_cast<const __m128i *>(b)));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) == 0xffff;
+}
+
+static inline __m128i sse2LoadOverlapping8(const char *p, size_t size)
+{
+    __m128i low = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p));
+    __m128i high = _mm_loadl_epi64(reinterpret_cast<const __m128i *>(p + size - 8));
+    return _mm_unpacklo_epi64(low, high);
+}
+
+static bool sse2EqualsIgnoreCase(const char *a, const char *b, size_t size)
+{
+    if (size < 8)
+        return scalarEqualsIgnoreCase(a, b, size);
+
+    // short strings like command names are compared as two overlapping halves
+    if (size < 16) {
+        __m128i x = sse2FoldCase(sse2LoadOverlapping8(a, size));
+        __m128i y = sse2FoldCase(sse2LoadOverlapping8(b, size));
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(x, y)) == 0xffff;
+    }
+
+    size_t i = 0;
+    for (; size - i >= 16; i += 16)
+        if (!sse2EqualsIgnoreCaseChunk(a + i, b + i))
+            return false;
+
+    // the last chunk overlaps with bytes that have already been compared
+    return i == size || sse2EqualsIgnoreCaseChunk(a + size - 16, b + size - 16);
+}
+
+#endif /* BW_STRINGSCAN_SSE2 */
+
+/* }}} */
+/* AVX2 implementation {{{ */
+
+#ifdef BW_STRINGSCAN_AVX2
+
+#define BW_AVX2 __attribute__((target("avx2")))
+
+BW_AVX2
+static inline unsigned int avx2Match(__m256i chunk, const __m256i *set, size_t setSize)
+{
+    __m256i match = _mm256_cmpeq_epi8(chunk, set[0]);
+    for (size_t i = 1; i < setSize; ++i)
+        match = _mm256_or_si256(match, _mm256_cmpeq_epi8(chunk, set[i]));
+    return static_cast<unsigned int>(_mm256_movemask_epi8(match));
+}
+
+BW_AVX2
+static const char *avx2Find(const char *begin, const char *end, const char *set,
+                            size_t setSize, bool wanted)
+{
+    __m256i vectors[MaxVectorSet];
+    for (size_t i = 0; i < setSize; ++i)
+        vectors[i] = _mm256_set1_epi8(set[i]);
+
+    unsigned int flip = wanted ? 0 : 0xffffffff;
+    const char *p = begin;
+    for (; end - p >= 32; p += 32) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        unsigned int mask = avx2Match(chunk, vectors, setSize) ^ flip;
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+
+    // the last chunk overlaps with bytes that have already been checked
+    if (p != end) {
+        p = end - 32;
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        unsigned int mask = avx2Match(chunk, vectors, setSize) ^ flip;
+        if (mask)
+            return p + __builtin_ctz(mask);
+    }
+
+    return end;
+}
+
+BW_AVX2
+static const char *avx2FindAnyOf(const char *begin, const char *end, const char *set,
+                                 size_t setSize)
+{
+    if (end - begin < 32 || setSize == 0 || setSize > MaxVectorSet)
+        return sse2FindAnyOf(begin, end, set, setSize);
+    return avx2Find(begin, end, set, setSize, true);
+}
+
+BW_AVX2
+static const char *avx2FindFirstNotOf(const char *begin, const char *end, const char *set,
+                                      size_t setSize)
+{
+    if (end - begin < 32 || setSize == 0 || setSize > MaxVectorSet)
+        return sse2FindFirstNotOf(begin, end, set, setSize);
+
+    // strings often don't start with the characters to skip at all
+    if (!SmallCharSet(set, setSize).contains(*begin))
+        return begin;
+    return avx2Find(begin, end, set, setSize, false);
+}
+
+BW_AVX2
+static const char *avx2FindLastNotOf(const char *begin, const char *end, const char *set,
+                                     size_t setSize)
+{
+    if (end - begin < 32 || setSize == 0 || setSize > MaxVectorSet)
+        return sse2FindLastNotOf(begin, end, set, setSize);
+
+    if (!SmallCharSet(set, setSize).contains(end[-1]))
+        return end - 1;
+
+    __m256i vectors[MaxVectorSet];
+    for (size_t i = 0; i < setSize; ++i)
+        vectors[i] = _mm256_set1_epi8(set[i]);
+
+    const char *p = end;
+    while (p - begin >= 32) {
+        p -= 32;
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+        unsigned int mask = avx2Match(chunk, vectors, setSize) ^ 0xffffffff;
+        if (mask)
+            return p + 31 - __builtin_clz(mask);
+    }
+
+    // the overlapping bytes are all in the set, so they don't produce a match
+    if (p != begin) {
+        __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(begin));
+        unsigned int mask = avx2Match(chunk, vectors, setSize) ^ 0xffffffff;
+        if (mask)
+            return begin + 31 - __builtin_clz(mask);
+    }
+
+    return end;
+}
+
+BW_AVX2
+static size_t avx2CountChar(const char *begin, const char *end, char c)
+{
+    __m256i needle = _mm256_set1_epi8(c);
+    __m256i zero = _mm256_setzero_si256();
+    size_t count = 0;
+
+    const char *p = begin;
+    while (end - p >= 32) {
+        // matches are -1, so subtracting them counts per byte, for at most 255 chunks
+        __m256i counts = zero;
+        for (int i = 0; i < 255 && end - p >= 32; ++i, p += 32) {
+            __m256i chunk = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+            counts = _mm256_sub_epi8(counts, _mm256_cmpeq_epi8(chunk, needle));
+        }
+
+        unsigned long long sums[4];
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(sums), _mm256_sad_epu8(counts, zero));
+        count += sums[0] + sums[1] + sums[2] + sums[3];
+    }
+
+    return count + sse2CountChar(p, end, c);
+}
+
+BW_AVX2
+static inline __m256i avx2FoldCase(__m256i chunk)
+{
+    __m256i shifted = _mm256_add_epi8(chunk, _mm256_set1_epi8(static_cast<char>(0x80 - 'A')));
+    __m256i upper = _mm256_cmpgt_epi8(_mm256_set1_epi8(static_cast<char>(0x80 + 26)), shifted);
+    return _mm256_or_si256(chunk, _mm256_and_si256(upper, _mm256_set1_epi8(0x20)));
+}
+
+BW_AVX2
+static inline bool avx2EqualsIgnoreCaseChunk(const char *a, const char *b)
+{
+    __m256i x = avx2FoldCase(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(a)));
+    __m256i y = avx2FoldCase(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(b)));
+    return static_cast<unsigned int>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y))) ==
+           0xffffffff;
+}
+
+BW_AVX2
+static bool avx2EqualsIgnoreCase(const char *a, const char *b, size_t size)
+{
+    if (size < 32)
+        return sse2EqualsIgnoreCase(a, b, size);
+
+    size_t i = 0;
+    for (; size - i >= 32; i += 32)
+        if (!avx2EqualsIgnoreCaseChunk(a + i, b + i))
+            return false;
+
+    // the last chunk overlaps with bytes that have already been compared
+    return i == size || avx2EqualsIgnoreCaseChunk(a + size - 32, b + size - 32);
+}
+
+#undef BW_AVX2
+
+#endif /* BW_STRINGSCAN_AVX2 */
+
+/* }}} */
+/* Dispatch {{{ */
+
+/**
+ * \brief One implementation of all kernels
+ */
+struct StringScanKernels {
+    const char *name;
+    const char *(*findAnyOf)(const char *, const char *, const char *, size_t);
+    const char *(*findFirstNotOf)(const char *, const char *, const char *, size_t);
+    const char *(*findLastNotOf)(const char *, const char *, const char *, size_t);
+    size_t (*countChar)(const char *, const char *, char);
+    bool (*equalsIgnoreCase)(const char *, const char *, size_t);
+};
+
+static const StringScanKernels scalarKernels = {
+    "scalar", scalarFindAnyOf, scalarFindFirstNotOf, scalarFindLastNotOf, scalarCountChar,
+    scalarEqualsIgnoreCase
+};
+
+#ifdef BW_STRINGSCAN_SSE2
+static const StringScanKernels sse2Kernels = {
+    "sse2", sse2FindAnyOf, sse2FindFirstNotOf, sse2FindLastNotOf, sse2CountChar,
+    sse2EqualsIgnoreCase
+};
+#endif
+
+#ifdef BW_STRINGSCAN_AVX2
+static const StringScanKernels avx2Kernels = {
+    "avx2", avx2FindAnyOf, avx2FindFirstNotOf, avx2FindLastNotOf, avx2CountChar,
+    avx2EqualsIgnoreCase
+};
+#endif
+
+static const StringScanKernels *selectKernels()
+{
+    const char *forced = std::getenv("BW_STRINGSCAN");
+    if (forced && std::strcmp(forced, "scalar") == 0)
+        return &scalarKernels;
+
+#ifdef BW_STRINGSCAN_AVX2
+    __builtin_cpu_init();
+    if ((!forced || std::strcmp(forced, "avx2") == 0) && __builtin_cpu_supports("avx2"))
+        return &avx2Kernels;
+#endif
+#ifdef BW_STRINGSCAN_SSE2
+    return &sse2Kernels;
+#else
+    return &scalarKernels;
+#endif
+}
+
+static const StringScanKernels *kernels()
+{
+    // all threads select the same kernels, so a race is harmless
+    static const StringScanKernels *s_kernels = NULL;
+
+    const StringScanKernels *result = BW_COMPILER_LOAD_RELAXED(s_kernels);
+    if (!result) {
+        result = selectKernels();
+        BW_COMPILER_STORE_RELAXED(s_kernels, result);
+    }
+
+    return result;
+}
+
+/* }}} */
+/* Public functions {{{ */
+
+const char *findAnyOf(const char *begin, const char *end, const char *set, size_t setSize)
+{
+    return kernels()->findAnyOf(begin, end, set, setSize);
+}
+
+const char *findFirstNotOf(const char *begin, const char *end, const char *set,
+                           size_t setSize)
+{
+    return kernels()->findFirstNotOf(begin, end, set, setSize);
+}
+
+const char *findLastNotOf(const char *begin, const char *end, const char *set,
+                          size_t setSize)
+{
+    return kernels()->findLastNotOf(begin, end, set, setSize);
+}
+
+const char *findNewline(const char *begin, const char *end)
+{
+    return kernels()->findAnyOf(begin, end, "\n\r", 2);
+}
+
+size_t countChar(const char *begin, const char *end, char c)
+{
+    return kernels()->countChar(begin, end, c);
+}
+
+bool equalsIgnoreCase(const char *a, const char *b, size_t size)
+{
+    return kernels()->equalsIgnoreCase(a, b, size);
+}
+
+const char *stringScanImplementation()
+{
+    return kernels()->name;
+}
+
+/* }}} */
+
+} // end namespace bw
@@ -0,0 +1,133 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_STRINGSCAN_H_
+#define LIBBW_STRINGSCAN_H_
+
+#include <cstddef>
+
+namespace bw {
+
+/**
+ * \file stringscan.h
+ * \brief Vectorized primitives for scanning character buffers
+ *
+ * The functions work on the range [\p begin, \p end) and return \p end if nothing has been
+ * found. On x86, they process 16 bytes (SSE2) or 32 bytes (AVX2) per step; the
+ * implementation is selected at the first call depending on the CPU. The environment
+ * variable \c BW_STRINGSCAN can be set to \c scalar, \c sse2 or \c avx2 to force an
+ * implementation, e.g. for benchmarking.
+ *
+ * Character sets with more than 16 characters are always scanned with a scalar lookup
+ * table.
+ */
+
+/**
+ * \brief Searches the first character that is contained in a set
+ *
+ * \param[in] begin the first character of the buffer
+ * \param[in] end the end of the buffer
+ * \param[in] set the characters to search for
+ * \param[in] setSize the number of characters in \p set
+ * \return a pointer to the first character that is in \p set, or \p end
+ * \ingroup string
+ */
+const char *findAnyOf(const char *begin, const char *end, const char *set, size_t setSize);
+
+/**
+ * \brief Searches the first character that is not contained in a set
+ *
+ * \param[in] begin the first character of the buffer
+ * \param[in] end the end of the buffer
+ * \param[in] set the characters to skip
+ * \param[in] setSize the number of characters in \p set
+ * \return a pointer to the first character that is not in \p set, or \p end
+ * \ingroup string
+ */
+const char *findFirstNotOf(const char *begin, const char *end, const char *set,
+                           size_t setSize);
+
+/**
+ * \brief Searches the last character that is not contained in a set
+ *
+ * \param[in] begin the first character of the buffer
+ * \param[in] end the end of the buffer
+ * \param[in] set the characters to skip
+ * \param[in] setSize the number of characters in \p set
+ * \return a pointer to the last character that is not in \p set, or \p end if all
+ *         characters are in \p set
+ * \ingroup string
+ */
+const char *findLastNotOf(const char *begin, const char *end, const char *set,
+                          size_t setSize);
+
+/**
+ * \brief Searches the first line ending
+ *
+ * \param[in] begin the first character of the buffer
+ * \param[in] end the end of the buffer
+ * \return a pointer to the first <tt>'\\n'</tt> or <tt>'\\r'</tt>, or \p end
+ * \ingroup string
+ */
+const char *findNewline(const char *begin, const char *end);
+
+/**
+ * \brief Counts the occurrences of a character
+ *
+ * \param[in] begin the first character of the buffer
+ * \param[in] end the end of the buffer
+ * \param[in] c the character to count
+ * \return the number of occurrences of \p c
+ * \ingroup string
+ */
+size_t countChar(const char *begin, const char *end, char c);
+
+/**
+ * \brief Compares two buffers, ignoring the case of ASCII letters
+ *
+ * Only <tt>'A'</tt> to <tt>'Z'</tt> are folded to lowercase, independent of the locale.
+ *
+ * \param[in] a the first buffer
+ * \param[in] b the second buffer
+ * \param[in] size the number of characters to compare
+ * \return \c true if the buffers are equal after case folding
+ * \ingroup string
+ */
+bool equalsIgnoreCase(const char *a, const char *b, size_t size);
+
+/**
+ * \brief Returns the name of the selected implementation
+ *
+ * \return <tt>"scalar"</tt>, <tt>"sse2"</tt> or <tt>"avx2"</tt>
+ * \ingroup string
+ */
+const char *stringScanImplementation();
+
+} // end namespace bw
+
+#endif /* LIBBW_STRINGSCAN_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
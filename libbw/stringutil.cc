@@ -26,21 +26,404 @@
  */
 #include <string>
 #include <vector>
+#include <cerrno>
+#include <cstdio>
 #include <cstdlib>
 #include <cstring>
+#include <limits>
 #include <string.h>
 
+#include "stringscan.h"
+#include "stringutil.h"
 #include "stringutil_compat.h"
 
+#ifdef HAVE_USELOCALE
+#  include <locale.h>
+#endif
+#ifdef HAVE_THREADS
+#  include <thread/mutex.h>
+#  include <thread/mutexlocker.h>
+#endif
+
 namespace bw {
 
+/* Helper functions {{{ */
+
+#ifdef HAVE_USELOCALE
+
+/**
+ * \brief Switches the current thread to the "C" locale for numbers
+ *
+ * printf() and strtod() use the decimal point of LC_NUMERIC, which the application may have
+ * changed with setlocale().
+ */
+class NumericLocaleScope {
+
+public:
+    NumericLocaleScope()
+        : m_previous(uselocale(numericLocale()))
+    {}
+
+    ~NumericLocaleScope()
+    {
+        uselocale(m_previous);
+    }
+
+private:
+    static locale_t numericLocale()
+    {
+        // newlocale() returns 0 on failure, then uselocale() doesn't change anything
+        static locale_t s_locale = newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0));
+        return s_locale;
+    }
+
+private:
+    locale_t m_previous;
+};
+
+#else
+
+class NumericLocaleScope {};
+
+#endif /* HAVE_USELOCALE */
+
+static bool isDigit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static const char *skipWhitespace(const char *p, const char *end)
+{
+    while (p != end && (*p == ' ' || (*p >= '\t' && *p <= '\r')))
+        ++p;
+    return p;
+}
+
+/**
+ * \brief Writes the decimal digits of \p magnitude, with a sign if \p negative
+ */
+static size_t formatInteger(char *buffer, size_t size, unsigned long long magnitude,
+                            bool negative)
+{
+    static const char digitPairs[] =
+        "00010203040506070809101112131415161718192021222324252627282930313233343536373839"
+        "40414243444546474849505152535455565758596061626364656667686970717273747576777879"
+        "8081828384858687888990919293949596979899";
+
+    char digits[MaxNumberLength];
+    char *p = digits + sizeof(digits);
+
+    while (magnitude >= 100) {
+        const char *pair = digitPairs + (magnitude % 100) * 2;
+        magnitude /= 100;
+        *--p = pair[1];
+        *--p = pair[0];
+    }
+    if (magnitude >= 10) {
+        const char *pair = digitPairs + magnitude * 2;
+        *--p = pair[1];
+        *--p = pair[0];
+    } else
+        *--p = static_cast<char>('0' + magnitude);
+    if (negative)
+        *--p = '-';
+
+    size_t length = digits + sizeof(digits) - p;
+    if (length > size)
+        return 0;
+
+    std::memcpy(buffer, p, length);
+    return length;
+}
+
+/**
+ * \brief Parses an integer at \p p and advances \p p behind it
+ *
+ * On NS_OUT_OF_RANGE, \p value is set to the minimum or maximum of \p T.
+ */
+template <typename T>
+static NumberStatus parseInteger(const char *&p, const char *end, T &value)
+{
+    typedef unsigned long long Magnitude;
+
+    bool negative = false;
+    if (p != end && (*p == '+' || *p == '-')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p == end || !isDigit(*p) || (negative && !std::numeric_limits<T>::is_signed))
+        return NS_INVALID;
+
+    Magnitude limit = static_cast<Magnitude>(std::numeric_limits<T>::max());
+    if (negative)
+        ++limit;
+
+    Magnitude magnitude = 0;
+    bool overflow = false;
+    for (; p != end && isDigit(*p); ++p) {
+        unsigned int digit = *p - '0';
+        if (magnitude > (limit - digit) / 10)
+            overflow = true;
+        else
+            magnitude = magnitude * 10 + digit;
+    }
+
+    if (overflow)
+        magnitude = limit;
+    if (negative && magnitude > 0)
+        value = -static_cast<T>(magnitude - 1) - 1;
+    else
+        value = static_cast<T>(magnitude);
+
+    return overflow ? NS_OUT_OF_RANGE : NS_OK;
+}
+
+/**
+ * \brief Returns the end of the decimal floating point number at \p begin
+ *
+ * \return the end of the number, or \p begin if there is no number
+ */
+static const char *scanFloat(const char *begin, const char *end)
+{
+    const char *p = begin;
+    if (p != end && (*p == '+' || *p == '-'))
+        ++p;
+
+    const char *digits = p;
+    while (p != end && isDigit(*p))
+        ++p;
+    bool hasDigits = p != digits;
+
+    if (p != end && *p == '.') {
+        const char *fraction = p + 1;
+        const char *q = fraction;
+        while (q != end && isDigit(*q))
+            ++q;
+        if (hasDigits || q != fraction) {
+            hasDigits = true;
+            p = q;
+        }
+    }
+    if (!hasDigits)
+        return begin;
+
+    // the exponent is only part of the number if it has digits
+    if (p != end && (*p == 'e' || *p == 'E')) {
+        const char *q = p + 1;
+        if (q != end && (*q == '+' || *q == '-'))
+            ++q;
+        const char *exponent = q;
+        while (q != end && isDigit(*q))
+            ++q;
+        if (q != exponent)
+            p = q;
+    }
+
+    return p;
+}
+
+static void convertFloat(const char *str, float &value)
+{
+    value = std::strtof(str, NULL);
+}
+
+static void convertFloat(const char *str, double &value)
+{
+    value = std::strtod(str, NULL);
+}
+
+/**
+ * \brief Parses a floating point number at \p p and advances \p p behind it
+ *
+ * On NS_OUT_OF_RANGE, \p value is set to the largest finite value with the right sign.
+ */
+template <typename T>
+static NumberStatus parseFloat(const char *&p, const char *end, T &value)
+{
+    const char *numberEnd = scanFloat(p, end);
+    if (numberEnd == p)
+        return NS_INVALID;
+
+    // strtod() needs a NUL-terminated string
+    size_t length = numberEnd - p;
+    char stackBuffer[64];
+    std::string heapBuffer;
+    const char *terminated = stackBuffer;
+    if (length < sizeof(stackBuffer)) {
+        std::memcpy(stackBuffer, p, length);
+        stackBuffer[length] = '\0';
+    } else {
+        heapBuffer.assign(p, length);
+        terminated = heapBuffer.c_str();
+    }
+
+    T result;
+    {
+        NumericLocaleScope scope;
+        errno = 0;
+        convertFloat(terminated, result);
+    }
+
+    p = numberEnd;
+    if (errno == ERANGE && (result > std::numeric_limits<T>::max() ||
+                            result < -std::numeric_limits<T>::max())) {
+        value = result > 0 ? std::numeric_limits<T>::max() : -std::numeric_limits<T>::max();
+        return NS_OUT_OF_RANGE;
+    }
+
+    value = result;
+    return NS_OK;
+}
+
+template <typename T>
+static NumberStatus parseInteger(const StringView &str, T &value)
+{
+    const char *p = str.data();
+    const char *end = p + str.size();
+
+    T result;
+    NumberStatus status = parseInteger(p, end, result);
+    if (status != NS_INVALID && p != end)
+        return NS_INVALID;
+    if (status == NS_OK)
+        value = result;
+
+    return status;
+}
+
+template <typename T>
+static NumberStatus parseFloat(const StringView &str, T &value)
+{
+    const char *p = str.data();
+    const char *end = p + str.size();
+
+    T result;
+    NumberStatus status = parseFloat(p, end, result);
+    if (status != NS_INVALID && p != end)
+        return NS_INVALID;
+    if (status == NS_OK)
+        value = result;
+
+    return status;
+}
+
+/**
+ * \brief Copies [\p begin, \p end) to \p out with each \p old_char replaced
+ *
+ * \p out must be large enough for the result.
+ */
+static void replaceChar(const char *begin, const char *end, char old_char,
+                        const StringView &new_string, char *out)
+{
+    const char *p = begin;
+    const char *found;
+    while ((found = static_cast<const char *>(std::memchr(p, old_char, end - p))) != NULL) {
+        std::memcpy(out, p, found - p);
+        out += found - p;
+        std::memcpy(out, new_string.data(), new_string.size());
+        out += new_string.size();
+        p = found + 1;
+    }
+    std::memcpy(out, p, end - p);
+}
+
+/**
+ * \brief Appends [\p begin, \p end) to \p output with each \p old_char replaced
+ *
+ * \p count is the number of occurrences of \p old_char, used to resize \p output once.
+ */
+static void replaceChar(const char *begin, const char *end, char old_char,
+                        const StringView &new_string, size_t count, std::string &output)
+{
+    size_t oldSize = output.size();
+    output.resize(oldSize + (end - begin) - count + count * new_string.size());
+    replaceChar(begin, end, old_char, new_string, &output[oldSize]);
+}
+
+/**
+ * \brief The generic from_str() implementation, for explicitly specified locales
+ */
+template <typename T>
+static T streamFromString(const std::string &str, const std::locale &loc)
+{
+    std::stringstream ss;
+    ss.imbue(loc);
+    ss << str;
+    T ret;
+    ss >> ret;
+
+    return ret;
+}
+
+/**
+ * \brief Checks if the from_str() specializations can ignore \p loc
+ *
+ * That's the case for the classic locale and for the global locale, which is the default
+ * argument. str() ignores the global locale as well, so both stay inverse to each other.
+ */
+static bool isDefaultNumberLocale(const std::locale &loc)
+{
+    return loc == std::locale::classic() || loc == std::locale();
+}
+
+/**
+ * \brief Implementation of the from_str() specializations for integers
+ */
+template <typename T>
+static T integerFromString(const std::string &str, const std::locale &loc)
+{
+    if (!isDefaultNumberLocale(loc))
+        return streamFromString<T>(str, loc);
+
+    const char *end = str.data() + str.size();
+    const char *p = skipWhitespace(str.data(), end);
+
+    T value;
+    return parseInteger(p, end, value) == NS_INVALID ? 0 : value;
+}
+
+/**
+ * \brief Implementation of the from_str() specializations for floating point numbers
+ */
+template <typename T>
+static T floatFromString(const std::string &str, const std::locale &loc)
+{
+    if (!isDefaultNumberLocale(loc))
+        return streamFromString<T>(str, loc);
+
+    const char *end = str.data() + str.size();
+    const char *p = skipWhitespace(str.data(), end);
+
+    T value;
+    return parseFloat(p, end, value) == NS_INVALID ? 0 : value;
+}
+
+template <typename T>
+static std::string integerToString(T value)
+{
+    char buffer[MaxNumberLength];
+    return std::string(buffer, formatNumber(buffer, sizeof(buffer), value));
+}
+
+/* }}} */
+
 std::string strip(std::string a, const std::string &chars_to_strip)
 {
     if (a.length() == 0)
         return a;
 
-    a.erase(0, a.find_first_not_of(chars_to_strip.c_str(), 0));
-    a.erase(a.find_last_not_of(chars_to_strip.c_str())+1);
+    const char *begin = a.data();
+    const char *end = begin + a.size();
+    const char *set = chars_to_strip.c_str();
+    size_t setSize = std::strlen(set);
+
+    const char *first = findFirstNotOf(begin, end, set, setSize);
+    if (first == end)
+        return std::string();
+    const char *last = findLastNotOf(first, end, set, setSize);
+
+    a.erase(last + 1 - begin);
+    a.erase(0, first - begin);
 
     return a;
 }
@@ -50,7 +433,9 @@ std::string stripl(std::string a)
     if (a.length() == 0)
         return a;
 
-    a.erase(0, a.find_first_not_of("\r\n \t", 0));
+    const char *begin = a.data();
+    const char *end = begin + a.size();
+    a.erase(0, findFirstNotOf(begin, end, "\r\n \t", 4) - begin);
 
     return a;
 }
@@ -60,26 +445,87 @@ std::string stripr(std::string a)
     if (a.length() == 0)
         return a;
 
-    a.erase(a.find_last_not_of("\r\n \t")+1);
+    const char *begin = a.data();
+    const char *end = begin + a.size();
+    const char *last = findLastNotOf(begin, end, "\r\n \t", 4);
+    a.erase(last == end ? 0 : last + 1 - begin);
 
     return a;
 }
 
-bool startsWith(const std::string &str, const std::string &start, bool casesensitive)
+bool startsWith(const StringView &str, const StringView &start, bool casesensitive)
 {
     size_t len = start.size();
     if (str.size() < len)
         return false;
 
     if (casesensitive)
-        return str.substr(0, len) == start;
+        return std::memcmp(str.data(), start.data(), len) == 0;
     else
-        return strcasecmp(str.substr(0, len).c_str(), start.c_str()) == 0;
+        return equalsIgnoreCase(str.data(), start.data(), len);
 }
 
-std::string getRest(const std::string &str, const std::string &prefix)
+bool endsWith(const StringView &str, const StringView &end, bool casesensitive)
 {
-    return str.substr(prefix.size(), str.size() - prefix.size());
+    size_t len = end.size();
+    if (str.size() < len)
+        return false;
+
+    const char *tail = str.data() + str.size() - len;
+    if (casesensitive)
+        return std::memcmp(tail, end.data(), len) == 0;
+    else
+        return equalsIgnoreCase(tail, end.data(), len);
+}
+
+bool contains(const StringView &str, const StringView &needle, bool casesensitive)
+{
+    if (casesensitive)
+        return str.find(needle) != StringView::npos;
+    else
+        return findIgnoreCase(str, needle) != StringView::npos;
+}
+
+bool equalsIgnoreCase(const StringView &a, const StringView &b)
+{
+    return a.size() == b.size() && equalsIgnoreCase(a.data(), b.data(), a.size());
+}
+
+size_t findIgnoreCase(const StringView &str, const StringView &needle, size_t pos)
+{
+    if (pos > str.size() || needle.size() > str.size() - pos)
+        return StringView::npos;
+    if (needle.empty())
+        return pos;
+
+    // search the candidates for the first character in both cases, like StringView::find()
+    char first[2] = { needle[0], needle[0] };
+    if (first[0] >= 'a' && first[0] <= 'z')
+        first[1] = first[0] - 'a' + 'A';
+    else if (first[0] >= 'A' && first[0] <= 'Z')
+        first[1] = first[0] - 'A' + 'a';
+
+    const char *last = str.data() + str.size() - needle.size();
+    const char *current = str.data() + pos;
+    while (current <= last) {
+        current = findAnyOf(current, last + 1, first, first[0] == first[1] ? 1 : 2);
+        if (current == last + 1)
+            return StringView::npos;
+
+        if (equalsIgnoreCase(current + 1, needle.data() + 1, needle.size() - 1))
+            return current - str.data();
+        ++current;
+    }
+
+    return StringView::npos;
+}
+
+std::string getRest(const StringView &str, const StringView &prefix)
+{
+    if (!startsWith(str, prefix))
+        return str.str();
+
+    return std::string(str.data() + prefix.size(), str.size() - prefix.size());
 }
 
 char **stringvector_to_array(const std::vector<std::string> &vec)
@@ -98,39 +544,540 @@ char **stringvector_to_array(const std::vector<std::string> &vec)
     return ret;
 }
 
+char **stringvector_to_array(const std::vector<std::string> &vec, Arena &arena)
+{
+    if (vec.size() == 0)
+        return NULL;
+
+    char **ret = static_cast<char **>(arena.allocate(sizeof(char *) * (vec.size() + 1)));
+
+    char **cur = ret;
+    for (std::vector<std::string>::const_iterator it = vec.begin(); it != vec.end(); ++it)
+        *cur++ = arena.strdup(*it);
+    *cur = NULL;
+
+    return ret;
+}
+
 std::vector<std::string> stringsplit(const std::string &str, const std::string &pattern)
 {
     std::vector<std::string> retval;
-    std::string s = str;
 
-    std::string::size_type pos;
-    while ((pos = s.find(pattern)) != std::string::npos) {
-        std::string item = s.substr(0, pos);
-        retval.push_back(item);
+    StringSplitter splitter(str, pattern);
+    StringView token;
+    while (splitter.next(token))
+        retval.push_back(token.str());
 
-        s = s.substr(pos + pattern.length());
+    return retval;
+}
+
+StringSplitter::StringSplitter(const StringView &str, char delimiter)
+    : m_str(str)
+    , m_delimiterChar(delimiter)
+    , m_delimiterLength(1)
+    , m_position(0)
+{}
+
+StringSplitter::StringSplitter(const StringView &str, const StringView &delimiter)
+    : m_str(str)
+    , m_delimiter(delimiter)
+    , m_delimiterChar(delimiter.empty() ? '\0' : delimiter[0])
+    , m_delimiterLength(delimiter.size())
+    , m_position(0)
+{}
+
+bool StringSplitter::advance(size_t &position, StringView &token) const
+{
+    if (position == StringView::npos)
+        return false;
+
+    size_t found = StringView::npos;
+    if (m_delimiterLength == 1)
+        found = m_str.find(m_delimiterChar, position);
+    else if (m_delimiterLength > 1)
+        found = m_str.find(m_delimiter, position);
+
+    if (found == StringView::npos) {
+        // no empty token at the end
+        if (position == m_str.size()) {
+            position = StringView::npos;
+            return false;
+        }
+        token = m_str.substr(position);
+        position = StringView::npos;
+        return true;
     }
 
-    if (s != "")
-        retval.push_back(s);
+    token = StringView(m_str.data() + position, found - position);
+    position = found + m_delimiterLength;
+    return true;
+}
 
-    return retval;
+size_t stringsplit(const StringView &str, char delimiter, std::vector<StringView> &result)
+{
+    result.clear();
+
+    StringSplitter splitter(str, delimiter);
+    StringView token;
+    while (splitter.next(token))
+        result.push_back(token);
+
+    return result.size();
+}
+
+size_t stringsplit(const StringView &str, const StringView &delimiter,
+                   std::vector<StringView> &result)
+{
+    result.clear();
+
+    StringSplitter splitter(str, delimiter);
+    StringView token;
+    while (splitter.next(token))
+        result.push_back(token);
+
+    return result.size();
+}
+
+std::vector<StringView, ArenaAllocator<StringView> > stringsplit(const StringView &str,
+                                                                const StringView &pattern,
+                                                                Arena &arena)
+{
+    std::vector<StringView, ArenaAllocator<StringView> > result(arena);
+
+    StringSplitter splitter(str, pattern);
+    StringView token;
+    while (splitter.next(token))
+        result.push_back(StringView(arena.strdup(token), token.size()));
+
+    return result;
 }
 
 std::string replace_char(const std::string  &input,
                          char               old_char,
                          const std::string  &new_string)
 {
-    std::string ret = input;
-    size_t pos = 0;
-    size_t correction = new_string.size() - 1;
+    const char *begin = input.data();
+    const char *end = begin + input.size();
+
+    // a single return object, so that the compiler can construct it in place without C++11
+    std::string ret;
+    size_t count = countChar(begin, end, old_char);
+    if (count == 0)
+        ret = input;
+    else
+        replaceChar(begin, end, old_char, new_string, count, ret);
+    return ret;
+}
+
+size_t replace_char(const StringView &input, char old_char, const StringView &new_string,
+                    std::string &output)
+{
+    const char *begin = input.data();
+    const char *end = begin + input.size();
+
+    size_t count = countChar(begin, end, old_char);
+    if (count == 0)
+        output.append(begin, end - begin);
+    else
+        replaceChar(begin, end, old_char, new_string, count, output);
+
+    return count;
+}
+
+StringView replace_char(const StringView &input, char old_char, const StringView &new_string,
+                        Arena &arena)
+{
+    const char *begin = input.data();
+    const char *end = begin + input.size();
+
+    size_t count = countChar(begin, end, old_char);
+    size_t size = input.size() - count + count * new_string.size();
+    char *result = static_cast<char *>(arena.allocate(size + 1, 1));
+
+    replaceChar(begin, end, old_char, new_string, result);
+    result[size] = '\0';
+
+    return StringView(result, size);
+}
+
+size_t replace_char_inplace(std::string &str, char old_char, const StringView &new_string)
+{
+    // new_string may be a view into str
+    if (new_string.data() >= str.data() && new_string.data() < str.data() + str.size()) {
+        std::string copy(new_string.str());
+        return replace_char_inplace(str, old_char, copy);
+    }
+
+    size_t count = countChar(str.data(), str.data() + str.size(), old_char);
+    if (count == 0)
+        return 0;
 
-    while ((pos = ret.find(old_char, pos)) != std::string::npos) {
-        ret.replace(pos, 1, new_string);
-        pos += 1 + correction;
+    size_t oldSize = str.size();
+    size_t newSize = oldSize - count + count * new_string.size();
+    const char *replacement = new_string.data();
+    size_t replacementLength = new_string.size();
+
+    if (replacementLength <= 1) {
+        // the result is not longer, so work from the front
+        char *out = &str[0];
+        const char *p = out;
+        const char *end = p + oldSize;
+        const char *found;
+        while ((found = static_cast<const char *>(std::memchr(p, old_char, end - p))) != NULL) {
+            std::memmove(out, p, found - p);
+            out += found - p;
+            if (replacementLength == 1)
+                *out++ = *replacement;
+            p = found + 1;
+        }
+        std::memmove(out, p, end - p);
+        str.resize(newSize);
+    } else {
+        // the result is longer: move the text behind each match to its final position,
+        // starting from the end, so that nothing is overwritten before it has been moved
+        str.resize(newSize);
+        char *data = &str[0];
+        char *out = data + newSize;
+        const char *p = data + oldSize;
+        while (p != data) {
+            const char *found = p;
+            while (found != data && found[-1] != old_char)
+                --found;
+            out -= p - found;
+            std::memmove(out, found, p - found);
+            if (found == data)
+                break;
+            out -= replacementLength;
+            std::memcpy(out, replacement, replacementLength);
+            p = found - 1;
+        }
     }
 
-    return ret;
+    return count;
+}
+
+/* Numeric conversion {{{ */
+
+size_t formatNumber(char *buffer, size_t size, int value)
+{
+    return formatNumber(buffer, size, static_cast<long long>(value));
+}
+
+size_t formatNumber(char *buffer, size_t size, unsigned int value)
+{
+    return formatInteger(buffer, size, value, false);
+}
+
+size_t formatNumber(char *buffer, size_t size, long value)
+{
+    return formatNumber(buffer, size, static_cast<long long>(value));
+}
+
+size_t formatNumber(char *buffer, size_t size, unsigned long value)
+{
+    return formatInteger(buffer, size, value, false);
+}
+
+size_t formatNumber(char *buffer, size_t size, long long value)
+{
+    // 0 - x is also correct for the smallest value, whose magnitude doesn't fit into long long
+    unsigned long long magnitude = static_cast<unsigned long long>(value);
+    return formatInteger(buffer, size, value < 0 ? 0 - magnitude : magnitude, value < 0);
+}
+
+size_t formatNumber(char *buffer, size_t size, unsigned long long value)
+{
+    return formatInteger(buffer, size, value, false);
+}
+
+size_t formatNumber(char *buffer, size_t size, double value, int precision)
+{
+    NumericLocaleScope scope;
+
+    int length = std::snprintf(buffer, size, "%.*g", precision, value);
+    if (length < 0 || static_cast<size_t>(length) >= size)
+        return 0;
+
+    return length;
+}
+
+NumberStatus parseNumber(const StringView &str, int &value)
+{
+    return parseInteger(str, value);
+}
+
+NumberStatus parseNumber(const StringView &str, unsigned int &value)
+{
+    return parseInteger(str, value);
+}
+
+NumberStatus parseNumber(const StringView &str, long &value)
+{
+    return parseInteger(str, value);
+}
+
+NumberStatus parseNumber(const StringView &str, unsigned long &value)
+{
+    return parseInteger(str, value);
+}
+
+NumberStatus parseNumber(const StringView &str, long long &value)
+{
+    return parseInteger(str, value);
+}
+
+NumberStatus parseNumber(const StringView &str, unsigned long long &value)
+{
+    return parseInteger(str, value);
+}
+
+NumberStatus parseNumber(const StringView &str, float &value)
+{
+    return parseFloat(str, value);
+}
+
+NumberStatus parseNumber(const StringView &str, double &value)
+{
+    return parseFloat(str, value);
+}
+
+std::string str(int value)
+{
+    return integerToString(value);
+}
+
+std::string str(unsigned int value)
+{
+    return integerToString(value);
+}
+
+std::string str(long value)
+{
+    return integerToString(value);
 }
 
+std::string str(unsigned long value)
+{
+    return integerToString(value);
+}
+
+std::string str(long long value)
+{
+    return integerToString(value);
+}
+
+std::string str(unsigned long long value)
+{
+    return integerToString(value);
+}
+
+std::string str(float value)
+{
+    return str(static_cast<double>(value));
+}
+
+std::string str(double value)
+{
+    char buffer[MaxNumberLength];
+    return std::string(buffer, formatNumber(buffer, sizeof(buffer), value));
+}
+
+template <>
+int from_str<int>(const std::string &str, const std::locale &loc)
+{
+    return integerFromString<int>(str, loc);
+}
+
+template <>
+unsigned int from_str<unsigned int>(const std::string &str, const std::locale &loc)
+{
+    return integerFromString<unsigned int>(str, loc);
+}
+
+template <>
+long from_str<long>(const std::string &str, const std::locale &loc)
+{
+    return integerFromString<long>(str, loc);
+}
+
+template <>
+unsigned long from_str<unsigned long>(const std::string &str, const std::locale &loc)
+{
+    return integerFromString<unsigned long>(str, loc);
+}
+
+template <>
+long long from_str<long long>(const std::string &str, const std::locale &loc)
+{
+    return integerFromString<long long>(str, loc);
+}
+
+template <>
+unsigned long long from_str<unsigned long long>(const std::string &str, const std::locale &loc)
+{
+    return integerFromString<unsigned long long>(str, loc);
+}
+
+template <>
+float from_str<float>(const std::string &str, const std::locale &loc)
+{
+    return floatFromString<float>(str, loc);
+}
+
+template <>
+double from_str<double>(const std::string &str, const std::locale &loc)
+{
+    return floatFromString<double>(str, loc);
+}
+
+/* }}} */
+
+/* StringPool {{{ */
+
+static const size_t FnvOffsetBasis = static_cast<size_t>(14695981039346656037ULL);
+static const size_t FnvPrime = static_cast<size_t>(1099511628211ULL);
+
+/**
+ * \brief Computes the FNV-1a hash of a string
+ */
+static size_t hashString(const StringView &str)
+{
+    size_t hash = FnvOffsetBasis;
+    for (size_t i = 0; i < str.size(); ++i) {
+        hash ^= static_cast<unsigned char>(str[i]);
+        hash *= FnvPrime;
+    }
+    return hash;
+}
+
+// hashString() of the empty string
+const InternedStringEntry InternedString::s_empty = { FnvOffsetBasis, 0, "" };
+
+/**
+ * \brief Data of a StringPool
+ *
+ * The entries are stored in an open-addressing hash table with linear probing whose size is
+ * a power of two. The entries and their characters are allocated from an arena that is only
+ * freed when the pool is destroyed.
+ */
+struct StringPoolPrivate
+{
+    static const size_t BlockSize = 16 * 1024;
+    static const size_t InitialTableSize = 64;
+
+    StringPoolPrivate()
+        : arena(BlockSize)
+        , count(0)
+        , table(InitialTableSize, NULL)
+    {}
+
+    size_t findSlot(const StringView &str, size_t hash) const
+    {
+        size_t mask = table.size() - 1;
+        for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+            const InternedStringEntry *entry = table[slot];
+            if (!entry || (entry->hash == hash && StringView(entry->data, entry->length) == str))
+                return slot;
+        }
+    }
+
+    const InternedStringEntry *insert(const StringView &str, size_t hash, size_t slot)
+    {
+        // keep the load factor below 1/2
+        if (2 * (count + 1) > table.size()) {
+            std::vector<const InternedStringEntry *> old(2 * table.size(), NULL);
+            old.swap(table);
+            for (size_t i = 0; i < old.size(); ++i) {
+                const InternedStringEntry *entry = old[i];
+                if (entry)
+                    table[findSlot(StringView(entry->data, entry->length), entry->hash)] = entry;
+            }
+            slot = findSlot(str, hash);
+        }
+
+        InternedStringEntry *entry = static_cast<InternedStringEntry *>(
+            arena.allocate(sizeof(InternedStringEntry)));
+        entry->hash = hash;
+        entry->length = str.size();
+        entry->data = arena.strdup(str);
+
+        table[slot] = entry;
+        ++count;
+        return entry;
+    }
+
+    Arena arena;
+    size_t count;
+    std::vector<const InternedStringEntry *> table;
+#ifdef HAVE_THREADS
+    thread::Mutex mutex;
+#endif
+};
+
+StringPool::StringPool()
+    : d(new StringPoolPrivate)
+{}
+
+StringPool::~StringPool()
+{
+    delete d;
+}
+
+StringPool *StringPool::global()
+{
+    static StringPool *s_instance = new StringPool();
+
+    return s_instance;
+}
+
+InternedString StringPool::intern(const StringView &str)
+{
+    if (str.empty())
+        return InternedString();
+
+    size_t hash = hashString(str);
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&d->mutex);
+#endif
+    size_t slot = d->findSlot(str, hash);
+    if (d->table[slot])
+        return InternedString(d->table[slot]);
+
+    return InternedString(d->insert(str, hash, slot));
+}
+
+bool StringPool::lookup(const StringView &str, InternedString &result) const
+{
+    if (str.empty()) {
+        result = InternedString();
+        return true;
+    }
+
+    size_t hash = hashString(str);
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&d->mutex);
+#endif
+    const InternedStringEntry *entry = d->table[d->findSlot(str, hash)];
+    if (!entry)
+        return false;
+
+    result = InternedString(entry);
+    return true;
+}
+
+size_t StringPool::size() const
+{
+#ifdef HAVE_THREADS
+    thread::MutexLocker locker(&d->mutex);
+#endif
+    return d->count;
+}
+
+InternedString intern(const StringView &str)
+{
+    return StringPool::global()->intern(str);
+}
+
+/* }}} */
+
 } // end namespace bw
@@ -32,6 +32,11 @@
 #include <sstream>
 #include <iomanip>
 #include <locale>
+#include <iterator>
+
+#include <libbw/arena.h>
+#include <libbw/noncopyable.h>
+#include <libbw/stringview.h>
 
 namespace bw {
 
@@ -75,7 +80,11 @@ std::string stripl(std::string a);
  * \brief Checks if a string starts with another string
  *
  * Checks if \p str starts with \p start. If \p casesensitive is \c true, the
- * matching is done case-sensitive.
+ * matching is done case-sensitive. Otherwise, ASCII letters are compared case-insensitive,
+ * independent of the locale.
+ *
+ * No temporary strings are created, so this is cheap enough for matching each input line
+ * against many prefixes.
  *
  * \param[in] str the string which is checked if it starts with \p start
  * \param[in] start the string which is taken to check if \p str starts with
@@ -84,7 +93,54 @@ std::string stripl(std::string a);
  * \return \c true if \p str starts with \p start, \c false otherwise
  * \ingroup string
  */
-bool startsWith(const std::string &str, const std::string &start, bool casesensitive = true);
+bool startsWith(const StringView &str, const StringView &start, bool casesensitive = true);
+
+/**
+ * \brief Checks if a string ends with another string
+ *
+ * \param[in] str the string which is checked
+ * \param[in] end the suffix
+ * \param[in] casesensitive if \c false, ASCII letters are compared case-insensitive
+ * \return \c true if \p str ends with \p end, \c false otherwise
+ * \ingroup string
+ */
+bool endsWith(const StringView &str, const StringView &end, bool casesensitive = true);
+
+/**
+ * \brief Checks if a string contains another string
+ *
+ * \param[in] str the string which is searched
+ * \param[in] needle the string to search for. The empty string is always found.
+ * \param[in] casesensitive if \c false, ASCII letters are compared case-insensitive
+ * \return \c true if \p needle occurs in \p str, \c false otherwise
+ * \ingroup string
+ */
+bool contains(const StringView &str, const StringView &needle, bool casesensitive = true);
+
+/**
+ * \brief Compares two strings, ignoring the case of ASCII letters
+ *
+ * \param[in] a the first string
+ * \param[in] b the second string
+ * \return \c true if both strings are equal except for the case of ASCII letters
+ * \ingroup string
+ */
+bool equalsIgnoreCase(const StringView &a, const StringView &b);
+
+/**
+ * \brief Searches a string, ignoring the case of ASCII letters
+ *
+ * Like StringView::find(), but <tt>'A'</tt> to <tt>'Z'</tt> match <tt>'a'</tt> to
+ * <tt>'z'</tt>.
+ *
+ * \param[in] str the string which is searched
+ * \param[in] needle the string to search for
+ * \param[in] pos the index where the search starts
+ * \return the index of the first occurrence of \p needle at or after \p pos, or
+ *         StringView::npos
+ * \ingroup string
+ */
+size_t findIgnoreCase(const StringView &str, const StringView &needle, size_t pos = 0);
 
 /**
  * \brief Returns the rest
@@ -93,12 +149,14 @@ bool startsWith(const std::string &str, const std::string &start, bool casesensi
  * prefix. If \p str does not start with \p prefix, \p str is returned
  * unmodified.
  *
+ * Use <tt>StringView::substr()</tt> instead if a view of the rest is sufficient.
+ *
  * \param[in] str the base string
  * \param[in] prefix the prefix which is stripped
  * \return the rest string as described above
  * \ingroup string
  */
-std::string getRest(const std::string &str, const std::string &prefix);
+std::string getRest(const StringView &str, const StringView &prefix);
 
 /**
  * \brief Converts a string vector to a C array
@@ -113,6 +171,20 @@ std::string getRest(const std::string &str, const std::string &prefix);
  */
 char **stringvector_to_array(const std::vector<std::string> &vec);
 
+/**
+ * \brief Converts a string vector to a C array in an arena
+ *
+ * Like stringvector_to_array(const std::vector<std::string> &), but the array and the
+ * strings are allocated from \p arena, so they are freed with it instead of one free()
+ * per element.
+ *
+ * \param[in] vec the vector to convert
+ * \param[in] arena the arena for the result
+ * \return the NULL-terminated C array, or \c NULL if \p vec is empty
+ * \ingroup string
+ */
+char **stringvector_to_array(const std::vector<std::string> &vec, Arena &arena);
+
 /**
  * \brief Splits a string
  *
@@ -129,6 +201,262 @@ char **stringvector_to_array(const std::vector<std::string> &vec);
  */
 std::vector<std::string> stringsplit(const std::string &str, const std::string &pattern);
 
+/**
+ * \class StringSplitter stringutil.h libbw/stringutil.h
+ * \brief Splits a string lazily into views
+ *
+ * In contrast to stringsplit(), the tokens are not copied: each token is a StringView into
+ * the original string, and the next token is only searched when it's requested. Splitting a
+ * string of length n takes O(n) time and doesn't allocate memory. Empty tokens between two
+ * delimiters are returned, an empty token at the end of the string is not, which matches
+ * stringsplit().
+ *
+ * Example:
+ *
+ * \code
+ * bw::StringSplitter splitter(line, ',');
+ * bw::StringView field;
+ * while (splitter.next(field))
+ *     process(field);
+ *
+ * for (bw::StringSplitter::const_iterator it = splitter.begin(); it != splitter.end(); ++it)
+ *     process(*it);
+ * \endcode
+ *
+ * The string and a multi-character delimiter are not copied, so they must outlive the
+ * splitter and its iterators.
+ *
+ * \ingroup string
+ */
+class StringSplitter {
+
+public:
+    /**
+     * \class const_iterator stringutil.h libbw/stringutil.h
+     * \brief Input iterator over the tokens
+     */
+    class const_iterator {
+
+    public:
+        /// \cond
+        typedef std::input_iterator_tag     iterator_category;
+        typedef StringView                  value_type;
+        typedef std::ptrdiff_t              difference_type;
+        typedef const StringView            *pointer;
+        typedef const StringView            &reference;
+        /// \endcond
+
+    public:
+        /**
+         * \brief Creates an end iterator
+         */
+        const_iterator()
+            : m_splitter(NULL)
+            , m_position(StringView::npos)
+        {}
+
+        /**
+         * \brief Returns the current token
+         *
+         * \return the token
+         */
+        reference operator*() const
+        {
+            return m_token;
+        }
+
+        /**
+         * \brief Accesses the current token
+         *
+         * \return a pointer to the token
+         */
+        pointer operator->() const
+        {
+            return &m_token;
+        }
+
+        /**
+         * \brief Advances to the next token
+         *
+         * \return the iterator
+         */
+        const_iterator &operator++()
+        {
+            if (!m_splitter || !m_splitter->advance(m_position, m_token))
+                m_splitter = NULL;
+            return *this;
+        }
+
+        /**
+         * \brief Advances to the next token
+         *
+         * \return the iterator before advancing
+         */
+        const_iterator operator++(int)
+        {
+            const_iterator old = *this;
+            ++*this;
+            return old;
+        }
+
+        /**
+         * \brief Compares two iterators
+         *
+         * \param[in] other the other iterator
+         * \return \c true if both are at the end or at the same token
+         */
+        bool operator==(const const_iterator &other) const
+        {
+            if (!m_splitter || !other.m_splitter)
+                return m_splitter == other.m_splitter;
+            return m_token.data() == other.m_token.data() && m_position == other.m_position;
+        }
+
+        /**
+         * \brief Compares two iterators
+         *
+         * \param[in] other the other iterator
+         * \return \c true if the iterators are at different tokens
+         */
+        bool operator!=(const const_iterator &other) const
+        {
+            return !(*this == other);
+        }
+
+    private:
+        friend class StringSplitter;
+
+        explicit const_iterator(const StringSplitter *splitter)
+            : m_splitter(splitter)
+            , m_position(0)
+        {
+            ++*this;
+        }
+
+    private:
+        const StringSplitter    *m_splitter;
+        size_t                  m_position;
+        StringView              m_token;
+    };
+
+public:
+    /**
+     * \brief Creates a splitter for a single-character delimiter
+     *
+     * \param[in] str the string to split
+     * \param[in] delimiter the separator
+     */
+    StringSplitter(const StringView &str, char delimiter);
+
+    /**
+     * \brief Creates a splitter for a delimiter string
+     *
+     * \param[in] str the string to split
+     * \param[in] delimiter the separator. If it's empty, \p str is returned as one token.
+     */
+    StringSplitter(const StringView &str, const StringView &delimiter);
+
+public:
+    /**
+     * \brief Returns the next token
+     *
+     * \param[out] token the token, only set if the return value is \c true
+     * \return \c true if a token has been found, \c false at the end of the string
+     */
+    bool next(StringView &token)
+    {
+        return advance(m_position, token);
+    }
+
+    /**
+     * \brief Restarts next() at the beginning of the string
+     */
+    void reset()
+    {
+        m_position = 0;
+    }
+
+    /**
+     * \brief Returns an iterator to the first token
+     *
+     * The iterators are independent of next().
+     *
+     * \return the iterator
+     */
+    const_iterator begin() const
+    {
+        return const_iterator(this);
+    }
+
+    /**
+     * \brief Returns the end iterator
+     *
+     * \return the iterator
+     */
+    const_iterator end() const
+    {
+        return const_iterator();
+    }
+
+private:
+    bool advance(size_t &position, StringView &token) const;
+
+private:
+    StringView  m_str;
+    StringView  m_delimiter;
+    char        m_delimiterChar;
+    size_t      m_delimiterLength;
+    size_t      m_position;
+};
+
+/**
+ * \brief Splits a string into views
+ *
+ * Like stringsplit(), but the tokens are views into \p str, see StringSplitter. The vector
+ * is cleared first, so that it can be reused for many strings without allocating memory
+ * once its capacity is large enough.
+ *
+ * \param[in] str the string to split
+ * \param[in] delimiter the separator
+ * \param[out] result the tokens
+ * \return the number of tokens
+ * \ingroup string
+ */
+size_t stringsplit(const StringView &str, char delimiter, std::vector<StringView> &result);
+
+/**
+ * \brief Splits a string into views
+ *
+ * Like stringsplit(), but the tokens are views into \p str, see StringSplitter. The vector
+ * is cleared first, so that it can be reused for many strings without allocating memory
+ * once its capacity is large enough.
+ *
+ * \param[in] str the string to split
+ * \param[in] delimiter the separator
+ * \param[out] result the tokens
+ * \return the number of tokens
+ * \ingroup string
+ */
+size_t stringsplit(const StringView &str, const StringView &delimiter,
+                   std::vector<StringView> &result);
+
+/**
+ * \brief Splits a string into copies in an arena
+ *
+ * Like stringsplit(const std::string &, const std::string &), but the vector and the tokens
+ * are allocated from \p arena. The tokens are NUL-terminated copies, so they stay valid
+ * after \p str has been destroyed, until the arena is reset.
+ *
+ * \param[in] str the string to split
+ * \param[in] pattern the separator
+ * \param[in] arena the arena for the result
+ * \return the tokens
+ * \ingroup string
+ */
+std::vector<StringView, ArenaAllocator<StringView> > stringsplit(const StringView &str,
+                                                                const StringView &pattern,
+                                                                Arena &arena);
+
 /**
  * \brief Replaces a character with a character or a string
  *
@@ -144,6 +472,158 @@ std::string replace_char(const std::string  &input,
                          char               old_char,
                          const std::string  &new_string);
 
+/**
+ * \brief Replaces a character with a string and appends the result
+ *
+ * Like replace_char(const std::string &, char, const std::string &), but appends to
+ * \p output, which grows at most once. If \p output is reused, replacing doesn't allocate
+ * memory once its capacity is large enough. \p input must not point into \p output.
+ *
+ * To replace several characters or substrings at once, use StringReplacer.
+ *
+ * \param[in] input the input string
+ * \param[in] old_char the old character
+ * \param[in] new_string the new string
+ * \param[in,out] output the string the result is appended to
+ * \return the number of replacements
+ * \ingroup string
+ */
+size_t replace_char(const StringView &input, char old_char, const StringView &new_string,
+                    std::string &output);
+
+/**
+ * \brief Replaces a character with a string in place
+ *
+ * The string is resized once and the characters are moved at most once, starting from
+ * the end if \p new_string is longer than one character.
+ *
+ * \param[in,out] str the string to modify
+ * \param[in] old_char the old character
+ * \param[in] new_string the new string
+ * \return the number of replacements
+ * \ingroup string
+ */
+size_t replace_char_inplace(std::string &str, char old_char, const StringView &new_string);
+
+/**
+ * \brief Replaces a character with a string into an arena
+ *
+ * \param[in] input the input string
+ * \param[in] old_char the old character
+ * \param[in] new_string the new string
+ * \param[in] arena the arena for the result
+ * \return a NUL-terminated copy of \p input in \p arena with the replacements, also if
+ *         \p old_char doesn't occur
+ * \ingroup string
+ */
+StringView replace_char(const StringView &input, char old_char, const StringView &new_string,
+                        Arena &arena);
+
+/**
+ * \brief Result of parseNumber()
+ *
+ * \ingroup string
+ */
+enum NumberStatus {
+    NS_OK,              /**< the whole string has been converted */
+    NS_INVALID,         /**< the string is empty, is no number or has trailing characters */
+    NS_OUT_OF_RANGE     /**< the number doesn't fit into the type */
+};
+
+/**
+ * \brief Buffer size for formatNumber() that is enough for every integer and for floating
+ *        point numbers with a precision of up to 17 digits
+ *
+ * \ingroup string
+ */
+const size_t MaxNumberLength = 32;
+
+/**
+ * \brief Writes a number into a buffer
+ *
+ * The conversion doesn't allocate memory and doesn't depend on the locale: there are no
+ * thousands separators and the decimal point is always <tt>'.'</tt>. The result is not
+ * NUL-terminated.
+ *
+ * \param[out] buffer the output buffer
+ * \param[in] size the size of \p buffer, MaxNumberLength is always enough for integers
+ * \param[in] value the number
+ * \return the number of characters written, or 0 if \p buffer is too small
+ * \ingroup string
+ */
+size_t formatNumber(char *buffer, size_t size, int value);
+
+/** \copydoc formatNumber(char *, size_t, int) */
+size_t formatNumber(char *buffer, size_t size, unsigned int value);
+
+/** \copydoc formatNumber(char *, size_t, int) */
+size_t formatNumber(char *buffer, size_t size, long value);
+
+/** \copydoc formatNumber(char *, size_t, int) */
+size_t formatNumber(char *buffer, size_t size, unsigned long value);
+
+/** \copydoc formatNumber(char *, size_t, int) */
+size_t formatNumber(char *buffer, size_t size, long long value);
+
+/** \copydoc formatNumber(char *, size_t, int) */
+size_t formatNumber(char *buffer, size_t size, unsigned long long value);
+
+/**
+ * \brief Writes a floating point number into a buffer
+ *
+ * Like <tt>printf("%.*g")</tt>, but always with <tt>'.'</tt> as decimal point. With the
+ * default \p precision, the result is the same as writing \p value to a std::ostream.
+ *
+ * \param[out] buffer the output buffer
+ * \param[in] size the size of \p buffer
+ * \param[in] value the number
+ * \param[in] precision the number of significant digits, use 17 to get back the same
+ *            \c double with parseNumber()
+ * \return the number of characters written, or 0 if \p buffer is too small
+ * \ingroup string
+ */
+size_t formatNumber(char *buffer, size_t size, double value, int precision=6);
+
+/**
+ * \brief Parses a number
+ *
+ * In contrast to from_str(), the whole string must be a number: leading or trailing
+ * whitespace and other characters are errors. Integers are decimal with an optional sign
+ * (<tt>'-'</tt> is invalid for unsigned types). Floating point numbers are decimal with an
+ * optional fraction and exponent, and <tt>'.'</tt> as decimal point regardless of the
+ * locale; \c inf, \c nan and hexadecimal notation are not accepted.
+ *
+ * The conversion doesn't allocate memory for strings up to 64 characters.
+ *
+ * \param[in] str the string
+ * \param[out] value the number, only modified if the return value is NS_OK
+ * \return NS_OK on success, NS_INVALID if \p str is no number, NS_OUT_OF_RANGE if the
+ *         number is too large for the type
+ * \ingroup string
+ */
+NumberStatus parseNumber(const StringView &str, int &value);
+
+/** \copydoc parseNumber(const StringView &, int &) */
+NumberStatus parseNumber(const StringView &str, unsigned int &value);
+
+/** \copydoc parseNumber(const StringView &, int &) */
+NumberStatus parseNumber(const StringView &str, long &value);
+
+/** \copydoc parseNumber(const StringView &, int &) */
+NumberStatus parseNumber(const StringView &str, unsigned long &value);
+
+/** \copydoc parseNumber(const StringView &, int &) */
+NumberStatus parseNumber(const StringView &str, long long &value);
+
+/** \copydoc parseNumber(const StringView &, int &) */
+NumberStatus parseNumber(const StringView &str, unsigned long long &value);
+
+/** \copydoc parseNumber(const StringView &, int &) */
+NumberStatus parseNumber(const StringView &str, float &value);
+
+/** \copydoc parseNumber(const StringView &, int &) */
+NumberStatus parseNumber(const StringView &str, double &value);
+
 /**
  * \brief Converts \p t to string
  *
@@ -179,6 +659,41 @@ std::string str(const T &t, const std::locale &locale=std::locale())
     return ss.str();
 }
 
+/**
+ * \brief Converts a number to string
+ *
+ * Overload of str() for the arithmetic types that uses formatNumber(), so it doesn't
+ * create a stream and doesn't depend on the global locale, just like the from_str()
+ * specializations for numbers. Pass a locale explicitly to use the stream-based conversion
+ * with that locale.
+ *
+ * \param[in] value the number
+ * \return the string representation of \p value
+ * \ingroup string
+ */
+std::string str(int value);
+
+/** \copydoc str(int) */
+std::string str(unsigned int value);
+
+/** \copydoc str(int) */
+std::string str(long value);
+
+/** \copydoc str(int) */
+std::string str(unsigned long value);
+
+/** \copydoc str(int) */
+std::string str(long long value);
+
+/** \copydoc str(int) */
+std::string str(unsigned long long value);
+
+/** \copydoc str(int) */
+std::string str(float value);
+
+/** \copydoc str(int) */
+std::string str(double value);
+
 /**
  * \brief Converts the range between \p begin and \p end to string
  *
@@ -231,8 +746,15 @@ std::string str(const ForwardIterator &begin,
  * \brief Converts \p str into a basic C++ type
  *
  * The type must have a std::operator>> for std::istream defined.
- * 
- * \warning Error checking is currently not implemented.
+ *
+ * For the types that parseNumber() supports, there are specializations that don't create a
+ * stream. Like str() for numbers, they ignore the global locale and always use \c '.' as
+ * decimal point, so <tt>from_str<double>(str(x))</tt> gives \c x back regardless of the
+ * global locale. Earlier versions parsed with the global locale; pass a locale other than
+ * the global one explicitly to get a stream with that locale. Like the stream version, the
+ * specializations skip leading whitespace and ignore trailing characters. If \p str doesn't
+ * start with a number, 0 is returned; if the number is too large, the largest or smallest
+ * value of the type. Use parseNumber() if you need to detect errors.
  *
  * Example:
  *
@@ -264,6 +786,275 @@ T from_str(const std::string &str, const std::locale &loc=std::locale())
     return ret;
 }
 
+/// \cond
+template <> int from_str<int>(const std::string &str, const std::locale &loc);
+template <> unsigned int from_str<unsigned int>(const std::string &str, const std::locale &loc);
+template <> long from_str<long>(const std::string &str, const std::locale &loc);
+template <> unsigned long from_str<unsigned long>(const std::string &str, const std::locale &loc);
+template <> long long from_str<long long>(const std::string &str, const std::locale &loc);
+template <> unsigned long long from_str<unsigned long long>(const std::string &str,
+                                                            const std::locale &loc);
+template <> float from_str<float>(const std::string &str, const std::locale &loc);
+template <> double from_str<double>(const std::string &str, const std::locale &loc);
+/// \endcond
+
+/// \cond
+struct InternedStringEntry {
+    size_t      hash;
+    size_t      length;
+    const char  *data;
+};
+/// \endcond
+
+/**
+ * \class InternedString stringutil.h libbw/stringutil.h
+ * \brief Handle of a string in a StringPool
+ *
+ * A handle is a single pointer to the pooled characters, so copying it is cheap, and two
+ * handles from the same pool are equal exactly if they point to the same entry. Equality
+ * and hash() are O(1). The characters are NUL-terminated and stay valid as long as the pool
+ * exists; the global pool is never destroyed.
+ *
+ * A default-constructed handle is the empty string, which is the same in all pools.
+ * Handles from different pools must not be compared with each other.
+ *
+ * \ingroup string
+ */
+class InternedString {
+
+public:
+    /**
+     * \brief Creates the empty string
+     */
+    InternedString()
+        : m_entry(&s_empty)
+    {}
+
+    /**
+     * \brief Returns the characters
+     *
+     * \return a pointer to the NUL-terminated string
+     */
+    const char *c_str() const
+    {
+        return m_entry->data;
+    }
+
+    /**
+     * \brief Returns the characters
+     *
+     * \return a pointer to the NUL-terminated string
+     */
+    const char *data() const
+    {
+        return m_entry->data;
+    }
+
+    /**
+     * \brief Returns the length
+     *
+     * \return the number of characters
+     */
+    size_t size() const
+    {
+        return m_entry->length;
+    }
+
+    /**
+     * \brief Checks for the empty string
+     *
+     * \return \c true if the string is empty
+     */
+    bool empty() const
+    {
+        return m_entry->length == 0;
+    }
+
+    /**
+     * \brief Returns the precomputed hash value
+     *
+     * \return the hash of the characters
+     */
+    size_t hash() const
+    {
+        return m_entry->hash;
+    }
+
+    /**
+     * \brief Returns a view of the characters
+     *
+     * \return the view
+     */
+    StringView view() const
+    {
+        return StringView(m_entry->data, m_entry->length);
+    }
+
+    /**
+     * \brief Copies the characters into a std::string
+     *
+     * \return the copy
+     */
+    std::string str() const
+    {
+        return std::string(m_entry->data, m_entry->length);
+    }
+
+    /**
+     * \brief Compares two handles of the same pool
+     *
+     * \param[in] other the other handle
+     * \return \c true if both are the same string
+     */
+    bool operator==(const InternedString &other) const
+    {
+        return m_entry == other.m_entry;
+    }
+
+    /**
+     * \brief Compares two handles of the same pool
+     *
+     * \param[in] other the other handle
+     * \return \c true if the strings differ
+     */
+    bool operator!=(const InternedString &other) const
+    {
+        return m_entry != other.m_entry;
+    }
+
+    /**
+     * \brief Compares the characters lexicographically
+     *
+     * Unlike the equality operators, this is not O(1), but it gives a stable order, e.g. in
+     * a std::map.
+     *
+     * \param[in] other the other handle
+     * \return \c true if this string is sorted before \p other
+     */
+    bool operator<(const InternedString &other) const
+    {
+        return m_entry != other.m_entry && view() < other.view();
+    }
+
+private:
+    friend class StringPool;
+
+    explicit InternedString(const InternedStringEntry *entry)
+        : m_entry(entry)
+    {}
+
+private:
+    const InternedStringEntry *m_entry;
+    static const InternedStringEntry s_empty;
+};
+
+/**
+ * \brief Hash function object for InternedString, e.g. for std::tr1::unordered_map
+ *
+ * \ingroup string
+ */
+struct InternedStringHash {
+    /**
+     * \brief Returns the hash of \p str
+     *
+     * \param[in] str the string
+     * \return InternedString::hash()
+     */
+    size_t operator()(const InternedString &str) const
+    {
+        return str.hash();
+    }
+};
+
+/**
+ * \brief Writes an interned string to a stream
+ *
+ * \param[in] os the stream
+ * \param[in] str the string
+ * \return \p os
+ * \ingroup string
+ */
+inline std::ostream &operator<<(std::ostream &os, const InternedString &str)
+{
+    return os.write(str.data(), str.size());
+}
+
+struct StringPoolPrivate;
+
+/**
+ * \class StringPool stringutil.h libbw/stringutil.h
+ * \brief Thread-safe pool of unique strings
+ *
+ * Each distinct string is stored only once. intern() returns the same InternedString for
+ * equal strings, so repeated identifiers like option or device names take no extra memory
+ * and can be compared by pointer. The characters are allocated in large blocks and are
+ * only freed together with the pool.
+ *
+ * Most code should use the global pool, see intern().
+ *
+ * \ingroup string
+ */
+class StringPool : private Noncopyable {
+
+public:
+    /**
+     * \brief Creates an empty pool
+     */
+    StringPool();
+
+    /**
+     * \brief Destroys the pool and all strings
+     *
+     * Handles returned by the pool must not be used any more.
+     */
+    ~StringPool();
+
+    /**
+     * \brief Returns the process-wide pool
+     *
+     * \return the pool, never destroyed
+     */
+    static StringPool *global();
+
+    /**
+     * \brief Returns the handle of \p str, adding it if necessary
+     *
+     * \param[in] str the string
+     * \return the handle
+     */
+    InternedString intern(const StringView &str);
+
+    /**
+     * \brief Searches a string without adding it
+     *
+     * That's useful to look up untrusted input without growing the pool.
+     *
+     * \param[in] str the string
+     * \param[out] result the handle if \p str is in the pool, unmodified otherwise
+     * \return \c true if \p str has been found
+     */
+    bool lookup(const StringView &str, InternedString &result) const;
+
+    /**
+     * \brief Returns the number of strings
+     *
+     * \return the number of distinct non-empty strings in the pool
+     */
+    size_t size() const;
+
+private:
+    StringPoolPrivate *d;
+};
+
+/**
+ * \brief Interns a string in the global pool
+ *
+ * \param[in] str the string
+ * \return StringPool::global()->intern(\p str)
+ * \ingroup string
+ */
+InternedString intern(const StringView &str);
+
 } // end namespace bw
 
 #endif /* LIBBW_STRINGUTIL_H_ */
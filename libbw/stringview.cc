@@ -0,0 +1,90 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cstring>
+
+#include "stringview.h"
+
+namespace bw {
+
+/* StringView {{{ */
+
+const size_t StringView::npos;
+
+size_t StringView::find(char c, size_t pos) const
+{
+    if (pos >= m_size)
+        return npos;
+
+    const void *found = std::memchr(m_data + pos, c, m_size - pos);
+    return found ? static_cast<const char *>(found) - m_data : npos;
+}
+
+size_t StringView::find(const StringView &needle, size_t pos) const
+{
+    if (pos > m_size || needle.size() > m_size - pos)
+        return npos;
+    if (needle.empty())
+        return pos;
+    if (needle.size() == 1)
+        return find(needle[0], pos);
+
+    // memchr() for the first character is much faster than comparing at each position
+    const char *last = m_data + m_size - needle.size();
+    const char *current = m_data + pos;
+    while (current <= last) {
+        const void *found = std::memchr(current, needle[0], last - current + 1);
+        if (!found)
+            return npos;
+
+        current = static_cast<const char *>(found);
+        if (std::memcmp(current + 1, needle.data() + 1, needle.size() - 1) == 0)
+            return current - m_data;
+        ++current;
+    }
+
+    return npos;
+}
+
+int StringView::compare(const StringView &other) const
+{
+    size_t common = m_size < other.m_size ? m_size : other.m_size;
+
+    int ret = common > 0 ? std::memcmp(m_data, other.m_data, common) : 0;
+    if (ret != 0)
+        return ret;
+
+    return m_size < other.m_size ? -1 : m_size > other.m_size ? 1 : 0;
+}
+
+std::ostream &operator<<(std::ostream &os, const StringView &view)
+{
+    return os.write(view.data(), view.size());
+}
+
+/* }}} */
+
+} // end namespace bw
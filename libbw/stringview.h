@@ -0,0 +1,291 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_STRINGVIEW_H_
+#define LIBBW_STRINGVIEW_H_
+
+#include <cstddef>
+#include <cstring>
+#include <ostream>
+#include <string>
+
+namespace bw {
+
+/* StringView {{{ */
+
+/**
+ * \class StringView stringview.h libbw/stringview.h
+ * \brief Read-only reference to a sequence of characters
+ *
+ * A StringView is only a pointer and a length, so copying it is cheap and creating a
+ * substring doesn't allocate memory. The characters are not owned: the string that the view
+ * has been created from must outlive the view and must not be modified. The data is not
+ * necessarily NUL-terminated.
+ *
+ * \ingroup string
+ */
+class StringView {
+
+public:
+    /**
+     * \brief Iterator type, a plain pointer
+     */
+    typedef const char *const_iterator;
+
+    /**
+     * \brief Return value of find() if nothing has been found
+     */
+    static const size_t npos = static_cast<size_t>(-1);
+
+public:
+    /**
+     * \brief Creates an empty view
+     */
+    StringView()
+        : m_data("")
+        , m_size(0)
+    {}
+
+    /**
+     * \brief Creates a view of a NUL-terminated string
+     *
+     * \param[in] str the string, must not be \c NULL
+     */
+    StringView(const char *str)
+        : m_data(str)
+        , m_size(std::strlen(str))
+    {}
+
+    /**
+     * \brief Creates a view of \p size characters starting at \p data
+     *
+     * \param[in] data the first character
+     * \param[in] size the number of characters
+     */
+    StringView(const char *data, size_t size)
+        : m_data(data)
+        , m_size(size)
+    {}
+
+    /**
+     * \brief Creates a view of a std::string
+     *
+     * The view becomes invalid when \p str is modified or destroyed.
+     *
+     * \param[in] str the string
+     */
+    StringView(const std::string &str)
+        : m_data(str.data())
+        , m_size(str.size())
+    {}
+
+public:
+    /**
+     * \brief Returns the characters
+     *
+     * \return a pointer to the first character, not necessarily NUL-terminated
+     */
+    const char *data() const
+    {
+        return m_data;
+    }
+
+    /**
+     * \brief Returns the number of characters
+     *
+     * \return the length of the view
+     */
+    size_t size() const
+    {
+        return m_size;
+    }
+
+    /**
+     * \brief Returns the number of characters
+     *
+     * \return the length of the view, same as size()
+     */
+    size_t length() const
+    {
+        return m_size;
+    }
+
+    /**
+     * \brief Checks if the view is empty
+     *
+     * \return \c true if size() is 0
+     */
+    bool empty() const
+    {
+        return m_size == 0;
+    }
+
+    /**
+     * \brief Returns an iterator to the first character
+     *
+     * \return the iterator
+     */
+    const_iterator begin() const
+    {
+        return m_data;
+    }
+
+    /**
+     * \brief Returns an iterator behind the last character
+     *
+     * \return the iterator
+     */
+    const_iterator end() const
+    {
+        return m_data + m_size;
+    }
+
+    /**
+     * \brief Returns the character at \p pos
+     *
+     * \param[in] pos the index, must be less than size()
+     * \return the character
+     */
+    char operator[](size_t pos) const
+    {
+        return m_data[pos];
+    }
+
+    /**
+     * \brief Returns a part of the view
+     *
+     * \param[in] pos the index of the first character, clamped to size()
+     * \param[in] count the maximum number of characters
+     * \return the part, which refers to the same characters
+     */
+    StringView substr(size_t pos, size_t count=npos) const
+    {
+        if (pos > m_size)
+            pos = m_size;
+        if (count > m_size - pos)
+            count = m_size - pos;
+        return StringView(m_data + pos, count);
+    }
+
+    /**
+     * \brief Searches a character
+     *
+     * \param[in] c the character
+     * \param[in] pos the index where the search starts
+     * \return the index of the first occurrence of \p c at or after \p pos, or npos
+     */
+    size_t find(char c, size_t pos=0) const;
+
+    /**
+     * \brief Searches a string
+     *
+     * \param[in] needle the string to search for
+     * \param[in] pos the index where the search starts
+     * \return the index of the first occurrence of \p needle at or after \p pos, or npos.
+     *         An empty \p needle is found at \p pos if \p pos is not behind the end.
+     */
+    size_t find(const StringView &needle, size_t pos=0) const;
+
+    /**
+     * \brief Compares the view lexicographically
+     *
+     * \param[in] other the view to compare with
+     * \return a value less than, equal to or greater than 0 if the view is less than, equal
+     *         to or greater than \p other
+     */
+    int compare(const StringView &other) const;
+
+    /**
+     * \brief Copies the characters into a std::string
+     *
+     * \return the new string
+     */
+    std::string str() const
+    {
+        return std::string(m_data, m_size);
+    }
+
+private:
+    const char  *m_data;
+    size_t      m_size;
+};
+
+/**
+ * \brief Checks two views for equality
+ *
+ * \param[in] a the first view
+ * \param[in] b the second view
+ * \return \c true if both views have the same characters
+ * \ingroup string
+ */
+inline bool operator==(const StringView &a, const StringView &b)
+{
+    return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+/**
+ * \brief Checks two views for inequality
+ *
+ * \param[in] a the first view
+ * \param[in] b the second view
+ * \return \c true if the views have different characters
+ * \ingroup string
+ */
+inline bool operator!=(const StringView &a, const StringView &b)
+{
+    return !(a == b);
+}
+
+/**
+ * \brief Compares two views lexicographically
+ *
+ * \param[in] a the first view
+ * \param[in] b the second view
+ * \return \c true if \p a is less than \p b
+ * \ingroup string
+ */
+inline bool operator<(const StringView &a, const StringView &b)
+{
+    return a.compare(b) < 0;
+}
+
+/**
+ * \brief Writes the characters of a view to a stream
+ *
+ * \param[in] os the output stream
+ * \param[in] view the view
+ * \return \p os
+ * \ingroup string
+ */
+std::ostream &operator<<(std::ostream &os, const StringView &view);
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_STRINGVIEW_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
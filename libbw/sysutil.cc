@@ -0,0 +1,125 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <ctime>
+
+#include <sys/time.h>
+#include <sys/types.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "bwconfig.h"
+#include "sysutil.h"
+
+#ifndef IOV_MAX
+#  define IOV_MAX 16
+#endif
+
+namespace bw {
+
+/* Clocks {{{ */
+
+unsigned long long monotonicNanoseconds()
+{
+#ifdef HAVE_CLOCK_GETTIME
+    struct timespec ts;
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == 0)
+        return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + ts.tv_nsec;
+#endif
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    return static_cast<unsigned long long>(tv.tv_sec) * 1000000000ULL + tv.tv_usec * 1000ULL;
+}
+
+void realtimeClock(long long *second, long *nanosecond)
+{
+#ifdef HAVE_CLOCK_GETTIME
+    struct timespec ts;
+    if (clock_gettime(CLOCK_REALTIME, &ts) == 0) {
+        *second = ts.tv_sec;
+        *nanosecond = ts.tv_nsec;
+        return;
+    }
+#endif
+    *second = std::time(NULL);
+    *nanosecond = 0;
+}
+
+long long realtimeMicroseconds()
+{
+    long long second;
+    long nanosecond;
+    realtimeClock(&second, &nanosecond);
+
+    return second * 1000000 + nanosecond / 1000;
+}
+
+/* }}} */
+/* Writing {{{ */
+
+void writeAll(int fd, const char *data, size_t length)
+{
+    while (length > 0) {
+        ssize_t ret = ::write(fd, data, length);
+        if (ret < 0 && errno == EINTR)
+            continue;
+        if (ret <= 0)
+            return;
+        data += ret;
+        length -= ret;
+    }
+}
+
+void writeAll(int fd, struct iovec *iov, size_t count)
+{
+    while (count > 0) {
+        size_t chunk = std::min(count, size_t(IOV_MAX));
+        ssize_t ret = ::writev(fd, iov, chunk);
+        if (ret < 0) {
+            if (errno == EINTR)
+                continue;
+            return;
+        }
+
+        // skip what has been written
+        while (count > 0 && size_t(ret) >= iov->iov_len) {
+            ret -= iov->iov_len;
+            ++iov;
+            --count;
+        }
+        if (count > 0 && ret > 0) {
+            iov->iov_base = static_cast<char *>(iov->iov_base) + ret;
+            iov->iov_len -= ret;
+        }
+    }
+}
+
+/* }}} */
+
+} // end namespace bw
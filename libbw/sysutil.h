@@ -0,0 +1,99 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_SYSUTIL_H_
+#define LIBBW_SYSUTIL_H_
+
+#include <cstddef>
+
+struct iovec;
+
+namespace bw {
+
+/* Clocks {{{ */
+
+/**
+ * \brief Returns a monotonic timestamp
+ *
+ * Uses \c CLOCK_MONOTONIC where available and falls back to gettimeofday().
+ *
+ * \return the time in nanoseconds since an unspecified point in the past
+ * \ingroup misc
+ */
+unsigned long long monotonicNanoseconds();
+
+/**
+ * \brief Returns the wall clock time
+ *
+ * \param[out] second the seconds since the epoch
+ * \param[out] nanosecond the nanoseconds within \p second, 0 if the platform has no
+ *             clock_gettime()
+ * \ingroup misc
+ */
+void realtimeClock(long long *second, long *nanosecond);
+
+/**
+ * \brief Returns the wall clock time in microseconds since the epoch
+ *
+ * \return the time
+ * \ingroup misc
+ */
+long long realtimeMicroseconds();
+
+/* }}} */
+/* Writing {{{ */
+
+/**
+ * \brief write() that also handles partial writes and \c EINTR
+ *
+ * Async-signal-safe. Gives up silently on other errors.
+ *
+ * \param[in] fd the file descriptor
+ * \param[in] data the bytes to write
+ * \param[in] length the number of bytes
+ * \ingroup misc
+ */
+void writeAll(int fd, const char *data, size_t length);
+
+/**
+ * \brief writev() that also handles partial writes and more than \c IOV_MAX vectors
+ *
+ * Gives up silently on errors other than \c EINTR.
+ *
+ * \param[in] fd the file descriptor
+ * \param[in] iov the vectors which are modified
+ * \param[in] count the number of vectors
+ * \ingroup misc
+ */
+void writeAll(int fd, struct iovec *iov, size_t count);
+
+/* }}} */
+
+} // end namespace bw
+
+#endif /* LIBBW_SYSUTIL_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
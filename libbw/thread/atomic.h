@@ -0,0 +1,195 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_THREAD_ATOMIC_H_
+#define LIBBW_THREAD_ATOMIC_H_
+
+#include <libbw/noncopyable.h>
+
+namespace bw {
+namespace thread {
+
+/* MemoryOrder {{{ */
+
+/**
+ * \brief Memory ordering constraints for Atomic operations
+ *
+ * The values have the same meaning as the C++11 <tt>std::memory_order</tt>
+ * constants.
+ *
+ * \ingroup thread
+ */
+enum MemoryOrder {
+    MO_RELAXED  = __ATOMIC_RELAXED,     /**< no ordering, only atomicity */
+    MO_ACQUIRE  = __ATOMIC_ACQUIRE,     /**< acquire semantics for loads */
+    MO_RELEASE  = __ATOMIC_RELEASE,     /**< release semantics for stores */
+    MO_ACQ_REL  = __ATOMIC_ACQ_REL,     /**< both acquire and release */
+    MO_SEQ_CST  = __ATOMIC_SEQ_CST      /**< sequentially consistent */
+};
+
+/* }}} */
+/* atomicFence {{{ */
+
+/**
+ * \brief Memory fence
+ *
+ * Orders the surrounding (relaxed) atomic operations like <tt>std::atomic_thread_fence()</tt>.
+ *
+ * \param[in] order the ordering constraint
+ * \ingroup thread
+ */
+inline void atomicFence(MemoryOrder order=MO_SEQ_CST)
+{
+    __atomic_thread_fence(order);
+}
+
+/* }}} */
+/* Atomic {{{ */
+
+/**
+ * \class Atomic atomic.h libbw/thread/atomic.h
+ * \brief Atomic integer or pointer value
+ *
+ * Small wrapper around the GCC <tt>__atomic</tt> builtins (also provided by
+ * clang). \p T must be an integral type or a pointer type whose size is
+ * natively supported by the platform. All operations default to sequential
+ * consistency.
+ *
+ * \ingroup thread
+ */
+template <typename T>
+class Atomic : private Noncopyable {
+
+public:
+    /**
+     * \brief Creates a new atomic variable with the initial value \p value
+     *
+     * \param[in] value the initial value
+     */
+    explicit Atomic(T value=T())
+        : m_value(value)
+    {}
+
+public:
+    /**
+     * \brief Reads the value
+     *
+     * \param[in] order the memory order
+     * \return the current value
+     */
+    T load(MemoryOrder order=MO_SEQ_CST) const
+    {
+        return __atomic_load_n(&m_value, order);
+    }
+
+    /**
+     * \brief Sets the value
+     *
+     * \param[in] value the new value
+     * \param[in] order the memory order
+     */
+    void store(T value, MemoryOrder order=MO_SEQ_CST)
+    {
+        __atomic_store_n(&m_value, value, order);
+    }
+
+    /**
+     * \brief Sets the value and returns the old one
+     *
+     * \param[in] value the new value
+     * \param[in] order the memory order
+     * \return the value before the exchange
+     */
+    T exchange(T value, MemoryOrder order=MO_SEQ_CST)
+    {
+        return __atomic_exchange_n(&m_value, value, order);
+    }
+
+    /**
+     * \brief Sets the value to \p desired if it's equal to \p expected
+     *
+     * \param[in,out] expected the expected value. On failure, the current value
+     *                is stored there.
+     * \param[in] desired the new value
+     * \param[in] order the memory order
+     * \return \c true if the value has been exchanged, \c false otherwise
+     */
+    bool compareExchange(T &expected, T desired, MemoryOrder order=MO_SEQ_CST)
+    {
+        return __atomic_compare_exchange_n(&m_value, &expected, desired, false,
+                                           order, failureOrder(order));
+    }
+
+    /**
+     * \brief Adds \p value
+     *
+     * \param[in] value the value to add
+     * \param[in] order the memory order
+     * \return the value before the addition
+     */
+    T fetchAdd(T value, MemoryOrder order=MO_SEQ_CST)
+    {
+        return __atomic_fetch_add(&m_value, value, order);
+    }
+
+    /**
+     * \brief Subtracts \p value
+     *
+     * \param[in] value the value to subtract
+     * \param[in] order the memory order
+     * \return the value before the subtraction
+     */
+    T fetchSub(T value, MemoryOrder order=MO_SEQ_CST)
+    {
+        return __atomic_fetch_sub(&m_value, value, order);
+    }
+
+private:
+    static int failureOrder(MemoryOrder order)
+    {
+        // the failure order must not contain release semantics
+        switch (order) {
+            case MO_RELEASE:
+                return MO_RELAXED;
+            case MO_ACQ_REL:
+                return MO_ACQUIRE;
+            default:
+                return order;
+        }
+    }
+
+private:
+    T m_value;
+};
+
+/* }}} */
+
+} // end namespace thread
+} // end namespace bw
+
+#endif /* LIBBW_THREAD_ATOMIC_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,81 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include <cerrno>
+#include <sys/time.h>
+
+#include "condition.h"
+
+namespace bw {
+namespace thread {
+
+/* Condition {{{ */
+
+Condition::Condition()
+{
+    pthread_cond_init(&m_cond, NULL);
+}
+
+Condition::~Condition()
+{
+    pthread_cond_destroy(&m_cond);
+}
+
+void Condition::wait(Mutex *mutex)
+{
+    pthread_cond_wait(&m_cond, &mutex->m_mutex);
+}
+
+bool Condition::wait(Mutex *mutex, unsigned long msecs)
+{
+    struct timeval now;
+    gettimeofday(&now, NULL);
+
+    struct timespec abstime;
+    abstime.tv_sec = now.tv_sec + msecs / 1000;
+    abstime.tv_nsec = now.tv_usec * 1000 + (msecs % 1000) * 1000000;
+    if (abstime.tv_nsec >= 1000000000) {
+        abstime.tv_sec++;
+        abstime.tv_nsec -= 1000000000;
+    }
+
+    return pthread_cond_timedwait(&m_cond, &mutex->m_mutex, &abstime) != ETIMEDOUT;
+}
+
+void Condition::signal()
+{
+    pthread_cond_signal(&m_cond);
+}
+
+void Condition::broadcast()
+{
+    pthread_cond_broadcast(&m_cond);
+}
+
+/* }}} */
+
+} // end namespace thread
+} // end namespace bw
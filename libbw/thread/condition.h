@@ -0,0 +1,101 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_THREAD_CONDITION_H_
+#define LIBBW_THREAD_CONDITION_H_
+
+#include <pthread.h>
+
+#include <libbw/noncopyable.h>
+#include <libbw/thread/mutex.h>
+
+namespace bw {
+namespace thread {
+
+/* Condition {{{ */
+
+/**
+ * \class Condition condition.h libbw/thread/condition.h
+ * \brief Condition variable
+ *
+ * Wrapper around the POSIX condition variable. As with the POSIX API, spurious
+ * wakeups are possible, so always check the predicate in a loop.
+ *
+ * \ingroup thread
+ */
+class Condition : private Noncopyable {
+
+public:
+    /**
+     * \brief Creates a new condition variable
+     */
+    Condition();
+
+    /**
+     * \brief Destroys the condition variable
+     */
+    ~Condition();
+
+public:
+    /**
+     * \brief Waits for the condition to be signalled
+     *
+     * \param[in] mutex the mutex which must be locked by the caller. It's
+     *            unlocked while waiting and locked again before returning.
+     */
+    void wait(Mutex *mutex);
+
+    /**
+     * \brief Waits for the condition to be signalled with a timeout
+     *
+     * \param[in] mutex the mutex which must be locked by the caller, see wait()
+     * \param[in] msecs the maximum time to wait in milliseconds
+     * \return \c false if the timeout expired, \c true otherwise
+     */
+    bool wait(Mutex *mutex, unsigned long msecs);
+
+    /**
+     * \brief Wakes up one waiting thread
+     */
+    void signal();
+
+    /**
+     * \brief Wakes up all waiting threads
+     */
+    void broadcast();
+
+private:
+    pthread_cond_t m_cond;
+};
+
+/* }}} */
+
+} // end namespace thread
+} // end namespace bw
+
+#endif /* LIBBW_THREAD_CONDITION_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
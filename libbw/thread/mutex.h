@@ -0,0 +1,99 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_THREAD_MUTEX_H_
+#define LIBBW_THREAD_MUTEX_H_
+
+#include <pthread.h>
+
+#include <libbw/noncopyable.h>
+
+namespace bw {
+namespace thread {
+
+class Condition;
+
+/* Mutex {{{ */
+
+/**
+ * \class Mutex mutex.h libbw/thread/mutex.h
+ * \brief Simple non-recursive mutual exclusion
+ *
+ * Thin wrapper around the POSIX mutex. Use MutexLocker to lock and unlock
+ * the mutex in a scope instead of calling lock() and unlock() manually.
+ *
+ * \ingroup thread
+ */
+class Mutex : private Noncopyable {
+
+    friend class Condition;
+
+public:
+    /**
+     * \brief Creates a new unlocked mutex
+     */
+    Mutex();
+
+    /**
+     * \brief Destroys the mutex
+     *
+     * The mutex must not be locked.
+     */
+    ~Mutex();
+
+public:
+    /**
+     * \brief Locks the mutex
+     *
+     * Blocks until the mutex could be acquired.
+     */
+    void lock();
+
+    /**
+     * \brief Tries to lock the mutex
+     *
+     * \return \c true if the mutex has been acquired, \c false if it's
+     *         locked by another thread.
+     */
+    bool tryLock();
+
+    /**
+     * \brief Unlocks the mutex
+     */
+    void unlock();
+
+private:
+    pthread_mutex_t m_mutex;
+};
+
+/* }}} */
+
+} // end namespace thread
+} // end namespace bw
+
+#endif /* LIBBW_THREAD_MUTEX_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
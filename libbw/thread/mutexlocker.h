@@ -0,0 +1,87 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_THREAD_MUTEXLOCKER_H_
+#define LIBBW_THREAD_MUTEXLOCKER_H_
+
+#include <libbw/noncopyable.h>
+#include <libbw/thread/mutex.h>
+
+namespace bw {
+namespace thread {
+
+/* MutexLocker {{{ */
+
+/**
+ * \class MutexLocker mutexlocker.h libbw/thread/mutexlocker.h
+ * \brief Locks a mutex for the lifetime of the object
+ *
+ * Example:
+ *
+ * \code
+ * void Foo::bar()
+ * {
+ *     thread::MutexLocker locker(&m_mutex);
+ *     // critical section
+ * }
+ * \endcode
+ *
+ * \ingroup thread
+ */
+class MutexLocker : private Noncopyable {
+
+public:
+    /**
+     * \brief Locks \p mutex
+     *
+     * \param[in] mutex the mutex to lock, must not be \c NULL
+     */
+    MutexLocker(Mutex *mutex)
+        : m_mutex(mutex)
+    {
+        m_mutex->lock();
+    }
+
+    /**
+     * \brief Unlocks the mutex passed in the constructor
+     */
+    ~MutexLocker()
+    {
+        m_mutex->unlock();
+    }
+
+private:
+    Mutex *m_mutex;
+};
+
+/* }}} */
+
+} // end namespace thread
+} // end namespace bw
+
+#endif /* LIBBW_THREAD_MUTEXLOCKER_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
@@ -0,0 +1,74 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#include "thread.h"
+
+namespace bw {
+namespace thread {
+
+/* Thread {{{ */
+
+Thread::Thread()
+    : m_running(false)
+{}
+
+bool Thread::start()
+{
+    if (m_running)
+        return false;
+
+    if (pthread_create(&m_thread, NULL, threadFunction, this) != 0)
+        return false;
+
+    m_running = true;
+    return true;
+}
+
+void Thread::join()
+{
+    if (!m_running)
+        return;
+
+    pthread_join(m_thread, NULL);
+    m_running = false;
+}
+
+bool Thread::isRunning() const
+{
+    return m_running;
+}
+
+void *Thread::threadFunction(void *arg)
+{
+    Thread *thread = static_cast<Thread *>(arg);
+    thread->run();
+    return NULL;
+}
+
+/* }}} */
+
+} // end namespace thread
+} // end namespace bw
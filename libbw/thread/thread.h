@@ -0,0 +1,122 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_THREAD_THREAD_H_
+#define LIBBW_THREAD_THREAD_H_
+
+#include <pthread.h>
+
+#include <libbw/noncopyable.h>
+
+namespace bw {
+namespace thread {
+
+/* Thread {{{ */
+
+/**
+ * \class Thread thread.h libbw/thread/thread.h
+ * \brief Base class for threads
+ *
+ * Subclasses implement run() which is executed in the new thread after
+ * start() has been called. Example:
+ *
+ * \code
+ * class Worker : public bw::thread::Thread {
+ *     protected:
+ *         void run()
+ *         {
+ *             // do the work
+ *         }
+ * };
+ *
+ * Worker worker;
+ * worker.start();
+ * // ...
+ * worker.join();
+ * \endcode
+ *
+ * \ingroup thread
+ */
+class Thread : private Noncopyable {
+
+public:
+    /**
+     * \brief Creates a new thread object without starting the thread
+     */
+    Thread();
+
+    /**
+     * \brief Destructor
+     *
+     * The thread must have been joined before the object is destroyed.
+     */
+    virtual ~Thread() {}
+
+public:
+    /**
+     * \brief Starts the thread
+     *
+     * \return \c true on success, \c false if the thread could not be created
+     *         or is already running.
+     */
+    bool start();
+
+    /**
+     * \brief Waits for the thread to finish
+     *
+     * Does nothing if the thread has not been started.
+     */
+    void join();
+
+    /**
+     * \brief Checks if the thread has been started and not joined yet
+     *
+     * \return \c true if the thread is running, \c false otherwise
+     */
+    bool isRunning() const;
+
+protected:
+    /**
+     * \brief The code that is executed in the thread
+     */
+    virtual void run() = 0;
+
+private:
+    static void *threadFunction(void *arg);
+
+private:
+    pthread_t m_thread;
+    bool m_running;
+};
+
+/* }}} */
+
+} // end namespace thread
+} // end namespace bw
+
+#endif /* LIBBW_THREAD_THREAD_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker:
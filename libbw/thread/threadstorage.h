@@ -0,0 +1,99 @@
+/* {{{
+ * Copyright (c) 2012, Bernhard Walle <bernhard@bwalle.de>
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in the
+ *       documentation and/or other materials provided with the distribution.
+ *     * Neither the name of the <organization> nor the
+ *       names of its contributors may be used to endorse or promote products
+ *       derived from this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY <copyright holder> ''AS IS'' AND ANY
+ * EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED
+ * WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL <copyright holder> BE LIABLE FOR ANY
+ * DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES
+ * (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+ * LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND
+ * ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+ * SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE. }}}
+ */
+#ifndef LIBBW_THREAD_THREADSTORAGE_H_
+#define LIBBW_THREAD_THREADSTORAGE_H_
+
+#include <pthread.h>
+
+#include <libbw/noncopyable.h>
+
+namespace bw {
+namespace thread {
+
+/* ThreadStorage {{{ */
+
+/**
+ * \class ThreadStorage threadstorage.h libbw/thread/threadstorage.h
+ * \brief Per-thread pointer
+ *
+ * Each thread sees its own value, which is \c NULL until the thread calls set(). Unlike
+ * BW_COMPILER_THREAD_LOCAL, a destructor function can be registered that is called with
+ * the value of a thread when that thread terminates.
+ *
+ * \ingroup thread
+ */
+class ThreadStorage : private Noncopyable {
+
+public:
+    /**
+     * \brief Function that is called on thread termination
+     */
+    typedef void (*Destructor)(void *value);
+
+public:
+    /**
+     * \brief Creates a new storage slot
+     *
+     * \param[in] destructor the function that is called with the non-\c NULL value of a
+     *            thread when the thread terminates, may be \c NULL
+     */
+    ThreadStorage(Destructor destructor=NULL);
+
+    /**
+     * \brief Destroys the storage slot
+     *
+     * The destructor function is not called for the values of running threads.
+     */
+    ~ThreadStorage();
+
+public:
+    /**
+     * \brief Returns the value of the calling thread
+     *
+     * \return the value, \c NULL if set() has not been called in this thread
+     */
+    void *get() const;
+
+    /**
+     * \brief Sets the value of the calling thread
+     *
+     * \param[in] value the new value
+     */
+    void set(void *value);
+
+private:
+    pthread_key_t m_key;
+};
+
+/* }}} */
+
+} // end namespace thread
+} // end namespace bw
+
+#endif /* LIBBW_THREAD_THREADSTORAGE_H_ */
+
+// vim: set sw=4 ts=4 et fdm=marker: